@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 基准程序共用的小工具：读取样本、计时和输出。不依赖测试框架，直接运行可执行文件即可
+namespace Bench {
+using Clock = std::chrono::steady_clock;
+
+// 防止编译器把结果未被使用的计算整个优化掉
+inline volatile size_t g_sink = 0;
+
+inline std::string dataPath(const char *name)
+{
+	return std::string(BENCH_DATA_DIR) + "/" + name;
+}
+
+inline std::string readFile(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		std::fprintf(stderr, "无法读取 %s\n", path.c_str());
+		std::exit(1);
+	}
+	std::ostringstream ss;
+	ss << in.rdbuf();
+	return ss.str();
+}
+
+// 每行一条记录，跳过空行
+inline std::vector<std::string> readLines(const std::string &path)
+{
+	std::vector<std::string> lines;
+	std::istringstream in(readFile(path));
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (!line.empty())
+			lines.push_back(std::move(line));
+	}
+	return lines;
+}
+
+// 反复执行 fn 直到累计运行至少 minMs 毫秒，返回单次平均纳秒数。先预热一次
+template<typename F> double timeIt(F &&fn, int minMs = 500)
+{
+	fn();
+	size_t runs = 0;
+	auto start = Clock::now();
+	auto elapsed = Clock::duration::zero();
+	do {
+		fn();
+		++runs;
+		elapsed = Clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(minMs));
+	return std::chrono::duration<double, std::nano>(elapsed).count() / runs;
+}
+
+// name: 单次耗时，以及按 itemsPerRun 折算的每秒处理量
+inline void report(const char *name, double nsPerRun, double itemsPerRun, const char *unit)
+{
+	std::printf("%-40s %12.1f us/run %14.0f %s/s\n", name, nsPerRun / 1000.0, itemsPerRun * 1e9 / nsPerRun, unit);
+}
+
+// 已排序样本的百分位
+template<typename T> T percentile(const std::vector<T> &sorted, double p)
+{
+	if (sorted.empty())
+		return T();
+	size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+	return sorted[index];
+}
+} // namespace Bench
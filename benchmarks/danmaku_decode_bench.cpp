@@ -0,0 +1,90 @@
+// 弹幕解包基准：把录制的消息按服务器的方式打包成 websocket 帧，测 FrameDecoder 解包和 parseMessage 的吞吐。
+// 用法: danmaku_decode_bench [capture.jsonl]，文件每行一条 OP_MESSAGE 包体；缺省使用 data/chat_capture.jsonl
+#include <zlib.h>
+#include "bench_support.hpp"
+#include "danmaku/danmaku_protocol.hpp"
+
+using namespace Danmaku;
+
+namespace {
+void writeBE(std::string &out, uint32_t value, int bytes)
+{
+	for (int i = bytes - 1; i >= 0; --i)
+		out += static_cast<char>((value >> (i * 8)) & 0xff);
+}
+
+std::string packet(uint16_t version, uint32_t op, const std::string &body)
+{
+	std::string out;
+	writeBE(out, static_cast<uint32_t>(kHeaderSize + body.size()), 4);
+	writeBE(out, static_cast<uint32_t>(kHeaderSize), 2);
+	writeBE(out, version, 2);
+	writeBE(out, op, 4);
+	writeBE(out, 0, 4);
+	return out + body;
+}
+
+// 服务器把一批消息拼接后整体压缩，再套一层协议版本为 2 的外层包
+std::vector<std::string> buildFrames(const std::vector<std::string> &messages, size_t perFrame, bool compress)
+{
+	std::vector<std::string> frames;
+	for (size_t i = 0; i < messages.size(); i += perFrame) {
+		std::string inner;
+		for (size_t j = i; j < std::min(messages.size(), i + perFrame); ++j)
+			inner += packet(PROTO_JSON, OP_MESSAGE, messages[j]);
+		if (!compress) {
+			frames.push_back(std::move(inner));
+			continue;
+		}
+		uLongf size = compressBound(static_cast<uLong>(inner.size()));
+		std::string deflated(size, '\0');
+		compress2(reinterpret_cast<Bytef *>(&deflated[0]), &size, reinterpret_cast<const Bytef *>(inner.data()),
+			  static_cast<uLong>(inner.size()), Z_DEFAULT_COMPRESSION);
+		deflated.resize(size);
+		frames.push_back(packet(PROTO_ZLIB, OP_MESSAGE, deflated));
+	}
+	return frames;
+}
+
+void run(const char *name, const std::vector<std::string> &frames, size_t messages, bool parse)
+{
+	FrameDecoder decoder;
+	std::vector<PacketView> packets;
+	std::string err;
+	double ns = Bench::timeIt([&] {
+		size_t events = 0;
+		for (const auto &frame : frames) {
+			decoder.decode(frame.data(), frame.size(), packets, err);
+			if (!parse) {
+				events += packets.size();
+				continue;
+			}
+			for (const auto &p : packets) {
+				Event event;
+				events += parseMessage(p.body, event);
+			}
+		}
+		Bench::g_sink = Bench::g_sink + events;
+	});
+	Bench::report(name, ns, static_cast<double>(messages), "msg");
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	auto messages = Bench::readLines(argc > 1 ? argv[1] : Bench::dataPath("chat_capture.jsonl"));
+	size_t bytes = 0;
+	for (const auto &m : messages)
+		bytes += m.size();
+	std::printf("%zu 条消息，%zu 字节\n", messages.size(), bytes);
+
+	for (size_t perFrame : {1, 16, 64}) {
+		auto zlibFrames = buildFrames(messages, perFrame, true);
+		auto plainFrames = buildFrames(messages, perFrame, false);
+		std::string suffix = " x" + std::to_string(perFrame);
+		run(("decode zlib" + suffix).c_str(), zlibFrames, messages.size(), false);
+		run(("decode+parse zlib" + suffix).c_str(), zlibFrames, messages.size(), true);
+		run(("decode+parse plain" + suffix).c_str(), plainFrames, messages.size(), true);
+	}
+	return 0;
+}
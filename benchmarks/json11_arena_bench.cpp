@@ -0,0 +1,69 @@
+// json11 解析 / 析构基准：在接口返回和弹幕消息样本上比较 HEAP、ARENA 和 ARENA + BORROW 三种模式。
+// 用法: json11_arena_bench [payload.json ...]；缺省使用 data/ 下的分区列表、直播间信息和弹幕样本
+#include "bench_support.hpp"
+#include "json11/json11.hpp"
+
+using json11::Json;
+using json11::JsonAlloc;
+using json11::JsonParse;
+using json11::JsonStrings;
+
+namespace {
+struct Mode {
+	const char *name;
+	JsonAlloc alloc;
+	JsonStrings strings;
+};
+
+const Mode kModes[] = {
+	{"HEAP", JsonAlloc::HEAP, JsonStrings::COPY},
+	{"ARENA", JsonAlloc::ARENA, JsonStrings::COPY},
+	{"ARENA+BORROW", JsonAlloc::ARENA, JsonStrings::BORROW},
+};
+
+// 每轮把全部文档解析进 docs，再整体销毁；解析和析构分开计时
+void run(const char *label, const std::vector<std::string> &inputs)
+{
+	size_t bytes = 0;
+	for (const auto &in : inputs)
+		bytes += in.size();
+	std::printf("-- %s: %zu 个文档，%zu 字节\n", label, inputs.size(), bytes);
+
+	for (const auto &mode : kModes) {
+		std::vector<Json> docs;
+		docs.reserve(inputs.size());
+		std::string err;
+		double parseNs = 0, freeNs = 0;
+		size_t rounds = 0;
+		auto start = Bench::Clock::now();
+		while (Bench::Clock::now() - start < std::chrono::milliseconds(500)) {
+			auto t0 = Bench::Clock::now();
+			for (const auto &in : inputs)
+				docs.push_back(Json::parse(in, err, JsonParse::STANDARD, mode.alloc, mode.strings));
+			auto t1 = Bench::Clock::now();
+			docs.clear();
+			auto t2 = Bench::Clock::now();
+			parseNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+			freeNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+			++rounds;
+		}
+		if (!err.empty())
+			std::printf("解析失败: %s\n", err.c_str());
+		std::printf("%-14s parse %9.1f us  free %8.1f us  %8.1f MB/s\n", mode.name, parseNs / rounds / 1000.0,
+			    freeNs / rounds / 1000.0, bytes * rounds / ((parseNs + freeNs) / 1e9) / 1e6);
+	}
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 1) {
+		for (int i = 1; i < argc; ++i)
+			run(argv[i], {Bench::readFile(argv[i])});
+		return 0;
+	}
+	run("area_list.json", {Bench::readFile(Bench::dataPath("area_list.json"))});
+	run("room_info.json", {Bench::readFile(Bench::dataPath("room_info.json"))});
+	run("chat_capture.jsonl", Bench::readLines(Bench::dataPath("chat_capture.jsonl")));
+	return 0;
+}
@@ -0,0 +1,114 @@
+// json11 对象存储基准：在接口返回和弹幕消息的真实对象形状上，比较 FlatMap（Json::object）与 std::map
+// 的按键查找和整体构建耗时，并给出各样本的解析吞吐。
+// 用法: json11_object_bench，样本来自 data/
+#include <map>
+#include "bench_support.hpp"
+#include "json11/json11.hpp"
+
+using json11::Json;
+
+namespace {
+using StdObject = std::map<std::string, Json>;
+
+std::vector<std::pair<std::string, Json>> members(const Json &object)
+{
+	return std::vector<std::pair<std::string, Json>>(object.object_items().begin(), object.object_items().end());
+}
+
+// 查找对象的全部键，再加上同样数量的不存在的键（可选字段缺失的情况）
+void lookup(const char *label, const Json &object)
+{
+	std::vector<std::string> keys;
+	for (const auto &kv : object.object_items()) {
+		keys.push_back(kv.first);
+		keys.push_back(kv.first + "_x");
+	}
+	auto items = members(object);
+	StdObject stdObject(items.begin(), items.end());
+
+	std::printf("-- %s: %zu 个键\n", label, object.object_items().size());
+	const Json::object &flat = object.object_items();
+	double ns = Bench::timeIt([&] {
+		size_t n = 0;
+		for (const auto &key : keys)
+			n += flat.find(key) != flat.end();
+		Bench::g_sink = Bench::g_sink + n;
+	});
+	Bench::report("lookup FlatMap", ns, static_cast<double>(keys.size()), "lookup");
+	ns = Bench::timeIt([&] {
+		size_t n = 0;
+		for (const auto &key : keys)
+			n += !object[key].is_null();
+		Bench::g_sink = Bench::g_sink + n;
+	});
+	Bench::report("lookup Json::operator[]", ns, static_cast<double>(keys.size()), "lookup");
+	ns = Bench::timeIt([&] {
+		size_t n = 0;
+		for (const auto &key : keys)
+			n += stdObject.find(key) != stdObject.end();
+		Bench::g_sink = Bench::g_sink + n;
+	});
+	Bench::report("lookup std::map", ns, static_cast<double>(keys.size()), "lookup");
+
+	// 解析器按输入顺序收集成员后一次性构建对象，两种容器都走同样的路径
+	ns = Bench::timeIt([&] {
+		Json::object built(items.begin(), items.end());
+		Bench::g_sink = Bench::g_sink + built.size();
+	});
+	Bench::report("build FlatMap", ns, 1, "object");
+	ns = Bench::timeIt([&] {
+		StdObject built(items.begin(), items.end());
+		Bench::g_sink = Bench::g_sink + built.size();
+	});
+	Bench::report("build std::map", ns, 1, "object");
+}
+
+void parse(const char *label, const std::vector<std::string> &inputs)
+{
+	size_t bytes = 0;
+	for (const auto &in : inputs)
+		bytes += in.size();
+	std::string err;
+	double ns = Bench::timeIt([&] {
+		for (const auto &in : inputs)
+			Bench::g_sink = Bench::g_sink + Json::parse(in, err).object_items().size();
+	});
+	Bench::report(label, ns, static_cast<double>(bytes) / 1e6, "MB");
+}
+
+Json parseFile(const char *name)
+{
+	std::string err;
+	Json json = Json::parse(Bench::readFile(Bench::dataPath(name)), err);
+	if (!err.empty()) {
+		std::fprintf(stderr, "%s: %s\n", name, err.c_str());
+		std::exit(1);
+	}
+	return json;
+}
+} // namespace
+
+int main()
+{
+	Json room = parseFile("room_info.json");
+	Json areas = parseFile("area_list.json");
+	lookup("响应外层 {code, msg, message, data}", room);
+	lookup("直播间信息 data", room["data"]);
+	lookup("分区条目", areas["data"][0]["list"][0]);
+
+	std::string err;
+	auto capture = Bench::readLines(Bench::dataPath("chat_capture.jsonl"));
+	for (const auto &line : capture) {
+		Json message = Json::parse(line, err);
+		if (message["cmd"].string_value() == "SEND_GIFT") {
+			lookup("礼物消息 data", message["data"]);
+			break;
+		}
+	}
+
+	std::printf("-- 解析\n");
+	parse("parse room_info.json", {Bench::readFile(Bench::dataPath("room_info.json"))});
+	parse("parse area_list.json", {Bench::readFile(Bench::dataPath("area_list.json"))});
+	parse("parse chat_capture.jsonl", capture);
+	return 0;
+}
@@ -0,0 +1,125 @@
+// SpscRing / EventBus 基准：跨线程吞吐，以及从入队到被消费的单向延迟分布
+#include <thread>
+#include "bench_support.hpp"
+#include "core/event_bus.hpp"
+#include "core/spsc_ring.hpp"
+
+using Core::SpscRing;
+
+namespace {
+int64_t nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Bench::Clock::now().time_since_epoch()).count();
+}
+
+void printLatency(const char *name, std::vector<int64_t> &samples)
+{
+	std::sort(samples.begin(), samples.end());
+	std::printf("%-40s p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %8.1f us\n", name,
+		    Bench::percentile(samples, 0.5) / 1000.0, Bench::percentile(samples, 0.99) / 1000.0,
+		    Bench::percentile(samples, 0.999) / 1000.0, samples.back() / 1000.0);
+}
+
+// 一个线程不停入队，另一个线程逐个出队或批量取出；队列满 / 空时让出 CPU
+template<typename T, typename Make> void throughput(const char *name, size_t count, bool batch, Make make)
+{
+	SpscRing<T> ring(16384);
+	auto start = Bench::Clock::now();
+	std::thread consumer([&] {
+		size_t received = 0;
+		T value;
+		while (received < count) {
+			size_t n = 0;
+			if (batch) {
+				n = ring.drain([&](T &v) { Bench::g_sink = Bench::g_sink + sizeof(v); }, 256);
+			} else if (ring.tryPop(value)) {
+				n = 1;
+			}
+			if (n == 0)
+				std::this_thread::yield();
+			received += n;
+		}
+	});
+	for (size_t i = 0; i < count; ++i) {
+		T value = make(i);
+		while (!ring.tryPush(std::move(value)))
+			std::this_thread::yield();
+	}
+	consumer.join();
+	double ns = std::chrono::duration<double, std::nano>(Bench::Clock::now() - start).count();
+	Bench::report(name, ns, static_cast<double>(count), "item");
+}
+
+// 生产者每隔 intervalUs 微秒放入一个带时间戳的元素，消费者忙等取出并记录延迟
+void ringLatency(size_t count, int intervalUs)
+{
+	SpscRing<int64_t> ring(1024);
+	std::vector<int64_t> samples;
+	samples.reserve(count);
+	std::thread consumer([&] {
+		int64_t stamp;
+		while (samples.size() < count) {
+			if (ring.tryPop(stamp))
+				samples.push_back(nowNs() - stamp);
+			else
+				std::this_thread::yield();
+		}
+	});
+	for (size_t i = 0; i < count; ++i) {
+		auto due = Bench::Clock::now() + std::chrono::microseconds(intervalUs);
+		int64_t stamp = nowNs();
+		ring.tryPush(std::move(stamp));
+		while (Bench::Clock::now() < due)
+			std::this_thread::yield();
+	}
+	consumer.join();
+	printLatency("SpscRing push -> pop", samples);
+}
+
+// EventBus 端到端：publish 到消费者回调，包含分发线程空闲时的休眠
+void busLatency(size_t count, int intervalUs)
+{
+	Core::EventBus bus;
+	std::vector<int64_t> samples;
+	samples.reserve(count);
+	std::atomic<size_t> received{0};
+	bus.subscribe([&](const Danmaku::Event *events, size_t n) {
+		int64_t now = nowNs();
+		for (size_t i = 0; i < n; ++i)
+			samples.push_back(now - events[i].value);
+		received += n;
+	});
+	bus.start();
+	for (size_t i = 0; i < count; ++i) {
+		Danmaku::Event event;
+		event.value = nowNs();
+		bus.publish(std::move(event));
+		std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+	}
+	while (received < count)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	bus.stop();
+	printLatency("EventBus publish -> consumer", samples);
+}
+} // namespace
+
+int main()
+{
+	std::printf("硬件线程数: %u\n", std::thread::hardware_concurrency());
+
+	throughput<uint64_t>("ring<uint64_t> tryPop", 20000000, false, [](size_t i) { return uint64_t(i); });
+	throughput<uint64_t>("ring<uint64_t> drain(256)", 20000000, true, [](size_t i) { return uint64_t(i); });
+	auto makeEvent = [](size_t i) {
+		Danmaku::Event event;
+		event.uid = static_cast<int64_t>(i);
+		event.uname = "观众昵称";
+		event.text = "主播晚上好呀今天播什么";
+		return event;
+	};
+	throughput<Danmaku::Event>("ring<Event> tryPop", 2000000, false, makeEvent);
+	throughput<Danmaku::Event>("ring<Event> drain(256)", 2000000, true, makeEvent);
+
+	ringLatency(100000, 20);
+	busLatency(2000, 1000);
+	return 0;
+}
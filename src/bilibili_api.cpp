@@ -1,9 +1,15 @@
 ﻿#include "bilibili_api.hpp"
+#include "bilibili_schema.hpp"
 #include "http_client.hpp"
 #include "md5.hpp"
+#include "rsa.hpp"
 #include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include "plugin_utils.hpp"
 #include "util/base.h"
 
@@ -68,13 +74,25 @@ std::string BiliApi::appsign(const std::vector<std::pair<std::string, std::strin
 	return query.str();
 }
 
+// 预热和开播共用一个 HttpSession，预热建立的连接可以被随后的开播请求直接复用。
+// 预热在 HTTP 工作线程上、开播在 UI 线程上进行，用 live_session_mutex 保证不会同时使用
+static std::mutex live_session_mutex;
+static std::unique_ptr<Http::HttpSession> live_session;
+
 void BiliApi::init()
 {
 	Http::HttpClient::init();
+	std::lock_guard<std::mutex> lock(live_session_mutex);
+	live_session = std::make_unique<Http::HttpSession>();
 }
 
 void BiliApi::cleanup()
 {
+	{
+		// 必须在 curl_global_cleanup 之前释放
+		std::lock_guard<std::mutex> lock(live_session_mutex);
+		live_session.reset();
+	}
 	Http::HttpClient::cleanup();
 }
 
@@ -92,15 +110,18 @@ bool BiliApi::getQrCode(const std::string &cookies, std::string &qr_data, std::s
 		return false;
 	}
 
+	// 只取两个字段，按路径提取，不构建整棵树
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty()) {
+	std::vector<std::string_view> values;
+	if (!Schema::extract(response.data, {"data.url", "data.qrcode_key"}, values, err)) {
 		message = "Json 解析失败: " + err;
 		return false;
 	}
 
-	qr_data = json["data"]["url"].string_value();
-	qr_key = json["data"]["qrcode_key"].string_value();
+	qr_data.clear();
+	qr_key.clear();
+	Schema::decodeRaw(values[0], qr_data);
+	Schema::decodeRaw(values[1], qr_key);
 	if (qr_data.empty() || qr_key.empty()) {
 		message = "无法提取二维码数据或密钥";
 		return false;
@@ -111,9 +132,16 @@ bool BiliApi::getQrCode(const std::string &cookies, std::string &qr_data, std::s
 }
 
 bool BiliApi::qrLogin(std::string &qr_key, std::string &cookies, std::string &message)
+{
+	Http::HttpSession session;
+	return pollQrLogin(session, qr_key, cookies, message) == 0;
+}
+
+int BiliApi::pollQrLogin(Http::HttpSession &session, const std::string &qr_key, std::string &cookies,
+			 std::string &message, std::string *refresh_token)
 {
 	std::string url = "https://passport.bilibili.com/x/passport-login/web/qrcode/poll?qrcode_key=" + qr_key;
-	auto response = Http::HttpClient::get(url, default_headers);
+	auto response = session.get(url, default_headers);
 	obs_log(LOG_INFO, "检查二维码登录状态: %s", response.data.c_str());
 	if (response.status != 200) {
 		message = "检查二维码登录状态失败，状态码: " + std::to_string(response.status);
@@ -121,37 +149,37 @@ bool BiliApi::qrLogin(std::string &qr_key, std::string &cookies, std::string &me
 
 			message += ", 数据: " + response.data;
 		}
-		return false;
+		return -1;
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty()) {
+	ApiResponse<QrPollData> poll;
+	if (!Schema::decode(response.data, poll, err)) {
 		obs_log(LOG_ERROR, "JSON 解析失败: %s", err.c_str());
 		message = "JSON 解析失败: " + err;
-		return false;
+		return -1;
 	}
 
-	int code = json["data"]["code"].int_value();
+	int code = static_cast<int>(poll.data.code);
 	if (code != 0) {
 		if (code == 86038) {
-			obs_log(LOG_ERROR, "二维码已失效: %s", json["message"].string_value().c_str());
-			message = "二维码已失效: " + json["message"].string_value();
+			obs_log(LOG_ERROR, "二维码已失效: %s", poll.message.c_str());
+			message = "二维码已失效: " + poll.message;
 		} else if (code == 86090) {
 			obs_log(LOG_INFO, "二维码已扫描，等待确认");
 			message = "二维码已扫描，等待确认";
+		} else if (code == 86101) {
+			message = "等待扫码";
 		} else {
-			obs_log(LOG_ERROR, "API 返回错误，code: %d, message: %s", code,
-				json["message"].string_value().c_str());
-			message = "API 返回错误，code: " + std::to_string(code) +
-				  ", message: " + json["message"].string_value();
+			obs_log(LOG_ERROR, "API 返回错误，code: %d, message: %s", code, poll.message.c_str());
+			message = "API 返回错误，code: " + std::to_string(code) + ", message: " + poll.message;
 		}
-		return false;
+		return code;
 	}
 
 	cookies = response.cookies;
 	if (cookies.empty()) {
-		std::string loginUrl = json["data"]["url"].string_value();
+		const std::string &loginUrl = poll.data.url;
 		if (!loginUrl.empty()) {
 			obs_log(LOG_INFO, "从 URL 解析 Cookies...");
 
@@ -180,17 +208,26 @@ bool BiliApi::qrLogin(std::string &qr_key, std::string &cookies, std::string &me
 	if (cookies.empty()) {
 		obs_log(LOG_ERROR, "无法获取登录 Cookies");
 		message = "无法获取登录 Cookies";
-		return false;
+		return -1;
 	}
 
+	if (refresh_token)
+		*refresh_token = poll.data.refresh_token;
 	message = "二维码登录成功";
-	return true;
+	return 0;
 }
 
 bool BiliApi::checkLoginStatus(const std::string &cookies, std::string &message, std::string &mid)
+{
+	Http::HttpSession session;
+	return checkLoginStatus(session, cookies, message, mid);
+}
+
+bool BiliApi::checkLoginStatus(Http::HttpSession &session, const std::string &cookies, std::string &message,
+			       std::string &mid)
 {
 	auto headers = buildHeaders(cookies);
-	auto response = Http::HttpClient::get("https://api.bilibili.com/x/web-interface/nav", headers);
+	auto response = session.get("https://api.bilibili.com/x/web-interface/nav", headers);
 	obs_log(LOG_INFO, "检查登录状态: %s", response.data.c_str());
 	if (response.status != 200) {
 		message = "检查登录状态失败，状态码: " + std::to_string(response.status);
@@ -201,16 +238,16 @@ bool BiliApi::checkLoginStatus(const std::string &cookies, std::string &message,
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty()) {
+	ApiResponse<NavData> nav;
+	if (!Schema::decode(response.data, nav, err)) {
 		obs_log(LOG_ERROR, "JSON 解析失败: %s", err.c_str());
 		message = "JSON 解析失败: " + err;
 		return false;
 	}
 
-	bool is_login = json["data"]["isLogin"].bool_value();
+	bool is_login = nav.data.is_login;
 	if (is_login) {
-		mid = std::to_string(static_cast<long long>(json["data"]["mid"].number_value()));
+		mid = std::to_string(nav.data.mid);
 	}
 	obs_log(LOG_INFO, "检查登录状态: %s", is_login ? "已登录" : "未登录");
 	message = "检查登录状态: " + std::string(is_login ? "已登录" : "未登录");
@@ -219,6 +256,13 @@ bool BiliApi::checkLoginStatus(const std::string &cookies, std::string &message,
 
 bool BiliApi::getRoomIdAndCsrf(const std::string &cookies, std::string &room_id, std::string &csrf_token,
 			       std::string &message)
+{
+	Http::HttpSession session;
+	return getRoomIdAndCsrf(session, cookies, room_id, csrf_token, message);
+}
+
+bool BiliApi::getRoomIdAndCsrf(Http::HttpSession &session, const std::string &cookies, std::string &room_id,
+			       std::string &csrf_token, std::string &message)
 {
 	if (cookies.empty()) {
 		obs_log(LOG_ERROR, "Cookies 为空");
@@ -236,7 +280,7 @@ bool BiliApi::getRoomIdAndCsrf(const std::string &cookies, std::string &room_id,
 
 	std::string url = "https://api.live.bilibili.com/room/v2/Room/room_id_by_uid?uid=" + dede_user_id;
 	auto headers = buildHeaders(cookies);
-	auto response = Http::HttpClient::get(url, headers);
+	auto response = session.get(url, headers);
 	obs_log(LOG_INFO, "获取房间号: %s", response.data.c_str());
 	if (response.status != 200) {
 		message = "获取房间号失败，状态码: " + std::to_string(response.status);
@@ -247,21 +291,20 @@ bool BiliApi::getRoomIdAndCsrf(const std::string &cookies, std::string &room_id,
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty()) {
+	ApiResponse<RoomIdData> room;
+	if (!Schema::decode(response.data, room, err)) {
 		obs_log(LOG_ERROR, "JSON 解析失败: %s", err.c_str());
 		message = "Json 解析失败: " + err;
 		return false;
 	}
-	if (json["code"].int_value() != 0) {
-		obs_log(LOG_ERROR, "API 返回错误，code: %d, message: %s", json["code"].int_value(),
-			json["message"].string_value().c_str());
-		message = "API 返回错误， code: " + std::to_string(json["code"].int_value()) +
-			  ", message: " + json["message"].string_value();
+	if (room.code != 0) {
+		obs_log(LOG_ERROR, "API 返回错误，code: %lld, message: %s", static_cast<long long>(room.code),
+			room.message.c_str());
+		message = "API 返回错误， code: " + std::to_string(room.code) + ", message: " + room.message;
 		return false;
 	}
 
-	room_id = std::to_string(json["data"]["room_id"].int_value());
+	room_id = std::to_string(room.data.room_id);
 	pos = cookies.find("bili_jct=");
 	if (pos == std::string::npos) {
 		//obs_log(LOG_ERROR, "无法从 Cookies 中提取 bili_jct");
@@ -273,7 +316,238 @@ bool BiliApi::getRoomIdAndCsrf(const std::string &cookies, std::string &room_id,
 	return true;
 }
 
-json11::Json BiliApi::getPartitionList(std::string &message)
+bool BiliApi::getLiveStatus(Http::HttpSession &session, const std::string &room_id, int &live_status,
+			    std::string &etag, std::string &message)
+{
+	auto headers = default_headers;
+	if (!etag.empty())
+		headers.push_back("If-None-Match: " + etag);
+	auto response =
+		session.get("https://api.live.bilibili.com/room/v1/Room/get_info?room_id=" + room_id, headers, 5000);
+	if (response.status == 304)
+		return true;
+	if (response.status != 200) {
+		message = "获取直播间状态失败，状态码: " + std::to_string(response.status);
+		if (!response.data.empty()) {
+			message += ", 数据: " + response.data;
+		}
+		return false;
+	}
+
+	std::string err;
+	ApiResponse<RoomInfoData> info;
+	if (!Schema::decode(response.data, info, err) || info.code != 0) {
+		message = "解析直播间状态失败: " + (err.empty() ? info.message : err);
+		return false;
+	}
+	etag = response.etag;
+	live_status = static_cast<int>(info.data.live_status);
+	return true;
+}
+
+// Cookie 刷新流程中加密 correspondPath 用的公钥（RSA-1024，e = 65537）
+static const unsigned char correspond_key[] = {
+	0xcb, 0x81, 0xdd, 0x8e, 0x02, 0x47, 0x06, 0x56, 0xda, 0x04, 0xdd, 0x38, 0x54, 0x44, 0x46, 0xe2,
+	0xa3, 0x41, 0x20, 0x51, 0xcf, 0xe9, 0xad, 0xc6, 0xa3, 0x30, 0xa5, 0xef, 0x90, 0x22, 0x85, 0x09,
+	0x68, 0x49, 0x60, 0x97, 0x0b, 0x91, 0xc3, 0x36, 0x0c, 0xa2, 0x9c, 0x49, 0xe1, 0x69, 0x0f, 0xf8,
+	0xfa, 0x06, 0x8c, 0xb9, 0xdf, 0xc6, 0x17, 0x9d, 0x1e, 0x95, 0x85, 0xcb, 0x94, 0x24, 0xe8, 0x47,
+	0xdb, 0x1e, 0xf5, 0x9f, 0x33, 0xe3, 0x7d, 0xd4, 0xdc, 0xa8, 0xcc, 0xfb, 0x76, 0x31, 0xee, 0x9b,
+	0x4a, 0x92, 0x64, 0x0d, 0x00, 0xc8, 0x20, 0x43, 0x00, 0x15, 0x2a, 0x0a, 0xb7, 0xcd, 0x80, 0x28,
+	0x89, 0xd3, 0x44, 0x5a, 0xec, 0x69, 0x91, 0x8f, 0xe6, 0x02, 0x2b, 0x53, 0x49, 0x12, 0xe7, 0xb0,
+	0x95, 0xbe, 0x34, 0x24, 0xda, 0xd1, 0xba, 0x81, 0x14, 0x5e, 0x96, 0x9b, 0x53, 0x31, 0x81, 0xf1};
+
+std::string BiliApi::cookieValue(const std::string &cookies, const std::string &name)
+{
+	size_t pos = 0;
+	while ((pos = cookies.find(name + "=", pos)) != std::string::npos) {
+		// 只匹配完整的键名，避免 DedeUserID 命中 DedeUserID__ckMd5
+		if (pos == 0 || cookies[pos - 1] == ' ' || cookies[pos - 1] == ';') {
+			size_t start = pos + name.size() + 1;
+			size_t end = cookies.find(';', start);
+			return cookies.substr(start, end == std::string::npos ? std::string::npos : end - start);
+		}
+		pos += name.size();
+	}
+	return "";
+}
+
+std::string BiliApi::mergeCookies(const std::string &cookies, const std::string &updates)
+{
+	// 按键名合并，updates 中的值覆盖旧值，其余保持原顺序
+	std::vector<std::pair<std::string, std::string>> merged;
+	auto apply = [&](const std::string &list) {
+		std::istringstream stream(list);
+		std::string item;
+		while (std::getline(stream, item, ';')) {
+			size_t begin = item.find_first_not_of(' ');
+			size_t eq = item.find('=');
+			if (begin == std::string::npos || eq == std::string::npos || eq <= begin)
+				continue;
+			std::string key = item.substr(begin, eq - begin);
+			std::string value = item.substr(eq + 1);
+			auto it = std::find_if(merged.begin(), merged.end(),
+					       [&](const auto &entry) { return entry.first == key; });
+			if (it != merged.end())
+				it->second = value;
+			else
+				merged.emplace_back(key, value);
+		}
+	};
+	apply(cookies);
+	apply(updates);
+
+	std::string out;
+	for (const auto &entry : merged)
+		out += entry.first + "=" + entry.second + "; ";
+	if (!out.empty())
+		out.resize(out.size() - 2);
+	return out;
+}
+
+int64_t BiliApi::sessionExpiry(const std::string &cookies)
+{
+	// SESSDATA 形如 <id>%2C<过期时间>%2C<校验>
+	std::string sessdata = cookieValue(cookies, "SESSDATA");
+	size_t start = sessdata.find("%2C");
+	size_t skip = 3;
+	if (start == std::string::npos) {
+		start = sessdata.find(',');
+		skip = 1;
+	}
+	if (start == std::string::npos)
+		return 0;
+	return strtoll(sessdata.c_str() + start + skip, nullptr, 10);
+}
+
+std::string BiliApi::buildCorrespondPath(int64_t timestamp_ms)
+{
+	std::string plain = "refresh_" + std::to_string(timestamp_ms);
+	auto cipher = Crypto::rsaOaepSha256Encrypt(correspond_key, sizeof(correspond_key), 65537,
+						   reinterpret_cast<const unsigned char *>(plain.data()),
+						   plain.size());
+	std::string hex;
+	char byte[3];
+	for (unsigned char c : cipher) {
+		snprintf(byte, sizeof(byte), "%02x", c);
+		hex += byte;
+	}
+	return hex;
+}
+
+bool BiliApi::getCookieInfo(Http::HttpSession &session, const std::string &cookies, bool &need_refresh,
+			    std::string &message)
+{
+	std::string url = "https://passport.bilibili.com/x/passport-login/web/cookie/info?csrf=" +
+			  cookieValue(cookies, "bili_jct");
+	auto response = session.get(url, buildHeaders(cookies));
+	if (response.status != 200) {
+		message = "检查 Cookie 状态失败，状态码: " + std::to_string(response.status);
+		return false;
+	}
+
+	std::string err;
+	ApiResponse<CookieInfoData> info;
+	if (!Schema::decode(response.data, info, err) || info.code != 0) {
+		message = "检查 Cookie 状态失败: " + (err.empty() ? info.message : err);
+		return false;
+	}
+	need_refresh = info.data.refresh;
+	return true;
+}
+
+bool BiliApi::refreshCookies(Http::HttpSession &session, const std::string &cookies, const std::string &refresh_token,
+			     std::string &new_cookies, std::string &new_refresh_token, std::string &message)
+{
+	std::string csrf = cookieValue(cookies, "bili_jct");
+	if (csrf.empty() || refresh_token.empty()) {
+		message = "缺少 bili_jct 或 refresh_token，需要重新扫码登录";
+		return false;
+	}
+
+	// 1. 用公钥加密当前时间得到 correspondPath，从对应页面中取出 refresh_csrf
+	int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+				 std::chrono::system_clock::now().time_since_epoch())
+				 .count();
+	std::string path = buildCorrespondPath(now_ms);
+	if (path.empty()) {
+		message = "生成 correspondPath 失败";
+		return false;
+	}
+	auto page = session.get("https://www.bilibili.com/correspond/1/" + path, buildHeaders(cookies));
+	const std::string marker = "<div id=\"1-name\">";
+	size_t start = page.status == 200 ? page.data.find(marker) : std::string::npos;
+	size_t end = start == std::string::npos ? start : page.data.find("</div>", start);
+	if (end == std::string::npos) {
+		message = "获取 refresh_csrf 失败，状态码: " + std::to_string(page.status);
+		return false;
+	}
+	start += marker.size();
+	std::string refresh_csrf = page.data.substr(start, end - start);
+
+	// 2. 刷新 cookies，新的 cookies 通过 Set-Cookie 下发
+	std::string data = "csrf=" + urlEncode(csrf) + "&refresh_csrf=" + urlEncode(refresh_csrf) +
+			   "&source=main_web&refresh_token=" + urlEncode(refresh_token);
+	auto response = session.post("https://passport.bilibili.com/x/passport-login/web/cookie/refresh", data,
+				     buildHeaders(cookies));
+	if (response.status != 200) {
+		message = "刷新 Cookie 失败，状态码: " + std::to_string(response.status);
+		return false;
+	}
+	std::string err;
+	ApiResponse<CookieRefreshData> refreshed;
+	if (!Schema::decode(response.data, refreshed, err) || refreshed.code != 0) {
+		message = "刷新 Cookie 失败: " + (err.empty() ? refreshed.message : err);
+		return false;
+	}
+	if (cookieValue(response.cookies, "SESSDATA").empty() || refreshed.data.refresh_token.empty()) {
+		message = "刷新 Cookie 失败: 响应中没有新的 SESSDATA";
+		return false;
+	}
+	new_cookies = mergeCookies(cookies, response.cookies);
+	new_refresh_token = refreshed.data.refresh_token;
+
+	// 3. 用新 cookies 确认刷新，旧 refresh_token 随之失效；确认失败不影响新 cookies 的使用
+	std::string confirm = "csrf=" + urlEncode(cookieValue(new_cookies, "bili_jct")) +
+			      "&refresh_token=" + urlEncode(refresh_token);
+	auto confirmed = session.post("https://passport.bilibili.com/x/passport-login/web/confirm/refresh", confirm,
+				      buildHeaders(new_cookies));
+	ApiResponse<Ignored> ack;
+	if (confirmed.status != 200 || !Schema::decode(confirmed.data, ack, err) || ack.code != 0)
+		obs_log(LOG_WARNING, "确认 Cookie 刷新失败，状态码: %ld", confirmed.status);
+
+	message = "Cookie 刷新成功";
+	return true;
+}
+
+bool BiliApi::getDanmuInfo(Http::HttpSession &session, const std::string &cookies, const std::string &room_id,
+			   DanmuInfoData &info, std::string &message)
+{
+	auto headers = buildHeaders(cookies);
+	auto response = session.get(
+		"https://api.live.bilibili.com/xlive/web-room/v1/index/getDanmuInfo?type=0&id=" + room_id, headers);
+	if (response.status != 200) {
+		message = "获取弹幕服务器失败，状态码: " + std::to_string(response.status);
+		if (!response.data.empty()) {
+			message += ", 数据: " + response.data;
+		}
+		return false;
+	}
+
+	std::string err;
+	ApiResponse<DanmuInfoData> result;
+	if (!Schema::decode(response.data, result, err) || result.code != 0) {
+		message = "解析弹幕服务器信息失败: " + (err.empty() ? result.message : err);
+		return false;
+	}
+	if (result.data.token.empty() || result.data.host_list.empty()) {
+		message = "弹幕服务器信息为空";
+		return false;
+	}
+	info = std::move(result.data);
+	return true;
+}
+
+bool BiliApi::getPartitionList(std::vector<Partition> &partitions, std::string &message)
 {
 	auto response = Http::HttpClient::get("https://api.live.bilibili.com/room/v1/Area/getList", default_headers);
 	obs_log(LOG_INFO, "获取分区列表: %s", response.data.c_str());
@@ -283,21 +557,22 @@ json11::Json BiliApi::getPartitionList(std::string &message)
 		if (!response.data.empty()) {
 			message += ", 数据: " + response.data;
 		}
-		return json11::Json();
+		return false;
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty() || !json["data"].is_array()) {
+	ApiResponse<std::vector<Partition>> list;
+	if (!Schema::decode(response.data, list, err) || list.data.empty()) {
 		message = "解析分区列表失败: " + std::string(err.empty() ? "无数据数组" : err);
-		return json11::Json();
+		return false;
 	}
+	partitions = std::move(list.data);
 	message = "获取分区列表成功";
-	return json["data"];
+	return true;
 }
 
 bool BiliApi::startLive(Config &config, std::string &rtmp_addr, std::string &rtmp_code, std::string &message,
-			std::string &face_qr, std::string &mid)
+			std::string &face_qr, std::string &mid, std::vector<RtmpInfo> *candidates)
 {
 	if (config.room_id.empty() || config.csrf_token.empty()) {
 		obs_log(LOG_ERROR, "配置无效: room_id=%s, csrf_token=%s, title=%s",
@@ -306,42 +581,23 @@ bool BiliApi::startLive(Config &config, std::string &rtmp_addr, std::string &rtm
 		return false;
 	}
 
-	std::vector<std::pair<std::string, std::string>> version_params = {{"system_version", "2"},
-									   {"ts", std::to_string(time(nullptr))}};
-	std::string version_query = appsign(version_params, APP_KEY, APP_SECRET);
-	std::string version_url =
-		"https://api.live.bilibili.com/xlive/app-blink/v1/liveVersionInfo/getHomePageLiveVersion?" +
-		version_query;
-
-	auto headers = buildHeaders(config.cookies);
-	auto version_response = Http::HttpClient::get(version_url, headers);
-	obs_log(LOG_INFO, "获取直播版本信息: %s", version_response.data.c_str());
-	if (version_response.status != 200) {
-		obs_log(LOG_ERROR, "获取直播版本信息失败，状态码: %ld", version_response.status);
-		message = "获取直播版本信息失败，状态码: " + std::to_string(version_response.status);
+	std::lock_guard<std::mutex> lock(live_session_mutex);
+	if (!live_session) {
+		message = "网络未初始化";
 		return false;
 	}
-
-	std::string err;
-	json11::Json json = json11::Json::parse(version_response.data, err);
-	if (!err.empty() || json["code"].int_value() != 0) {
-		obs_log(LOG_ERROR, "获取直播版本信息失败: %s", err.c_str());
-		message = "解析直播版本信息失败: " + (err.empty() ? json["message"].string_value() : err);
-		return false;
-	}
-
-	long build = json["data"]["build"].int_value();
-	std::string curr_version = json["data"]["curr_version"].string_value();
-	if (build == 0 || curr_version.empty()) {
-		obs_log(LOG_ERROR, "无效的 build 或 curr_version");
-		message = "无效的 build 或 curr_version";
+	auto headers = buildHeaders(config.cookies);
+	VersionData version;
+	if (!getLiveVersion(*live_session, headers, version, message))
 		return false;
-	}
+	int64_t build = version.build;
+	const std::string &curr_version = version.curr_version;
+	std::string err;
 
 	std::vector<std::pair<std::string, std::string>> start_params = {{"room_id", config.room_id},
 									 {"platform", "pc_link"},
 									 {"area_v2", std::to_string(config.area_id)},
-									 {"backup_stream", "0"},
+									 {"backup_stream", config.backup_stream ? "1" : "0"},
 									 {"csrf_token", config.csrf_token},
 									 {"csrf", config.csrf_token},
 									 {"build", std::to_string(build)},
@@ -349,8 +605,7 @@ bool BiliApi::startLive(Config &config, std::string &rtmp_addr, std::string &rtm
 									 {"ts", std::to_string(time(nullptr))}};
 	std::string start_data = appsign(start_params, APP_KEY, APP_SECRET);
 
-	auto response =
-		Http::HttpClient::post("https://api.live.bilibili.com/room/v1/Room/startLive", start_data, headers);
+	auto response = live_session->post("https://api.live.bilibili.com/room/v1/Room/startLive", start_data, headers);
 	obs_log(LOG_INFO, "启动直播: %s", response.data.c_str());
 	if (response.status != 200) {
 		obs_log(LOG_ERROR, "启动直播失败，状态码: %ld", response.status);
@@ -358,15 +613,20 @@ bool BiliApi::startLive(Config &config, std::string &rtmp_addr, std::string &rtm
 		return false;
 	}
 
-	json = json11::Json::parse(response.data, err);
-	int code = json["code"].int_value();
+	ApiResponse<StartLiveData> start;
+	if (!Schema::decode(response.data, start, err)) {
+		obs_log(LOG_ERROR, "JSON 解析失败: %s", err.c_str());
+		message = "JSON 解析失败: " + err;
+		return false;
+	}
+	int64_t code = start.code;
 	obs_log(LOG_INFO, "开始直播，mid: %s", mid.c_str());
 	if (code != 0) {
-		message = json["message"].string_value();
+		message = start.message;
 
 		// 如果是人脸识别
 		if (code == 60024) {
-			std::string face_url = json["data"]["qr"].string_value();
+			std::string face_url = start.data.qr;
 			obs_log(LOG_WARNING, "60024 需要人脸识别，URL: %s", face_url.c_str());
 			// 这里可以弹出一个对话框或者在 UI 上显示二维码
 			message = "需要人脸验证，请扫描二维码" + face_url;
@@ -383,38 +643,149 @@ bool BiliApi::startLive(Config &config, std::string &rtmp_addr, std::string &rtm
 		return false;
 	}
 
-	rtmp_addr = json["data"]["rtmp"]["addr"].string_value();
-	rtmp_code = json["data"]["rtmp"]["code"].string_value();
+	rtmp_addr = start.data.rtmp.addr;
+	rtmp_code = start.data.rtmp.code;
 	if (rtmp_addr.empty() || rtmp_code.empty()) {
 		//obs_log(LOG_ERROR, "无法解析 RTMP 地址或推流码");
 		return false;
 	}
 
+	if (candidates) {
+		candidates->clear();
+		candidates->push_back(start.data.rtmp);
+		for (const auto &protocol : start.data.protocols) {
+			if (protocol.protocol != "rtmp" || protocol.addr.empty() || protocol.code.empty())
+				continue;
+			bool duplicate = false;
+			for (const auto &candidate : *candidates)
+				duplicate = duplicate || candidate.addr == protocol.addr;
+			if (!duplicate)
+				candidates->push_back({protocol.addr, protocol.code});
+		}
+	}
+
 	//obs_log(LOG_INFO, "直播启动成功，RTMP 地址: %s, 推流码: %s", rtmp_addr.c_str(), rtmp_code.c_str());
 	return true;
 }
 
+// 版本信息很少变化，缓存一段时间，开播时少一次往返
+static const auto version_ttl = std::chrono::minutes(10);
+static std::mutex version_mutex;
+static VersionData cached_version;
+static std::chrono::steady_clock::time_point cached_version_time;
+
+std::string BiliApi::buildVersionUrl()
+{
+	std::vector<std::pair<std::string, std::string>> version_params = {{"system_version", "2"},
+									   {"ts", std::to_string(time(nullptr))}};
+	return "https://api.live.bilibili.com/xlive/app-blink/v1/liveVersionInfo/getHomePageLiveVersion?" +
+	       appsign(version_params, APP_KEY, APP_SECRET);
+}
+
+bool BiliApi::parseVersionResponse(long status, const std::string &data, VersionData &version,
+				   std::string &message)
+{
+	obs_log(LOG_INFO, "获取直播版本信息: %s", data.c_str());
+	if (status != 200) {
+		obs_log(LOG_ERROR, "获取直播版本信息失败，状态码: %ld", status);
+		message = "获取直播版本信息失败，状态码: " + std::to_string(status);
+		return false;
+	}
+
+	std::string err;
+	ApiResponse<VersionData> result;
+	if (!Schema::decode(data, result, err) || result.code != 0) {
+		obs_log(LOG_ERROR, "获取直播版本信息失败: %s", err.c_str());
+		message = "解析直播版本信息失败: " + (err.empty() ? result.message : err);
+		return false;
+	}
+	if (result.data.build == 0 || result.data.curr_version.empty()) {
+		obs_log(LOG_ERROR, "无效的 build 或 curr_version");
+		message = "无效的 build 或 curr_version";
+		return false;
+	}
+
+	version = std::move(result.data);
+	std::lock_guard<std::mutex> lock(version_mutex);
+	cached_version = version;
+	cached_version_time = std::chrono::steady_clock::now();
+	return true;
+}
+
+bool BiliApi::getLiveVersion(Http::HttpSession &session, const std::vector<std::string> &headers,
+			     VersionData &version, std::string &message)
+{
+	{
+		std::lock_guard<std::mutex> lock(version_mutex);
+		if (cached_version.build && std::chrono::steady_clock::now() - cached_version_time < version_ttl) {
+			version = cached_version;
+			return true;
+		}
+	}
+	auto response = session.get(buildVersionUrl(), headers);
+	return parseVersionResponse(response.status, response.data, version, message);
+}
+
+void BiliApi::prewarmAsync(const Config &config)
+{
+	// 在开播用的 session 上请求版本信息，连接留给随后的 startLive
+	Http::HttpClient::runAsync([headers = buildHeaders(config.cookies)]() {
+		std::lock_guard<std::mutex> lock(live_session_mutex);
+		if (!live_session)
+			return;
+		auto response = live_session->get(buildVersionUrl(), headers);
+		VersionData version;
+		std::string message;
+		if (!parseVersionResponse(response.status, response.data, version, message))
+			obs_log(LOG_WARNING, "预热失败: %s", message.c_str());
+	});
+}
+
+static std::string buildStopLiveData(const Config &config)
+{
+	return "room_id=" + config.room_id + "&platform=pc_link&csrf_token=" + config.csrf_token +
+	       "&csrf=" + config.csrf_token;
+}
+
 bool BiliApi::stopLive(const Config &config, std::string &message)
 {
-	std::string data = "room_id=" + config.room_id + "&platform=pc_link&csrf_token=" + config.csrf_token +
-			   "&csrf=" + config.csrf_token;
 	auto headers = buildHeaders(config.cookies);
-	auto response = Http::HttpClient::post("https://api.live.bilibili.com/room/v1/Room/stopLive", data, headers);
-	obs_log(LOG_INFO, "停止直播: %s", response.data.c_str());
-	if (response.status != 200) {
-		message = "停止直播失败，状态码: " + std::to_string(response.status);
-		if (!response.data.empty()) {
-			message += ", 数据: " + response.data;
+	auto response = Http::HttpClient::post("https://api.live.bilibili.com/room/v1/Room/stopLive",
+					       buildStopLiveData(config), headers);
+	return parseStopLiveResponse(response.status, response.data, message);
+}
+
+void BiliApi::stopLiveAsync(const Config &config, std::function<void(bool ok, const std::string &message)> callback,
+			    long timeout_ms)
+{
+	Http::HttpClient::postAsync(
+		"https://api.live.bilibili.com/room/v1/Room/stopLive", buildStopLiveData(config),
+		buildHeaders(config.cookies),
+		[callback](Http::HttpResponse response) {
+			std::string message;
+			bool ok = parseStopLiveResponse(response.status, response.data, message);
+			if (callback)
+				callback(ok, message);
+		},
+		timeout_ms);
+}
+
+bool BiliApi::parseStopLiveResponse(long status, const std::string &data, std::string &message)
+{
+	obs_log(LOG_INFO, "停止直播: %s", data.c_str());
+	if (status != 200) {
+		message = "停止直播失败，状态码: " + std::to_string(status);
+		if (!data.empty()) {
+			message += ", 数据: " + data;
 		}
 		return false;
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty() || json["code"].int_value() != 0) {
-		obs_log(LOG_ERROR, "停止直播失败: %s",
-			err.empty() ? json["message"].string_value().c_str() : err.c_str());
-		message = "停止直播失败: " + (err.empty() ? json["message"].string_value() : err);
+	ApiResponse<StopLiveData> stop;
+	if (!Schema::decode(data, stop, err) || stop.code != 0) {
+		obs_log(LOG_ERROR, "停止直播失败: %s", err.empty() ? stop.message.c_str() : err.c_str());
+		message = "停止直播失败: " + (err.empty() ? stop.message : err);
 		return false;
 	}
 
@@ -422,31 +793,77 @@ bool BiliApi::stopLive(const Config &config, std::string &message)
 	return true;
 }
 
-bool BiliApi::updateRoomInfo(const Config &config, const std::string &title, std::string &message)
+std::string BiliApi::urlEncode(const std::string &value)
 {
-	std::string data = "room_id=" + config.room_id + "&platform=pc_link&title=" + title +
-			   "&csrf_token=" + config.csrf_token + "&csrf=" + config.csrf_token;
-	auto headers = buildHeaders(config.cookies);
-	auto response = Http::HttpClient::post("https://api.live.bilibili.com/room/v1/Room/update", data, headers);
-	obs_log(LOG_INFO, "更新房间信息: %s", response.data.c_str());
-	if (response.status != 200) {
-		obs_log(LOG_ERROR, "获取更新房间信息失败，状态码: %ld", response.status);
-		message = "获取更新房间信息失败，状态码: " + std::to_string(response.status);
-		if (!response.data.empty()) {
-			message += ", 数据: " + response.data;
+	static const char hex[] = "0123456789ABCDEF";
+	std::string out;
+	out.reserve(value.size() * 3);
+	for (unsigned char c : value) {
+		if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+			out += static_cast<char>(c);
+		} else {
+			out += '%';
+			out += hex[c >> 4];
+			out += hex[c & 0x0F];
+		}
+	}
+	return out;
+}
+
+std::string BiliApi::buildRoomUpdateData(const Config &config, const RoomInfoUpdate &update)
+{
+	std::string data = "room_id=" + config.room_id + "&platform=pc_link";
+	if (!update.title.empty())
+		data += "&title=" + urlEncode(update.title);
+	if (update.area_id)
+		data += "&area_id=" + std::to_string(update.area_id);
+	data += "&csrf_token=" + config.csrf_token + "&csrf=" + config.csrf_token;
+	return data;
+}
+
+bool BiliApi::parseRoomUpdateResponse(long status, const std::string &data, const RoomInfoUpdate &update,
+				      std::string &message)
+{
+	obs_log(LOG_INFO, "更新房间信息: %s", data.c_str());
+	if (status != 200) {
+		obs_log(LOG_ERROR, "获取更新房间信息失败，状态码: %ld", status);
+		message = "获取更新房间信息失败，状态码: " + std::to_string(status);
+		if (!data.empty()) {
+			message += ", 数据: " + data;
 		}
 		return false;
 	}
 
 	std::string err;
-	json11::Json json = json11::Json::parse(response.data, err);
-	if (!err.empty() || json["code"].int_value() != 0) {
-		//obs_log(LOG_ERROR, "更新直播间信息失败: %s", err.empty() ? json["message"].string_value().c_str() : err.c_str());
-		message = "更新直播间信息失败: " + (err.empty() ? json["message"].string_value() : err);
+	ApiResponse<Ignored> result;
+	if (!Schema::decode(data, result, err) || result.code != 0) {
+		message = "更新直播间信息失败: " + (err.empty() ? result.message : err);
 		return false;
 	}
 
-	obs_log(LOG_INFO, "直播间信息更新成功: %s", title.c_str());
+	obs_log(LOG_INFO, "直播间信息更新成功: title=%s, area_id=%d", update.title.c_str(), update.area_id);
 	return true;
 }
+
+bool BiliApi::updateRoomInfo(const Config &config, const RoomInfoUpdate &update, std::string &message)
+{
+	auto headers = buildHeaders(config.cookies);
+	auto response = Http::HttpClient::post("https://api.live.bilibili.com/room/v1/Room/update",
+					       buildRoomUpdateData(config, update), headers);
+	return parseRoomUpdateResponse(response.status, response.data, update, message);
+}
+
+void BiliApi::updateRoomInfoAsync(const Config &config, const RoomInfoUpdate &update,
+				  std::function<void(bool ok, const std::string &message)> callback)
+{
+	Http::HttpClient::postAsync("https://api.live.bilibili.com/room/v1/Room/update",
+				    buildRoomUpdateData(config, update), buildHeaders(config.cookies),
+				    [update, callback](Http::HttpResponse response) {
+					    std::string message;
+					    bool ok = parseRoomUpdateResponse(response.status, response.data, update,
+									      message);
+					    if (callback)
+						    callback(ok, message);
+				    });
+}
 } // namespace Bili
@@ -1,7 +1,13 @@
 ﻿#pragma once
+#include <functional>
 #include <string>
 #include <vector>
 #include "json11/json11.hpp"
+#include "bilibili_schema.hpp"
+
+namespace Http {
+class HttpSession;
+}
 
 namespace Bili {
 namespace {
@@ -13,6 +19,7 @@ struct Config {
 	std::string room_id;
 	std::string csrf_token;
 	std::string cookies;
+	std::string refresh_token; // 扫码登录时下发，用于到期前刷新 cookies
 	std::string mid;
 	std::string title;
 	bool login_status = false;
@@ -21,6 +28,17 @@ struct Config {
 	std::string rtmp_code;
 	int part_id = 2;
 	int area_id = 86;
+	bool backup_stream = false;    // 开播时申请备用推流节点，主节点异常时自动切换
+	int auto_stop_grace_s = 30;    // OBS 推流停止后多久自动下播，0 表示不自动下播
+	bool adaptive_bitrate = false; // 根据拥塞自动调整编码器码率
+	bool uplink_test = false;      // 开播前对推流节点做上行测速，并按结果限制码率
+	int live_status = -1;          // 最近一次刷新得到的直播间状态，不保存
+};
+
+// Room/update 的一次合并提交；空标题 / area_id 为 0 表示该项不变
+struct RoomInfoUpdate {
+	std::string title;
+	int area_id = 0;
 };
 
 class BiliApi {
@@ -30,17 +48,63 @@ public:
 	static bool getQrCode(const std::string &cookies, std::string &qr_data, std::string &qr_key,
 			      std::string &message);
 	static bool qrLogin(std::string &qr_key, std::string &cookies, std::string &message);
+	// 轮询一次扫码状态，返回接口的 data.code（0 成功，86101 未扫码，86090 已扫码待确认，86038 已失效），网络错误返回 -1
+	static int pollQrLogin(Http::HttpSession &session, const std::string &qr_key, std::string &cookies,
+			       std::string &message, std::string *refresh_token = nullptr);
 	static bool checkLoginStatus(const std::string &cookies, std::string &message, std::string &mid);
 	static bool getRoomIdAndCsrf(const std::string &cookies, std::string &room_id, std::string &csrf_token,
 				     std::string &message);
-	static json11::Json getPartitionList(std::string &message);
+	// 复用调用方的连接，多账号并发刷新时每个账号各持有一个 session
+	static bool checkLoginStatus(Http::HttpSession &session, const std::string &cookies, std::string &message,
+				     std::string &mid);
+	static bool getRoomIdAndCsrf(Http::HttpSession &session, const std::string &cookies, std::string &room_id,
+				     std::string &csrf_token, std::string &message);
+	// 取出 cookies 中某一项的值，不存在时返回空
+	static std::string cookieValue(const std::string &cookies, const std::string &name);
+	// SESSDATA 中携带的过期时间（Unix 秒），无法解析时返回 0
+	static int64_t sessionExpiry(const std::string &cookies);
+	// 询问服务端当前 cookies 是否需要刷新
+	static bool getCookieInfo(Http::HttpSession &session, const std::string &cookies, bool &need_refresh,
+				  std::string &message);
+	// Web 端 Cookie 刷新：换取新的 cookies 和 refresh_token，并确认刷新使旧会话失效
+	static bool refreshCookies(Http::HttpSession &session, const std::string &cookies,
+				   const std::string &refresh_token, std::string &new_cookies,
+				   std::string &new_refresh_token, std::string &message);
+	// 查询直播间状态（live_status: 0 未开播，1 直播中，2 轮播）；etag 用于条件请求，304 时 live_status 不变
+	static bool getLiveStatus(Http::HttpSession &session, const std::string &room_id, int &live_status,
+				  std::string &etag, std::string &message);
+	// 获取弹幕服务器地址列表和鉴权 token
+	// 在弹幕线程上调用：session 带中止标志，停止时可立即中断
+	static bool getDanmuInfo(Http::HttpSession &session, const std::string &cookies, const std::string &room_id,
+				 DanmuInfoData &info, std::string &message);
+	static bool getPartitionList(std::vector<Partition> &partitions, std::string &message);
+	// candidates 非空时填入全部 RTMP 推流节点（第一个为接口默认节点），供测速选择
 	static bool startLive(Config &config, std::string &rtmp_addr, std::string &rtmp_code, std::string &message,
-			      std::string &face_qr, std::string &mid);
+			      std::string &face_qr, std::string &mid, std::vector<RtmpInfo> *candidates = nullptr);
 	static bool stopLive(const Config &config, std::string &message);
-	static bool updateRoomInfo(const Config &config, const std::string &title, std::string &message);
+	// 定时任务前的预热：提前获取直播版本信息（缓存一段时间），并与直播接口建立连接
+	static void prewarmAsync(const Config &config);
+	// 回调在 HTTP 工作线程上执行
+	static void stopLiveAsync(const Config &config, std::function<void(bool ok, const std::string &message)> callback,
+				  long timeout_ms = 10000);
+	static bool updateRoomInfo(const Config &config, const RoomInfoUpdate &update, std::string &message);
+	static void updateRoomInfoAsync(const Config &config, const RoomInfoUpdate &update,
+					std::function<void(bool ok, const std::string &message)> callback);
 
 private:
 	static std::vector<std::string> buildHeaders(const std::string &cookies);
+	static std::string buildVersionUrl();
+	static bool parseVersionResponse(long status, const std::string &data, VersionData &version,
+					 std::string &message);
+	static bool getLiveVersion(Http::HttpSession &session, const std::vector<std::string> &headers,
+				   VersionData &version, std::string &message);
+	static std::string urlEncode(const std::string &value);
+	static std::string mergeCookies(const std::string &cookies, const std::string &updates);
+	static std::string buildCorrespondPath(int64_t timestamp_ms);
+	static std::string buildRoomUpdateData(const Config &config, const RoomInfoUpdate &update);
+	static bool parseStopLiveResponse(long status, const std::string &data, std::string &message);
+	static bool parseRoomUpdateResponse(long status, const std::string &data, const RoomInfoUpdate &update,
+					    std::string &message);
 	static std::string appsign(const std::vector<std::pair<std::string, std::string>> &params,
 				   const std::string &app_key, const std::string &app_sec);
 };
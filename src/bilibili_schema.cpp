@@ -0,0 +1,455 @@
+#include "bilibili_schema.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Bili {
+namespace Schema {
+static const int max_depth = 200;
+
+static bool isNumberChar(char c)
+{
+	return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-';
+}
+
+std::string Reader::describe(char ch)
+{
+	char buf[12];
+	if (static_cast<uint8_t>(ch) >= 0x20 && static_cast<uint8_t>(ch) <= 0x7f) {
+		snprintf(buf, sizeof buf, "'%c' (%d)", ch, ch);
+	} else {
+		snprintf(buf, sizeof buf, "(%d)", ch);
+	}
+	return buf;
+}
+
+bool Reader::fail(std::string msg)
+{
+	if (!m_failed)
+		m_err = std::move(msg);
+	m_failed = true;
+	return false;
+}
+
+char Reader::peek()
+{
+	while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\r' || *m_pos == '\n' || *m_pos == '\t'))
+		++m_pos;
+	return m_pos < m_end ? *m_pos : 0;
+}
+
+char Reader::next()
+{
+	char ch = peek();
+	if (m_pos == m_end) {
+		fail("unexpected end of input");
+		return 0;
+	}
+	++m_pos;
+	return ch;
+}
+
+bool Reader::expect(char ch, const char *context)
+{
+	char got = next();
+	if (m_failed)
+		return false;
+	if (got != ch)
+		return fail(std::string("expected '") + ch + "'" + context + ", got " + describe(got));
+	return true;
+}
+
+bool Reader::skipLiteral(const char *literal)
+{
+	size_t len = strlen(literal);
+	size_t avail = std::min(len, size_t(m_end - m_pos));
+	if (avail < len || memcmp(m_pos, literal, len) != 0)
+		return fail(std::string("parse error: expected ") + literal + ", got " + std::string(m_pos, avail));
+	m_pos += len;
+	return true;
+}
+
+bool Reader::atEnd()
+{
+	peek();
+	if (m_failed)
+		return false;
+	if (m_pos != m_end)
+		return fail("unexpected trailing " + describe(*m_pos));
+	return true;
+}
+
+bool Reader::consumeNull()
+{
+	if (peek() != 'n')
+		return false;
+	return skipLiteral("null");
+}
+
+bool Reader::readBool(bool &out)
+{
+	char ch = peek();
+	if (ch == 't' && m_end - m_pos >= 4 && memcmp(m_pos, "true", 4) == 0) {
+		m_pos += 4;
+		out = true;
+		return true;
+	}
+	if (ch == 'f' && m_end - m_pos >= 5 && memcmp(m_pos, "false", 5) == 0) {
+		m_pos += 5;
+		out = false;
+		return true;
+	}
+	// 部分接口用 0/1 表示布尔值
+	if (ch == '-' || (ch >= '0' && ch <= '9')) {
+		int64_t value = 0;
+		if (!readInt(value))
+			return false;
+		out = value != 0;
+		return true;
+	}
+	return fail("expected boolean, got " + describe(ch));
+}
+
+bool Reader::readInt(int64_t &out)
+{
+	// 整数逐位精确解析，不经过 double；同时接受带引号的数字（如分区 id）
+	bool quoted = peek() == '"';
+	if (quoted)
+		++m_pos;
+
+	const char *start = m_pos;
+	bool negative = m_pos < m_end && *m_pos == '-';
+	if (negative)
+		++m_pos;
+	if (m_pos == m_end || *m_pos < '0' || *m_pos > '9')
+		return fail("invalid " + describe(m_pos < m_end ? *m_pos : 0) + " in number");
+
+	uint64_t value = 0;
+	const uint64_t limit = negative ? uint64_t(std::numeric_limits<int64_t>::max()) + 1
+					: uint64_t(std::numeric_limits<int64_t>::max());
+	while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9') {
+		uint64_t digit = uint64_t(*m_pos - '0');
+		if (value > (limit - digit) / 10)
+			return fail("integer out of range");
+		value = value * 10 + digit;
+		++m_pos;
+	}
+
+	if (m_pos < m_end && (*m_pos == '.' || *m_pos == 'e' || *m_pos == 'E')) {
+		// 非整数按 json11 int_value() 的语义截断
+		while (m_pos < m_end && isNumberChar(*m_pos))
+			++m_pos;
+		std::string text(start, m_pos);
+		out = static_cast<int64_t>(strtod(text.c_str(), nullptr));
+	} else {
+		out = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+	}
+
+	if (quoted) {
+		if (m_pos == m_end || *m_pos != '"')
+			return fail("expected '\"' after quoted number");
+		++m_pos;
+	}
+	return true;
+}
+
+static void encodeUtf8(long pt, std::string &out)
+{
+	if (pt < 0x80) {
+		out += static_cast<char>(pt);
+	} else if (pt < 0x800) {
+		out += static_cast<char>((pt >> 6) | 0xC0);
+		out += static_cast<char>((pt & 0x3F) | 0x80);
+	} else if (pt < 0x10000) {
+		out += static_cast<char>((pt >> 12) | 0xE0);
+		out += static_cast<char>(((pt >> 6) & 0x3F) | 0x80);
+		out += static_cast<char>((pt & 0x3F) | 0x80);
+	} else {
+		out += static_cast<char>((pt >> 18) | 0xF0);
+		out += static_cast<char>(((pt >> 12) & 0x3F) | 0x80);
+		out += static_cast<char>(((pt >> 6) & 0x3F) | 0x80);
+		out += static_cast<char>((pt & 0x3F) | 0x80);
+	}
+}
+
+static long parseHex4(const char *p)
+{
+	long value = 0;
+	for (int i = 0; i < 4; ++i) {
+		char c = p[i];
+		value <<= 4;
+		if (c >= '0' && c <= '9')
+			value |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			value |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			value |= c - 'A' + 10;
+		else
+			return -1;
+	}
+	return value;
+}
+
+// 读取字符串体（起始引号已消费）；out 为空时只做校验和跳过
+bool Reader::readRawString(std::string *out, bool &escaped)
+{
+	escaped = false;
+	while (true) {
+		const char *run = m_pos;
+		while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\' && static_cast<uint8_t>(*m_pos) >= 0x20)
+			++m_pos;
+		if (out)
+			out->append(run, m_pos);
+		if (m_pos == m_end)
+			return fail("unexpected end of input in string");
+
+		char ch = *m_pos++;
+		if (ch == '"')
+			return true;
+		if (ch != '\\')
+			return fail("unescaped " + describe(ch) + " in string");
+
+		escaped = true;
+		if (m_pos == m_end)
+			return fail("unexpected end of input in string");
+		ch = *m_pos++;
+		if (ch == 'u') {
+			long cp = m_end - m_pos >= 4 ? parseHex4(m_pos) : -1;
+			if (cp < 0)
+				return fail("bad \\u escape: " + std::string(m_pos, std::min<size_t>(4, size_t(m_end - m_pos))));
+			m_pos += 4;
+			if (cp >= 0xD800 && cp <= 0xDBFF && m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u') {
+				long low = parseHex4(m_pos + 2);
+				if (low >= 0xDC00 && low <= 0xDFFF) {
+					cp = (((cp - 0xD800) << 10) | (low - 0xDC00)) + 0x10000;
+					m_pos += 6;
+				}
+			}
+			if (out)
+				encodeUtf8(cp, *out);
+			continue;
+		}
+
+		const char *from = "bfnrt\"\\/";
+		const char *to = "\b\f\n\r\t\"\\/";
+		const char *hit = strchr(from, ch);
+		if (!ch || !hit)
+			return fail("invalid escape character " + describe(ch));
+		if (out)
+			*out += to[hit - from];
+	}
+}
+
+bool Reader::readString(std::string &out)
+{
+	char ch = next();
+	if (ch != '"')
+		return fail("expected string, got " + describe(ch));
+	out.clear();
+	bool escaped = false;
+	return readRawString(&out, escaped);
+}
+
+bool Reader::readKey(std::string_view &key)
+{
+	char ch = next();
+	if (ch != '"')
+		return fail("expected '\"' in object, got " + describe(ch));
+
+	// 绝大多数键不含转义，直接返回输入上的视图
+	const char *start = m_pos;
+	bool escaped = false;
+	if (!readRawString(nullptr, escaped))
+		return false;
+	if (!escaped) {
+		key = std::string_view(start, size_t(m_pos - start - 1));
+		return true;
+	}
+	m_pos = start;
+	m_key.clear();
+	if (!readRawString(&m_key, escaped))
+		return false;
+	key = m_key;
+	return true;
+}
+
+// 按 JSON 数字语法校验并跳过，错误信息与 json11 一致
+bool Reader::skipNumber()
+{
+	auto digit = [&]() { return m_pos < m_end && *m_pos >= '0' && *m_pos <= '9'; };
+	auto skipDigits = [&]() {
+		while (digit())
+			++m_pos;
+	};
+	if (*m_pos == '-')
+		++m_pos;
+	if (m_pos < m_end && *m_pos == '0') {
+		++m_pos;
+		if (digit())
+			return fail("leading 0s not permitted in numbers");
+	} else if (digit()) {
+		skipDigits();
+	} else {
+		return fail("invalid " + describe(m_pos < m_end ? *m_pos : 0) + " in number");
+	}
+	if (m_pos < m_end && *m_pos == '.') {
+		++m_pos;
+		if (!digit())
+			return fail("at least one digit required in fractional part");
+		skipDigits();
+	}
+	if (m_pos < m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+		++m_pos;
+		if (m_pos < m_end && (*m_pos == '+' || *m_pos == '-'))
+			++m_pos;
+		if (!digit())
+			return fail("at least one digit required in exponent");
+		skipDigits();
+	}
+	return true;
+}
+
+bool Reader::skipValue(int depth)
+{
+	if (depth > max_depth)
+		return fail("exceeded maximum nesting depth");
+
+	char ch = peek();
+	if (ch == '{')
+		return readObject([&](std::string_view) { return skipValue(depth + 1); });
+	if (ch == '[')
+		return readArray([&]() { return skipValue(depth + 1); });
+	if (ch == '"') {
+		++m_pos;
+		bool escaped = false;
+		return readRawString(nullptr, escaped);
+	}
+	if (ch == 't')
+		return skipLiteral("true");
+	if (ch == 'f')
+		return skipLiteral("false");
+	if (ch == 'n')
+		return skipLiteral("null");
+	if (ch == '-' || (ch >= '0' && ch <= '9'))
+		return skipNumber();
+	if (m_pos == m_end)
+		return fail("unexpected end of input");
+	return fail("expected value, got " + describe(ch));
+}
+
+namespace {
+struct PathSegment {
+	std::string_view key;
+	size_t index; // 非数字段为 npos，只匹配对象键
+};
+
+class PathWalker {
+public:
+	PathWalker(Reader &r, std::vector<std::vector<PathSegment>> paths, std::vector<std::string_view> &values)
+		: m_r(r), m_paths(std::move(paths)), m_values(values)
+	{
+	}
+
+	// active 中的路径前 depth 段都已匹配到当前值
+	bool walk(const std::vector<size_t> &active, size_t depth)
+	{
+		if (depth > size_t(max_depth))
+			return m_r.fail("exceeded maximum nesting depth");
+
+		std::vector<size_t> deeper;
+		for (size_t i : active) {
+			if (m_paths[i].size() > depth)
+				deeper.push_back(i);
+		}
+
+		const char *begin = m_r.valueBegin();
+		bool ok;
+		if (deeper.empty()) {
+			ok = m_r.skipValue(int(depth));
+		} else if (m_r.nextIs('{')) {
+			ok = m_r.readObject([&](std::string_view key) {
+				return descend(deeper, depth, [&](const PathSegment &seg) { return seg.key == key; });
+			});
+		} else if (m_r.nextIs('[')) {
+			size_t index = 0;
+			ok = m_r.readArray([&]() {
+				size_t current = index++;
+				return descend(deeper, depth, [&](const PathSegment &seg) { return seg.index == current; });
+			});
+		} else {
+			// 类型不符，更深的路径视为不存在
+			ok = m_r.skipValue(int(depth));
+		}
+		if (!ok)
+			return false;
+
+		std::string_view raw(begin, size_t(m_r.position() - begin));
+		for (size_t i : active) {
+			if (m_paths[i].size() == depth)
+				m_values[i] = raw;
+		}
+		return true;
+	}
+
+private:
+	template<typename Match> bool descend(const std::vector<size_t> &deeper, size_t depth, Match &&match)
+	{
+		std::vector<size_t> next;
+		for (size_t i : deeper) {
+			if (match(m_paths[i][depth])) {
+				// 与 json11 一致，重复的键以后出现的为准：先清掉前一次的结果
+				m_values[i] = std::string_view();
+				next.push_back(i);
+			}
+		}
+		if (next.empty())
+			return m_r.skipValue(int(depth + 1));
+		return walk(next, depth + 1);
+	}
+
+	Reader &m_r;
+	std::vector<std::vector<PathSegment>> m_paths;
+	std::vector<std::string_view> &m_values;
+};
+} // namespace
+
+bool extract(std::string_view in, std::initializer_list<std::string_view> paths,
+	     std::vector<std::string_view> &values, std::string &err)
+{
+	std::vector<std::vector<PathSegment>> split;
+	std::vector<size_t> all;
+	for (std::string_view path : paths) {
+		std::vector<PathSegment> segments;
+		while (!path.empty()) {
+			size_t dot = path.find('.');
+			std::string_view key = path.substr(0, dot);
+			size_t index = key.empty() ? std::string_view::npos : 0;
+			for (char c : key) {
+				if (c < '0' || c > '9' || index > (std::numeric_limits<size_t>::max() - 9) / 10) {
+					index = std::string_view::npos;
+					break;
+				}
+				index = index * 10 + size_t(c - '0');
+			}
+			segments.push_back({key, index});
+			path = dot == std::string_view::npos ? std::string_view() : path.substr(dot + 1);
+		}
+		all.push_back(split.size());
+		split.push_back(std::move(segments));
+	}
+	values.assign(split.size(), std::string_view());
+
+	Reader r(in.data(), in.data() + in.size());
+	PathWalker walker(r, std::move(split), values);
+	if (!walker.walk(all, 0) || !r.atEnd()) {
+		err = r.failed() ? r.error() : "unexpected trailing data";
+		values.assign(values.size(), std::string_view());
+		return false;
+	}
+	return true;
+}
+
+} // namespace Schema
+} // namespace Bili
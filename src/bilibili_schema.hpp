@@ -0,0 +1,373 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Bili {
+
+// 各接口响应解码后的结构体，字段名与接口 JSON 字段一一对应（见下方 Schema 表）
+struct NavData {
+	bool is_login = false;
+	int64_t mid = 0;
+};
+
+struct RoomIdData {
+	int64_t room_id = 0;
+};
+
+struct QrPollData {
+	int64_t code = -1;
+	std::string message;
+	std::string url;
+	std::string refresh_token;
+};
+
+// Web 端 Cookie 刷新：cookie/info 告知是否需要刷新，cookie/refresh 返回新的 refresh_token
+struct CookieInfoData {
+	bool refresh = false;
+	int64_t timestamp = 0;
+};
+
+struct CookieRefreshData {
+	int64_t status = 0;
+	std::string message;
+	std::string refresh_token;
+};
+
+struct RoomInfoData {
+	int64_t room_id = 0;
+	int64_t live_status = 0;
+};
+
+struct DanmuHost {
+	std::string host;
+	int64_t port = 0;
+	int64_t wss_port = 0;
+	int64_t ws_port = 0;
+};
+
+struct DanmuInfoData {
+	std::string token;
+	std::vector<DanmuHost> host_list;
+};
+
+struct VersionData {
+	int64_t build = 0;
+	std::string curr_version;
+};
+
+struct RtmpInfo {
+	std::string addr;
+	std::string code;
+};
+
+// 开播返回的备选推流协议 / 节点
+struct PushProtocol {
+	std::string protocol;
+	std::string addr;
+	std::string code;
+	std::string provider;
+};
+
+struct StartLiveData {
+	RtmpInfo rtmp;
+	std::vector<PushProtocol> protocols;
+	std::string qr;
+};
+
+struct StopLiveData {
+	int64_t change = 0;
+	std::string status;
+};
+
+struct Area {
+	int64_t id = 0;
+	std::string name;
+};
+
+struct Partition {
+	int64_t id = 0;
+	std::string name;
+	std::vector<Area> list;
+};
+
+// 不关心内容的字段（如 Room/update 的 data），整体跳过
+struct Ignored {};
+
+template<typename T> struct ApiResponse {
+	int64_t code = 0;
+	std::string message;
+	T data;
+};
+
+namespace Schema {
+
+// 单遍拉取式 JSON 读取器：直接在输入上前进，不构建 DOM
+class Reader {
+public:
+	Reader(const char *begin, const char *end) : m_pos(begin), m_end(end) {}
+
+	bool failed() const { return m_failed; }
+	const std::string &error() const { return m_err; }
+	// 下一个值的起点（跳过空白）与当前读取位置，用于截取值在输入上的原始文本
+	const char *valueBegin()
+	{
+		peek();
+		return m_pos;
+	}
+	const char *position() const { return m_pos; }
+	// 下一个值是否以 ch 开头（跳过空白）
+	bool nextIs(char ch) { return peek() == ch; }
+	bool fail(std::string msg);
+
+	bool atEnd();
+	bool consumeNull();
+	bool readBool(bool &out);
+	bool readInt(int64_t &out);
+	bool readString(std::string &out);
+	bool skipValue(int depth = 0);
+
+	// onKey(std::string_view key) 必须读取或跳过对应的值
+	template<typename F> bool readObject(F &&onKey)
+	{
+		if (!expect('{'))
+			return false;
+		if (peek() == '}') {
+			++m_pos;
+			return true;
+		}
+		while (true) {
+			std::string_view key;
+			if (!readKey(key) || !expect(':', " in object"))
+				return false;
+			if (!onKey(key) || m_failed)
+				return false;
+			char ch = next();
+			if (ch == '}')
+				return true;
+			if (ch != ',')
+				return fail("expected ',' in object, got " + describe(ch));
+		}
+	}
+
+	template<typename F> bool readArray(F &&onItem)
+	{
+		if (!expect('['))
+			return false;
+		if (peek() == ']') {
+			++m_pos;
+			return true;
+		}
+		while (true) {
+			if (!onItem() || m_failed)
+				return false;
+			char ch = next();
+			if (ch == ']')
+				return true;
+			if (ch != ',')
+				return fail("expected ',' in list, got " + describe(ch));
+		}
+	}
+
+private:
+	char peek();
+	char next();
+	bool expect(char ch, const char *context = "");
+	bool skipLiteral(const char *literal);
+	bool readKey(std::string_view &key);
+	bool readRawString(std::string *out, bool &escaped);
+	bool skipNumber();
+	static std::string describe(char ch);
+
+	const char *m_pos;
+	const char *m_end;
+	std::string m_key;
+	std::string m_err;
+	bool m_failed = false;
+};
+
+template<typename T> struct Field {
+	const char *key;
+	bool (*decode)(Reader &, T &);
+};
+
+// 每个结构体特化一个 Schema<T>，提供编译期字段表 fields
+template<typename T> struct Schema;
+
+template<typename C, typename M> C classOf(M C::*);
+template<auto Member> using ClassOf = decltype(classOf(Member));
+
+inline bool decodeValue(Reader &r, bool &out)
+{
+	return r.consumeNull() || r.readBool(out);
+}
+
+inline bool decodeValue(Reader &r, int64_t &out)
+{
+	return r.consumeNull() || r.readInt(out);
+}
+
+inline bool decodeValue(Reader &r, std::string &out)
+{
+	return r.consumeNull() || r.readString(out);
+}
+
+inline bool decodeValue(Reader &r, Ignored &)
+{
+	return r.skipValue();
+}
+
+template<typename T> bool decodeValue(Reader &r, std::vector<T> &out);
+
+template<typename T> bool decodeValue(Reader &r, T &out)
+{
+	// 出错时接口常返回 "data":[] 等非对象值，与 json11 一致按字段缺失处理
+	if (!r.nextIs('{'))
+		return r.skipValue();
+	return r.readObject([&](std::string_view key) {
+		for (const auto &field : Schema<T>::fields) {
+			if (key == field.key)
+				return field.decode(r, out);
+		}
+		return r.skipValue();
+	});
+}
+
+template<typename T> bool decodeValue(Reader &r, std::vector<T> &out)
+{
+	if (!r.nextIs('['))
+		return r.skipValue();
+	return r.readArray([&]() {
+		out.emplace_back();
+		return decodeValue(r, out.back());
+	});
+}
+
+template<auto Member> bool decodeMember(Reader &r, ClassOf<Member> &obj)
+{
+	return decodeValue(r, obj.*Member);
+}
+
+template<> struct Schema<NavData> {
+	static constexpr Field<NavData> fields[] = {{"isLogin", &decodeMember<&NavData::is_login>},
+						    {"mid", &decodeMember<&NavData::mid>}};
+};
+
+template<> struct Schema<RoomIdData> {
+	static constexpr Field<RoomIdData> fields[] = {{"room_id", &decodeMember<&RoomIdData::room_id>}};
+};
+
+template<> struct Schema<QrPollData> {
+	static constexpr Field<QrPollData> fields[] = {{"code", &decodeMember<&QrPollData::code>},
+						       {"message", &decodeMember<&QrPollData::message>},
+						       {"url", &decodeMember<&QrPollData::url>},
+						       {"refresh_token", &decodeMember<&QrPollData::refresh_token>}};
+};
+
+template<> struct Schema<CookieInfoData> {
+	static constexpr Field<CookieInfoData> fields[] = {{"refresh", &decodeMember<&CookieInfoData::refresh>},
+							   {"timestamp", &decodeMember<&CookieInfoData::timestamp>}};
+};
+
+template<> struct Schema<CookieRefreshData> {
+	static constexpr Field<CookieRefreshData> fields[] = {
+		{"status", &decodeMember<&CookieRefreshData::status>},
+		{"message", &decodeMember<&CookieRefreshData::message>},
+		{"refresh_token", &decodeMember<&CookieRefreshData::refresh_token>}};
+};
+
+template<> struct Schema<RoomInfoData> {
+	static constexpr Field<RoomInfoData> fields[] = {{"room_id", &decodeMember<&RoomInfoData::room_id>},
+							 {"live_status", &decodeMember<&RoomInfoData::live_status>}};
+};
+
+template<> struct Schema<DanmuHost> {
+	static constexpr Field<DanmuHost> fields[] = {{"host", &decodeMember<&DanmuHost::host>},
+						      {"port", &decodeMember<&DanmuHost::port>},
+						      {"wss_port", &decodeMember<&DanmuHost::wss_port>},
+						      {"ws_port", &decodeMember<&DanmuHost::ws_port>}};
+};
+
+template<> struct Schema<DanmuInfoData> {
+	static constexpr Field<DanmuInfoData> fields[] = {{"token", &decodeMember<&DanmuInfoData::token>},
+							  {"host_list", &decodeMember<&DanmuInfoData::host_list>}};
+};
+
+template<> struct Schema<VersionData> {
+	static constexpr Field<VersionData> fields[] = {{"build", &decodeMember<&VersionData::build>},
+							{"curr_version", &decodeMember<&VersionData::curr_version>}};
+};
+
+template<> struct Schema<RtmpInfo> {
+	static constexpr Field<RtmpInfo> fields[] = {{"addr", &decodeMember<&RtmpInfo::addr>},
+						     {"code", &decodeMember<&RtmpInfo::code>}};
+};
+
+template<> struct Schema<PushProtocol> {
+	static constexpr Field<PushProtocol> fields[] = {{"protocol", &decodeMember<&PushProtocol::protocol>},
+							 {"addr", &decodeMember<&PushProtocol::addr>},
+							 {"code", &decodeMember<&PushProtocol::code>},
+							 {"provider", &decodeMember<&PushProtocol::provider>}};
+};
+
+template<> struct Schema<StartLiveData> {
+	static constexpr Field<StartLiveData> fields[] = {{"rtmp", &decodeMember<&StartLiveData::rtmp>},
+							  {"protocols", &decodeMember<&StartLiveData::protocols>},
+							  {"qr", &decodeMember<&StartLiveData::qr>}};
+};
+
+template<> struct Schema<StopLiveData> {
+	static constexpr Field<StopLiveData> fields[] = {{"change", &decodeMember<&StopLiveData::change>},
+							 {"status", &decodeMember<&StopLiveData::status>}};
+};
+
+template<> struct Schema<Area> {
+	static constexpr Field<Area> fields[] = {{"id", &decodeMember<&Area::id>}, {"name", &decodeMember<&Area::name>}};
+};
+
+template<> struct Schema<Partition> {
+	static constexpr Field<Partition> fields[] = {{"id", &decodeMember<&Partition::id>},
+						      {"name", &decodeMember<&Partition::name>},
+						      {"list", &decodeMember<&Partition::list>}};
+};
+
+template<typename T> struct Schema<ApiResponse<T>> {
+	static constexpr Field<ApiResponse<T>> fields[] = {{"code", &decodeMember<&ApiResponse<T>::code>},
+							   {"message", &decodeMember<&ApiResponse<T>::message>},
+							   {"data", &decodeMember<&ApiResponse<T>::data>}};
+};
+
+// 解码整个响应体；失败时 err 为解析错误信息，格式与 json11 一致
+template<typename T> bool decode(const std::string &in, T &out, std::string &err)
+{
+	Reader r(in.data(), in.data() + in.size());
+	if (!decodeValue(r, out) || !r.atEnd()) {
+		err = r.failed() ? r.error() : "unexpected trailing data";
+		return false;
+	}
+	return true;
+}
+
+// 按路径就地提取：单遍扫描输入，只定位 paths 指向的值，不构建 DOM。
+// 路径以 '.' 分隔，数字段为数组下标（如 "data.url"、"data.list.0.id"）；
+// 其余子树只做结构校验后跳过，格式错误时 err 与 decode() 一致。
+// values[i] 为 paths[i] 对应值在 in 上的原始 JSON 文本，未找到时为空；重复的键以最后一个为准。
+// values 指向 in 的内存，调用方须保证 in 比 values 活得久，因此不接受临时 std::string
+bool extract(std::string_view in, std::initializer_list<std::string_view> paths,
+	     std::vector<std::string_view> &values, std::string &err);
+bool extract(std::string &&in, std::initializer_list<std::string_view> paths,
+	     std::vector<std::string_view> &values, std::string &err) = delete;
+
+// 解码 extract() 取得的原始文本；空视图（路径不存在）保持 out 不变并返回 true
+template<typename T> bool decodeRaw(std::string_view raw, T &out)
+{
+	if (raw.empty())
+		return true;
+	Reader r(raw.data(), raw.data() + raw.size());
+	return decodeValue(r, out) && r.atEnd();
+}
+
+} // namespace Schema
+} // namespace Bili
@@ -0,0 +1,104 @@
+#include "core/account_refresher.hpp"
+#include <obs-module.h>
+#include <QPointer>
+#include <chrono>
+#include "bilibili_api.hpp"
+#include "http_client.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+struct AccountRefresher::Slot {
+	Http::HttpSession session;
+	std::string etag;
+	int live_status = -1;
+};
+
+AccountRefresher::AccountRefresher(QObject *parent) : QObject(parent) {}
+
+AccountRefresher::~AccountRefresher()
+{
+	m_stop = true;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void AccountRefresher::refreshOne(Slot &slot, AccountStatus &status)
+{
+	if (status.cookies.empty()) {
+		status.message = "未登录";
+		return;
+	}
+	status.login = Bili::BiliApi::checkLoginStatus(slot.session, status.cookies, status.message, status.mid);
+	if (!status.login)
+		return;
+	if (!Bili::BiliApi::getRoomIdAndCsrf(slot.session, status.cookies, status.room_id, status.csrf_token,
+					     status.message))
+		return;
+	// 304 时 live_status 不变，沿用上一轮的结果
+	if (Bili::BiliApi::getLiveStatus(slot.session, status.room_id, slot.live_status, slot.etag, status.message))
+		status.live_status = slot.live_status;
+}
+
+void AccountRefresher::refresh(const std::vector<std::string> &cookies)
+{
+	if (m_busy)
+		return;
+	if (m_thread.joinable())
+		m_thread.join();
+	m_busy = true;
+
+	// 每个账号的连接跨轮次保留；已删除或重新登录的账号释放旧连接
+	std::map<std::string, std::unique_ptr<Slot>> slots;
+	std::vector<Slot *> assigned;
+	for (const auto &cookie : cookies) {
+		auto it = m_slots.find(cookie);
+		if (it != m_slots.end()) {
+			slots[cookie] = std::move(it->second);
+		} else if (!slots.count(cookie)) {
+			slots[cookie] = std::make_unique<Slot>();
+			slots[cookie]->session.setAbortFlag(&m_stop);
+		}
+		assigned.push_back(slots[cookie].get());
+	}
+	m_slots = std::move(slots);
+
+	m_thread = std::thread([this, cookies, assigned]() {
+		auto started = std::chrono::steady_clock::now();
+		std::vector<AccountStatus> results(cookies.size());
+		std::vector<size_t> first(cookies.size());
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < cookies.size(); ++i) {
+			results[i].cookies = cookies[i];
+			// 同一账号出现多次时共用一个 session（只能由一个线程使用），结果复制过去
+			first[i] = i;
+			for (size_t j = 0; j < i && first[i] == i; ++j) {
+				if (assigned[j] == assigned[i])
+					first[i] = j;
+			}
+			if (first[i] == i)
+				workers.emplace_back(refreshOne, std::ref(*assigned[i]), std::ref(results[i]));
+		}
+		for (auto &worker : workers)
+			worker.join();
+		for (size_t i = 0; i < results.size(); ++i)
+			results[i] = results[first[i]];
+		if (m_stop)
+			return;
+		obs_log(LOG_INFO, "刷新 %zu 个账号耗时 %lld ms", cookies.size(),
+			(long long)std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now() - started)
+				.count());
+
+		QPointer<AccountRefresher> self(this);
+		QMetaObject::invokeMethod(
+			this,
+			[self, results = std::move(results)]() {
+				if (!self)
+					return;
+				self->m_busy = false;
+				emit self->refreshed(results);
+			},
+			Qt::QueuedConnection);
+	});
+}
+} // namespace Core
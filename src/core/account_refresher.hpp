@@ -0,0 +1,50 @@
+#pragma once
+#include <QObject>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Http {
+class HttpSession;
+}
+
+namespace Core {
+struct AccountStatus {
+	std::string cookies; // 刷新期间账号可能被删除或重新登录，回到 UI 线程后按 cookies 对应
+	bool login = false;
+	std::string mid;
+	std::string room_id;
+	std::string csrf_token;
+	int live_status = -1;
+	std::string message;
+};
+
+// 并发刷新多个账号的登录状态、房间号和开播状态：每个账号一个线程，并各自持有一个 HttpSession，
+// 连续几轮刷新复用同一条连接，整轮耗时约等于最慢的一个账号
+class AccountRefresher : public QObject {
+	Q_OBJECT
+public:
+	explicit AccountRefresher(QObject *parent = nullptr);
+	~AccountRefresher();
+
+	// 上一轮尚未结束时忽略本次调用
+	void refresh(const std::vector<std::string> &cookies);
+	bool isBusy() const { return m_busy; }
+
+signals:
+	// 在 UI 线程上发出，顺序与 refresh 传入的 cookies 一致
+	void refreshed(const std::vector<Core::AccountStatus> &results);
+
+private:
+	struct Slot;
+	static void refreshOne(Slot &slot, AccountStatus &status);
+
+	std::map<std::string, std::unique_ptr<Slot>> m_slots;
+	std::thread m_thread;
+	std::atomic<bool> m_stop{false};
+	bool m_busy = false;
+};
+} // namespace Core
@@ -0,0 +1,100 @@
+#include "core/auto_stop_live.hpp"
+#include <obs-module.h>
+#include <QMetaObject>
+#include <QPointer>
+#include "bilibili_api.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const long kStopTimeoutMs = 10000;
+// 退出时只给很短的超时，HTTP 工作线程在插件卸载时会被等待
+static const long kExitStopTimeoutMs = 2000;
+
+AutoStopLive::AutoStopLive(ConfigManager &config, StreamLauncher *launcher, QObject *parent)
+	: QObject(parent),
+	  m_config(config),
+	  m_launcher(launcher)
+{
+	m_grace.setSingleShot(true);
+	connect(&m_grace, &QTimer::timeout, this, [this]() {
+		// 宽限期内 OBS 自己重连成功或用户重新开始推流，则不下播
+		if (obs_frontend_streaming_active() || !m_config.config().streaming)
+			return;
+		obs_log(LOG_INFO, "推流已停止 %d 秒，自动关闭直播间", m_config.config().auto_stop_grace_s);
+		stopLive(kStopTimeoutMs);
+	});
+	obs_frontend_add_event_callback(&AutoStopLive::onFrontendEvent, this);
+}
+
+AutoStopLive::~AutoStopLive()
+{
+	obs_frontend_remove_event_callback(&AutoStopLive::onFrontendEvent, this);
+}
+
+void AutoStopLive::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	auto *self = static_cast<AutoStopLive *>(data);
+	switch (event) {
+	case OBS_FRONTEND_EVENT_STREAMING_STARTED:
+		self->m_grace.stop();
+		break;
+	case OBS_FRONTEND_EVENT_STREAMING_STOPPED:
+		self->onStreamingStopped();
+		break;
+	case OBS_FRONTEND_EVENT_EXIT:
+		self->onExit();
+		break;
+	default:
+		break;
+	}
+}
+
+bool AutoStopLive::ownsLiveRoom() const
+{
+	const auto &cfg = m_config.config();
+	if (!cfg.streaming || cfg.auto_stop_grace_s <= 0)
+		return false;
+	// cfg.streaming 也会因为直播间在其他设备上开启而为 true；只有本插件开播的输出才由这里下播
+	return m_launcher->servesRoom({cfg.rtmp_addr, cfg.rtmp_code});
+}
+
+void AutoStopLive::onStreamingStopped()
+{
+	const auto &cfg = m_config.config();
+	if (m_launcher->isSwitching() || !ownsLiveRoom())
+		return;
+	obs_log(LOG_INFO, "推流输出已停止，%d 秒内未恢复将自动下播", cfg.auto_stop_grace_s);
+	m_grace.start(cfg.auto_stop_grace_s * 1000);
+}
+
+void AutoStopLive::onExit()
+{
+	// 退出 OBS 时推流必然结束，不再等宽限期；请求异步发出，不阻塞退出流程
+	m_grace.stop();
+	if (ownsLiveRoom())
+		stopLive(kExitStopTimeoutMs);
+}
+
+void AutoStopLive::stopLive(long timeoutMs)
+{
+	if (m_inFlight)
+		return;
+	m_inFlight = true;
+
+	QPointer<AutoStopLive> self(this);
+	Bili::BiliApi::stopLiveAsync(
+		m_config.config(),
+		[self](bool ok, const std::string &message) {
+			QMetaObject::invokeMethod(
+				self,
+				[self, ok, message]() {
+					if (!self)
+						return;
+					self->m_inFlight = false;
+					emit self->stopped(ok, QString::fromStdString(message));
+				},
+				Qt::QueuedConnection);
+		},
+		timeoutMs);
+}
+} // namespace Core
@@ -0,0 +1,34 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <obs-frontend-api.h>
+#include "core/config_manager.hpp"
+#include "core/stream_launcher.hpp"
+
+namespace Core {
+// OBS 推流输出停止后，经过宽限期仍未恢复推流则自动调用 stopLive 关闭直播间；
+// 宽限期内的短暂重连和节点切换不会触发下播
+class AutoStopLive : public QObject {
+	Q_OBJECT
+public:
+	AutoStopLive(ConfigManager &config, StreamLauncher *launcher, QObject *parent = nullptr);
+	~AutoStopLive();
+
+signals:
+	void stopped(bool ok, const QString &message);
+
+private:
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	// 开启了自动下播，且直播间正由本插件启动的推流输出使用
+	bool ownsLiveRoom() const;
+	void onStreamingStopped();
+	void onExit();
+	void stopLive(long timeoutMs);
+
+	ConfigManager &m_config;
+	StreamLauncher *m_launcher;
+	QTimer m_grace;
+	bool m_inFlight = false;
+};
+} // namespace Core
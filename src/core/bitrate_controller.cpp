@@ -0,0 +1,227 @@
+#include "core/bitrate_controller.hpp"
+#include <obs-module.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "core/event_log.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static int64_t steadyMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+BitratePolicy::BitratePolicy(BitrateParams params) : m_params(params) {}
+
+void BitratePolicy::reset(int currentKbps, int capKbps)
+{
+	m_current = currentKbps;
+	m_cap = capKbps;
+	m_bad = 0;
+	m_good = 0;
+	m_lastChangeMs = 0;
+	m_reason = "";
+}
+
+int BitratePolicy::step(const OutputHealth &health, int64_t nowMs)
+{
+	m_reason = "";
+	if (!health.active || m_current <= 0)
+		return m_current;
+
+	// 差 / 好使用不同阈值并要求连续多次，避免在临界点来回抖动
+	bool bad = health.congestion >= m_params.congestedAbove || health.drop_rate >= m_params.dropRateAbove;
+	bool good = health.congestion < m_params.clearBelow && health.drop_rate <= 0.0;
+	m_bad = bad ? m_bad + 1 : 0;
+	m_good = good ? m_good + 1 : 0;
+
+	if (m_current > m_cap) {
+		m_reason = "cap";
+		m_current = m_cap;
+		m_lastChangeMs = nowMs;
+		return m_current;
+	}
+	if (nowMs - m_lastChangeMs < m_params.cooldownMs)
+		return m_current;
+
+	if (m_bad >= m_params.badSamples && m_current > m_params.minBitrate) {
+		m_reason = "down";
+		m_current = std::max(m_params.minBitrate, int(m_current * m_params.stepDown));
+	} else if (m_good >= m_params.goodSamples && m_current < m_cap) {
+		m_reason = "up";
+		m_current = std::min(m_cap, m_current + std::max(m_params.minStepUp, int(m_cap * m_params.stepUpRatio)));
+	} else {
+		return m_current;
+	}
+	m_bad = 0;
+	m_good = 0;
+	m_lastChangeMs = nowMs;
+	return m_current;
+}
+
+BitrateController::BitrateController(OutputHealthMonitor *health, QObject *parent) : QObject(parent)
+{
+	connect(health, &OutputHealthMonitor::healthUpdated, this, &BitrateController::onHealth);
+	obs_frontend_add_event_callback(&BitrateController::onFrontendEvent, this);
+}
+
+BitrateController::~BitrateController()
+{
+	obs_frontend_remove_event_callback(&BitrateController::onFrontendEvent, this);
+	detach();
+}
+
+void BitrateController::setEnabled(bool enabled)
+{
+	if (m_enabled == enabled)
+		return;
+	m_enabled = enabled;
+	if (!enabled && !m_uplinkLimit)
+		detach();
+	else if (enabled && !m_encoder && obs_frontend_streaming_active())
+		attach();
+}
+
+void BitrateController::setArea(int partId, int areaId)
+{
+	m_partId = partId;
+	m_areaId = areaId;
+}
+
+void BitrateController::setUplinkLimit(int kbps)
+{
+	m_uplinkLimit = kbps;
+}
+
+static bool readCap(const char *file, int partId, int areaId, int &cap)
+{
+	if (!file)
+		return false;
+	obs_data_t *data = obs_data_create_from_json_file(file);
+	if (!data)
+		return false;
+
+	cap = static_cast<int>(obs_data_get_int(data, "default"));
+	const std::pair<const char *, int> levels[] = {{"parents", partId}, {"areas", areaId}};
+	for (const auto &level : levels) {
+		obs_data_t *table = obs_data_get_obj(data, level.first);
+		std::string key = std::to_string(level.second);
+		if (table && obs_data_has_user_value(table, key.c_str()))
+			cap = static_cast<int>(obs_data_get_int(table, key.c_str()));
+		obs_data_release(table);
+	}
+	obs_data_release(data);
+	return true;
+}
+
+int BitrateController::capForArea(int partId, int areaId)
+{
+	int cap = 0;
+	char *userFile = obs_module_config_path("bitrate_caps.json");
+	bool found = readCap(userFile, partId, areaId, cap);
+	bfree(userFile);
+	if (!found) {
+		char *defaultFile = obs_module_file("bitrate_caps.json");
+		readCap(defaultFile, partId, areaId, cap);
+		bfree(defaultFile);
+	}
+	return cap;
+}
+
+void BitrateController::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	auto *self = static_cast<BitrateController *>(data);
+	if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED && (self->m_enabled || self->m_uplinkLimit))
+		self->attach();
+	else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED)
+		self->detach();
+}
+
+void BitrateController::attach()
+{
+	detach();
+	obs_output_t *output = obs_frontend_get_streaming_output();
+	obs_encoder_t *encoder = output ? obs_encoder_get_ref(obs_output_get_video_encoder(output)) : nullptr;
+	obs_output_release(output);
+	if (!encoder)
+		return;
+
+	obs_data_t *settings = obs_encoder_get_settings(encoder);
+	int base = static_cast<int>(obs_data_get_int(settings, "bitrate"));
+	obs_data_release(settings);
+	if (base <= 0) {
+		// CQP / CRF 等不按码率控制的模式
+		obs_log(LOG_INFO, "自适应码率: 编码器未使用固定码率，跳过");
+		obs_encoder_release(encoder);
+		return;
+	}
+
+	int cap = capForArea(m_partId, m_areaId);
+	if (m_uplinkLimit > 0)
+		cap = cap > 0 ? std::min(cap, m_uplinkLimit) : m_uplinkLimit;
+	m_encoder = encoder;
+	m_baseBitrate = base;
+	int limit = cap > 0 ? std::min(base, cap) : base;
+	m_policy.reset(limit, limit);
+	if (limit != base)
+		applyBitrate(limit);
+	obs_log(LOG_INFO, "自适应码率: 设置 %d kbps，初始 %d kbps，上限 %d kbps（上行测速 %d kbps）", base, limit, cap,
+		m_uplinkLimit);
+
+	std::string path = EventLogWriter::sessionPath("bitrate", ".csv");
+	m_trace = path.empty() ? nullptr : EventLogWriter::openFile(path, "w");
+	if (m_trace)
+		fputs("t_ms,active,congestion,drop_rate,bitrate_kbps,target_kbps,action\n", m_trace);
+	m_traceStartMs = steadyMs();
+}
+
+void BitrateController::detach()
+{
+	if (m_trace) {
+		fclose(m_trace);
+		m_trace = nullptr;
+	}
+	if (!m_encoder)
+		return;
+	// 恢复用户设置的码率，避免影响下一次推流
+	if (m_policy.current() != m_baseBitrate)
+		applyBitrate(m_baseBitrate);
+	obs_encoder_release(m_encoder);
+	m_encoder = nullptr;
+}
+
+void BitrateController::applyBitrate(int kbps)
+{
+	obs_data_t *settings = obs_encoder_get_settings(m_encoder);
+	obs_data_set_int(settings, "bitrate", kbps);
+	obs_encoder_update(m_encoder, settings);
+	obs_data_release(settings);
+}
+
+void BitrateController::trace(const OutputHealth &health, int target, const char *action)
+{
+	if (!m_trace)
+		return;
+	fprintf(m_trace, "%lld,%d,%.3f,%.3f,%.0f,%d,%s\n", (long long)(steadyMs() - m_traceStartMs),
+		health.active ? 1 : 0, health.congestion, health.drop_rate, health.bitrate_kbps, target, action);
+	fflush(m_trace);
+}
+
+void BitrateController::onHealth(const OutputHealth &health)
+{
+	if (!m_encoder || !m_enabled)
+		return;
+	int previous = m_policy.current();
+	int target = m_policy.step(health, steadyMs());
+	trace(health, target, m_policy.lastReason());
+	if (target == previous)
+		return;
+
+	applyBitrate(target);
+	obs_log(LOG_INFO, "码率调整(%s): %d -> %d kbps，拥塞 %.2f，丢帧 %.2f%%，实际码率 %.0f kbps",
+		m_policy.lastReason(), previous, target, health.congestion, health.drop_rate, health.bitrate_kbps);
+}
+} // namespace Core
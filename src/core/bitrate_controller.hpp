@@ -0,0 +1,77 @@
+#pragma once
+#include <QObject>
+#include <cstdint>
+#include <cstdio>
+#include <obs-frontend-api.h>
+#include <string>
+#include "core/output_health.hpp"
+
+namespace Core {
+struct BitrateParams {
+	double congestedAbove = 0.5; // 拥塞或丢帧超过阈值记为一次“差”
+	double dropRateAbove = 1.0;  // %
+	double clearBelow = 0.1;     // 拥塞低于该值且无丢帧记为一次“好”
+	int badSamples = 3;          // 连续差多少次下调
+	int goodSamples = 20;        // 连续好多少次上调
+	double stepDown = 0.8;       // 下调为当前的 80%
+	double stepUpRatio = 0.05;   // 每次上调上限的 5%
+	int minStepUp = 100;         // kbps
+	int64_t cooldownMs = 5000;   // 两次调整的最小间隔
+	int minBitrate = 500;        // kbps
+};
+
+// 码率决策，不依赖 OBS，可用记录下来的 trace 离线回放调参
+class BitratePolicy {
+public:
+	explicit BitratePolicy(BitrateParams params = BitrateParams());
+
+	void reset(int currentKbps, int capKbps);
+	// 返回新的目标码率；不需要调整时返回当前值
+	int step(const OutputHealth &health, int64_t nowMs);
+	int current() const { return m_current; }
+	const char *lastReason() const { return m_reason; }
+
+private:
+	BitrateParams m_params;
+	int m_current = 0;
+	int m_cap = 0;
+	int m_bad = 0;
+	int m_good = 0;
+	int64_t m_lastChangeMs = 0;
+	const char *m_reason = "";
+};
+
+// 根据推流输出的拥塞和丢帧自适应调整编码器码率，不超过当前分区的码率上限；
+// 每次采样和调整都写入 sessions/bitrate-*.csv，便于离线回放
+class BitrateController : public QObject {
+	Q_OBJECT
+public:
+	BitrateController(OutputHealthMonitor *health, QObject *parent = nullptr);
+	~BitrateController();
+
+	void setEnabled(bool enabled);
+	void setArea(int partId, int areaId);
+	// 开播前上行测速得到的码率上限，0 表示不限制；即使未开启自适应也会在推流开始时应用
+	void setUplinkLimit(int kbps);
+	// 分区码率上限：配置目录的 bitrate_caps.json 优先，其次插件自带的默认表
+	static int capForArea(int partId, int areaId);
+
+private:
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	void onHealth(const OutputHealth &health);
+	void attach();
+	void detach();
+	void applyBitrate(int kbps);
+	void trace(const OutputHealth &health, int target, const char *action);
+
+	bool m_enabled = false;
+	int m_partId = 0;
+	int m_areaId = 0;
+	int m_uplinkLimit = 0;
+	BitratePolicy m_policy;
+	obs_encoder_t *m_encoder = nullptr;
+	int m_baseBitrate = 0;
+	FILE *m_trace = nullptr;
+	int64_t m_traceStartMs = 0;
+};
+} // namespace Core
@@ -3,7 +3,10 @@
 #include <filesystem>
 
 namespace Core {
-ConfigManager::ConfigManager() {}
+ConfigManager::ConfigManager()
+{
+	m_accounts.push_back(std::make_unique<Bili::Config>());
+}
 
 char *ConfigManager::getConfigPath()
 {
@@ -13,38 +16,85 @@ char *ConfigManager::getConfigPath()
 	return obs_module_file("config.json");
 }
 
-void ConfigManager::load()
+static void applyDefaults(Bili::Config &config)
 {
-	m_config = Bili::Config();
+	if (config.room_id.empty())
+		config.room_id = "12345";
+	if (config.csrf_token.empty())
+		config.csrf_token = "your_csrf_token";
+	if (config.title.empty())
+		config.title = "我的直播";
+}
 
-	char *configFile = getConfigPath();
-	if (!configFile)
-		return;
+static void readAccount(obs_data_t *settings, Bili::Config &config)
+{
+	config.room_id = obs_data_get_string(settings, "room_id");
+	config.csrf_token = obs_data_get_string(settings, "csrf_token");
+	config.mid = obs_data_get_string(settings, "mid");
+	config.cookies = obs_data_get_string(settings, "cookies");
+	config.refresh_token = obs_data_get_string(settings, "refresh_token");
+	config.title = obs_data_get_string(settings, "title");
+	config.rtmp_addr = obs_data_get_string(settings, "rtmp_addr");
+	config.rtmp_code = obs_data_get_string(settings, "rtmp_code");
+	config.part_id = static_cast<int>(obs_data_get_int(settings, "part_id"));
+	config.area_id = static_cast<int>(obs_data_get_int(settings, "area_id"));
+	config.backup_stream = obs_data_get_bool(settings, "backup_stream");
+	config.adaptive_bitrate = obs_data_get_bool(settings, "adaptive_bitrate");
+	config.uplink_test = obs_data_get_bool(settings, "uplink_test");
+	if (obs_data_has_user_value(settings, "auto_stop_grace_s"))
+		config.auto_stop_grace_s = static_cast<int>(obs_data_get_int(settings, "auto_stop_grace_s"));
+	applyDefaults(config);
+}
 
-	obs_data_t *settings = obs_data_create_from_json_file(configFile);
-	if (!settings) {
-		bfree(configFile);
-		return;
-	}
+static void writeAccount(obs_data_t *settings, const Bili::Config &config)
+{
+	obs_data_set_string(settings, "room_id", config.room_id.c_str());
+	obs_data_set_string(settings, "csrf_token", config.csrf_token.c_str());
+	obs_data_set_string(settings, "cookies", config.cookies.c_str());
+	obs_data_set_string(settings, "refresh_token", config.refresh_token.c_str());
+	obs_data_set_string(settings, "mid", config.mid.c_str());
+	obs_data_set_string(settings, "title", config.title.c_str());
+	obs_data_set_string(settings, "rtmp_addr", config.rtmp_addr.c_str());
+	obs_data_set_string(settings, "rtmp_code", config.rtmp_code.c_str());
+	obs_data_set_int(settings, "part_id", config.part_id);
+	obs_data_set_int(settings, "area_id", config.area_id);
+	obs_data_set_bool(settings, "backup_stream", config.backup_stream);
+	obs_data_set_bool(settings, "adaptive_bitrate", config.adaptive_bitrate);
+	obs_data_set_bool(settings, "uplink_test", config.uplink_test);
+	obs_data_set_int(settings, "auto_stop_grace_s", config.auto_stop_grace_s);
+}
 
-	m_config.room_id = obs_data_get_string(settings, "room_id");
-	m_config.csrf_token = obs_data_get_string(settings, "csrf_token");
-	m_config.mid = obs_data_get_string(settings, "mid");
-	m_config.cookies = obs_data_get_string(settings, "cookies");
-	m_config.title = obs_data_get_string(settings, "title");
-	m_config.rtmp_addr = obs_data_get_string(settings, "rtmp_addr");
-	m_config.rtmp_code = obs_data_get_string(settings, "rtmp_code");
-	m_config.part_id = static_cast<int>(obs_data_get_int(settings, "part_id"));
-	m_config.area_id = static_cast<int>(obs_data_get_int(settings, "area_id"));
-	obs_data_release(settings);
+void ConfigManager::load()
+{
+	m_accounts.clear();
+	m_active = 0;
+
+	char *configFile = getConfigPath();
+	obs_data_t *settings = configFile ? obs_data_create_from_json_file_safe(configFile, "bak") : nullptr;
 	bfree(configFile);
+	if (settings) {
+		// 旧版配置只有一个账号，字段直接在顶层
+		obs_data_array_t *accounts = obs_data_get_array(settings, "accounts");
+		size_t count = accounts ? obs_data_array_count(accounts) : 0;
+		for (size_t i = 0; i < count; ++i) {
+			obs_data_t *item = obs_data_array_item(accounts, i);
+			m_accounts.push_back(std::make_unique<Bili::Config>());
+			readAccount(item, *m_accounts.back());
+			obs_data_release(item);
+		}
+		obs_data_array_release(accounts);
+		if (m_accounts.empty()) {
+			m_accounts.push_back(std::make_unique<Bili::Config>());
+			readAccount(settings, *m_accounts.back());
+		}
+		m_active = static_cast<size_t>(obs_data_get_int(settings, "active"));
+		obs_data_release(settings);
+	}
 
-	if (m_config.room_id.empty())
-		m_config.room_id = "12345";
-	if (m_config.csrf_token.empty())
-		m_config.csrf_token = "your_csrf_token";
-	if (m_config.title.empty())
-		m_config.title = "我的直播";
+	if (m_accounts.empty())
+		addAccount();
+	if (m_active >= m_accounts.size())
+		m_active = 0;
 }
 
 void ConfigManager::save()
@@ -54,21 +104,46 @@ void ConfigManager::save()
 		return;
 
 	obs_data_t *settings = obs_data_create();
-	obs_data_set_string(settings, "room_id", m_config.room_id.c_str());
-	obs_data_set_string(settings, "csrf_token", m_config.csrf_token.c_str());
-	obs_data_set_string(settings, "cookies", m_config.cookies.c_str());
-	obs_data_set_string(settings, "mid", m_config.mid.c_str());
-	obs_data_set_string(settings, "title", m_config.title.c_str());
-	obs_data_set_string(settings, "rtmp_addr", m_config.rtmp_addr.c_str());
-	obs_data_set_string(settings, "rtmp_code", m_config.rtmp_code.c_str());
-	obs_data_set_int(settings, "part_id", m_config.part_id);
-	obs_data_set_int(settings, "area_id", m_config.area_id);
+	obs_data_array_t *accounts = obs_data_array_create();
+	for (const auto &account : m_accounts) {
+		obs_data_t *item = obs_data_create();
+		writeAccount(item, *account);
+		obs_data_array_push_back(accounts, item);
+		obs_data_release(item);
+	}
+	obs_data_set_array(settings, "accounts", accounts);
+	obs_data_array_release(accounts);
+	obs_data_set_int(settings, "active", static_cast<long long>(m_active));
+
 	std::error_code ec;
 	std::filesystem::create_directories(std::filesystem::path(configFile).parent_path(), ec);
-	if (!obs_data_save_json(settings, configFile)) {
+	// 先写临时文件再替换，写到一半崩溃也不会丢失 cookies；上一版保留为 .bak
+	if (!obs_data_save_json_safe(settings, configFile, "tmp", "bak")) {
 		blog(LOG_WARNING, "[obs-bilibili-stream] 配置保存失败: %s", configFile);
 	}
 	obs_data_release(settings);
 	bfree(configFile);
 }
+
+void ConfigManager::setActive(size_t index)
+{
+	if (index < m_accounts.size())
+		m_active = index;
+}
+
+size_t ConfigManager::addAccount()
+{
+	m_accounts.push_back(std::make_unique<Bili::Config>());
+	applyDefaults(*m_accounts.back());
+	return m_accounts.size() - 1;
+}
+
+void ConfigManager::removeAccount(size_t index)
+{
+	if (m_accounts.size() < 2 || index >= m_accounts.size())
+		return;
+	m_accounts.erase(m_accounts.begin() + static_cast<std::ptrdiff_t>(index));
+	if (m_active >= index && m_active > 0)
+		--m_active;
+}
 } // namespace Core
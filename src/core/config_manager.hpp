@@ -1,17 +1,32 @@
 #pragma once
+#include <memory>
+#include <vector>
 #include "bilibili_api.hpp"
 
 namespace Core {
+// 管理多个账号 / 直播间；config() 始终指向当前选中的账号。
+// 账号对象单独分配，增删账号不会使已取得的引用失效（被删除的账号除外）
 class ConfigManager {
 public:
 	ConfigManager();
 	void load();
 	void save();
-	Bili::Config &config() { return m_config; }
-	const Bili::Config &config() const { return m_config; }
+	Bili::Config &config() { return *m_accounts[m_active]; }
+	const Bili::Config &config() const { return *m_accounts[m_active]; }
+
+	size_t accountCount() const { return m_accounts.size(); }
+	size_t activeIndex() const { return m_active; }
+	Bili::Config &account(size_t index) { return *m_accounts[index]; }
+	const Bili::Config &account(size_t index) const { return *m_accounts[index]; }
+	void setActive(size_t index);
+	// 新增一个空账号并返回其下标，不切换当前账号
+	size_t addAccount();
+	// 至少保留一个账号；删除当前账号时切换到前一个
+	void removeAccount(size_t index);
 
 private:
-	Bili::Config m_config;
+	std::vector<std::unique_ptr<Bili::Config>> m_accounts;
+	size_t m_active = 0;
 	char *getConfigPath();
 };
 } // namespace Core
@@ -0,0 +1,89 @@
+#include "core/event_bus.hpp"
+#include <chrono>
+
+namespace Core {
+EventBus::EventBus(size_t capacity, size_t batchSize)
+	: m_ring(capacity),
+	  m_batchSize(batchSize),
+	  m_consumers(std::make_shared<const std::vector<Consumer>>())
+{
+}
+
+EventBus::~EventBus()
+{
+	stop();
+}
+
+void EventBus::start()
+{
+	if (m_thread.joinable())
+		return;
+	m_stop = false;
+	m_thread = std::thread(&EventBus::run, this);
+}
+
+void EventBus::stop()
+{
+	m_stop = true;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool EventBus::publish(Danmaku::Event &&event)
+{
+	if (!m_ring.tryPush(std::move(event))) {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	m_published.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void EventBus::subscribe(Consumer consumer)
+{
+	// 写时复制，分发线程持有快照，不需要在热路径上加锁
+	std::lock_guard<std::mutex> lock(m_consumersMutex);
+	auto consumers = std::make_shared<std::vector<Consumer>>(*m_consumers);
+	consumers->push_back(std::move(consumer));
+	m_consumers = std::move(consumers);
+}
+
+EventBusStats EventBus::stats() const
+{
+	EventBusStats stats;
+	stats.published = m_published.load(std::memory_order_relaxed);
+	stats.dropped = m_dropped.load(std::memory_order_relaxed);
+	stats.dispatched = m_dispatched.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void EventBus::run()
+{
+	std::vector<Danmaku::Event> batch;
+	batch.reserve(m_batchSize);
+
+	while (!m_stop) {
+		batch.clear();
+		m_ring.drain([&](Danmaku::Event &event) { batch.push_back(std::move(event)); }, m_batchSize);
+		if (batch.empty()) {
+			// 空闲时短暂休眠；发布端不做任何唤醒操作，保持无锁
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			continue;
+		}
+
+		dispatch(batch.data(), batch.size());
+	}
+}
+
+void EventBus::dispatch(const Danmaku::Event *events, size_t count)
+{
+	std::shared_ptr<const std::vector<Consumer>> consumers;
+	{
+		std::lock_guard<std::mutex> lock(m_consumersMutex);
+		consumers = m_consumers;
+	}
+	for (const auto &consumer : *consumers)
+		consumer(events, count);
+	m_dispatched.fetch_add(count, std::memory_order_relaxed);
+}
+} // namespace Core
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/spsc_ring.hpp"
+#include "danmaku/danmaku_event.hpp"
+
+namespace Core {
+struct EventBusStats {
+	uint64_t published = 0;
+	uint64_t dropped = 0;
+	uint64_t dispatched = 0;
+};
+
+// 网络线程 → 插件内消费者的事件总线。发布端无锁、永不阻塞，队列满时计数丢弃；
+// 分发线程批量取出事件交给消费者，消费者需自行切换到 UI 线程（如有需要）
+class EventBus {
+public:
+	using Consumer = std::function<void(const Danmaku::Event *events, size_t count)>;
+
+	explicit EventBus(size_t capacity = 16384, size_t batchSize = 256);
+	~EventBus();
+
+	void start();
+	void stop();
+
+	// 生产者（网络线程）调用
+	bool publish(Danmaku::Event &&event);
+
+	void subscribe(Consumer consumer);
+	// 绕过队列直接交给当前消费者，用于离线回放场次日志（此时不应有网络线程在发布）
+	void dispatch(const Danmaku::Event *events, size_t count);
+	EventBusStats stats() const;
+
+private:
+	void run();
+
+	SpscRing<Danmaku::Event> m_ring;
+	size_t m_batchSize;
+	std::thread m_thread;
+	std::atomic<bool> m_stop{false};
+
+	std::mutex m_consumersMutex;
+	std::shared_ptr<const std::vector<Consumer>> m_consumers;
+
+	std::atomic<uint64_t> m_published{0};
+	std::atomic<uint64_t> m_dropped{0};
+	std::atomic<uint64_t> m_dispatched{0};
+};
+} // namespace Core
@@ -0,0 +1,410 @@
+#include "core/event_log.hpp"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <obs-module.h>
+#include "plugin_utils.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+static const char kMagic[8] = {'B', 'L', 'I', 'V', 'E', 'L', 'O', 'G'};
+static const uint32_t kVersion = 1;
+static const size_t kHeaderSize = 32;
+static const uint32_t kMaxRecord = 1 << 20;
+static const size_t kReplayBatch = 256;
+
+static int64_t nowMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+static void putU32(std::string &out, uint32_t v)
+{
+	for (int i = 0; i < 4; ++i)
+		out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+static void putU64(std::string &out, uint64_t v)
+{
+	for (int i = 0; i < 8; ++i)
+		out += static_cast<char>((v >> (8 * i)) & 0xff);
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+	return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+static uint64_t getU64(const uint8_t *p)
+{
+	return uint64_t(getU32(p)) | uint64_t(getU32(p + 4)) << 32;
+}
+
+// 有符号整数用 zigzag + LEB128 变长编码，弹幕里多数字段为 0 或很小，只占 1 字节
+static void putVarint(std::string &out, int64_t value)
+{
+	uint64_t v = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+	while (v >= 0x80) {
+		out += static_cast<char>((v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	out += static_cast<char>(v);
+}
+
+static void putBytes(std::string &out, const std::string &s)
+{
+	putVarint(out, int64_t(s.size()));
+	out += s;
+}
+
+static bool getVarint(const uint8_t *&p, const uint8_t *end, int64_t &out)
+{
+	uint64_t v = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (p == end)
+			return false;
+		uint8_t b = *p++;
+		v |= uint64_t(b & 0x7f) << shift;
+		if (!(b & 0x80)) {
+			out = int64_t(v >> 1) ^ -int64_t(v & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool getBytes(const uint8_t *&p, const uint8_t *end, std::string &out)
+{
+	int64_t len = 0;
+	if (!getVarint(p, end, len) || len < 0 || len > end - p)
+		return false;
+	out.assign(reinterpret_cast<const char *>(p), size_t(len));
+	p += len;
+	return true;
+}
+
+static void encodeRecord(std::string &out, const Danmaku::Event &e, int64_t startMs)
+{
+	// 先占位长度前缀，写完负载后回填
+	size_t lenPos = out.size();
+	putU32(out, 0);
+	out += static_cast<char>(e.type);
+	putVarint(out, e.timestamp_ms - startMs);
+	putVarint(out, e.uid);
+	putBytes(out, e.uname);
+	putBytes(out, e.text);
+	putVarint(out, e.gift_id);
+	putVarint(out, e.gift_num);
+	putVarint(out, e.gift_price);
+	putVarint(out, e.value);
+
+	uint32_t len = uint32_t(out.size() - lenPos - 4);
+	for (int i = 0; i < 4; ++i)
+		out[lenPos + i] = static_cast<char>((len >> (8 * i)) & 0xff);
+}
+
+static bool decodeRecord(const uint8_t *p, const uint8_t *end, Danmaku::Event &e, int64_t startMs)
+{
+	if (p == end)
+		return false;
+	e.type = static_cast<Danmaku::EventType>(*p++);
+	int64_t delta = 0;
+	if (!getVarint(p, end, delta) || !getVarint(p, end, e.uid) || !getBytes(p, end, e.uname) ||
+	    !getBytes(p, end, e.text) || !getVarint(p, end, e.gift_id) || !getVarint(p, end, e.gift_num) ||
+	    !getVarint(p, end, e.gift_price) || !getVarint(p, end, e.value))
+		return false;
+	e.timestamp_ms = startMs + delta;
+	return true;
+}
+
+EventLogWriter::EventLogWriter() {}
+
+EventLogWriter::~EventLogWriter()
+{
+	close();
+}
+
+std::string EventLogWriter::sessionPath(const std::string &name, const char *extension)
+{
+	char *dir = obs_module_config_path("sessions");
+	if (!dir)
+		return std::string();
+	std::string path = dir;
+	bfree(dir);
+
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::u8path(path), ec);
+	if (ec) {
+		obs_log(LOG_WARNING, "创建场次日志目录失败: %s", ec.message().c_str());
+		return std::string();
+	}
+
+	char stamp[32];
+	std::time_t t = std::time(nullptr);
+	std::tm tm{};
+#ifdef _WIN32
+	localtime_s(&tm, &t);
+#else
+	localtime_r(&t, &tm);
+#endif
+	strftime(stamp, sizeof stamp, "%Y%m%d-%H%M%S", &tm);
+	return path + "/" + name + "-" + stamp + extension;
+}
+
+FILE *EventLogWriter::openFile(const std::string &path, const char *mode)
+{
+#ifdef _WIN32
+	std::wstring wmode(mode, mode + strlen(mode));
+	return _wfopen(std::filesystem::u8path(path).c_str(), wmode.c_str());
+#else
+	return fopen(path.c_str(), mode);
+#endif
+}
+
+bool EventLogWriter::open(const std::string &path, int64_t roomId)
+{
+	close();
+
+	m_file = openFile(path, "wb");
+	if (!m_file) {
+		obs_log(LOG_WARNING, "打开场次日志失败: %s", path.c_str());
+		return false;
+	}
+
+	m_startMs = nowMs();
+	std::string header(kMagic, sizeof kMagic);
+	putU32(header, kVersion);
+	putU32(header, uint32_t(kHeaderSize));
+	putU64(header, uint64_t(m_startMs));
+	putU64(header, uint64_t(roomId));
+	fwrite(header.data(), 1, header.size(), m_file);
+	fflush(m_file);
+
+	m_stop = false;
+	m_open = true;
+	m_thread = std::thread(&EventLogWriter::run, this);
+	obs_log(LOG_INFO, "场次日志: %s", path.c_str());
+	return true;
+}
+
+void EventLogWriter::close()
+{
+	if (!m_thread.joinable())
+		return;
+	m_open = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+	fclose(m_file);
+	m_file = nullptr;
+}
+
+void EventLogWriter::append(const Danmaku::Event *events, size_t count)
+{
+	if (!m_open.load(std::memory_order_relaxed))
+		return;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending.insert(m_pending.end(), events, events + count);
+	m_cv.notify_one();
+}
+
+void EventLogWriter::run()
+{
+	std::vector<Danmaku::Event> batch;
+	std::string buffer;
+	uint64_t written = 0;
+
+	while (true) {
+		bool stopping;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+			batch.swap(m_pending);
+			stopping = m_stop;
+		}
+
+		buffer.clear();
+		for (const auto &event : batch)
+			encodeRecord(buffer, event, m_startMs);
+		if (!buffer.empty()) {
+			// 每批写完立即 flush，进程崩溃时最多丢失最后一批
+			if (fwrite(buffer.data(), 1, buffer.size(), m_file) != buffer.size())
+				obs_log(LOG_WARNING, "写入场次日志失败");
+			fflush(m_file);
+			written += batch.size();
+		}
+		batch.clear();
+
+		if (stopping)
+			break;
+	}
+	obs_log(LOG_INFO, "场次日志已关闭，共 %llu 条事件", (unsigned long long)written);
+}
+
+EventLogReader::EventLogReader() {}
+
+EventLogReader::~EventLogReader()
+{
+	close();
+}
+
+bool EventLogReader::open(const std::string &path, std::string &err)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(std::filesystem::u8path(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+				  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		err = "无法打开文件";
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < LONGLONG(kHeaderSize)) {
+		CloseHandle(file);
+		err = "文件过小";
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view) {
+		if (mapping)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		err = "映射文件失败";
+		return false;
+	}
+	m_fileHandle = file;
+	m_mapping = mapping;
+	m_data = static_cast<const uint8_t *>(view);
+	m_size = size_t(size.QuadPart);
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		err = "无法打开文件";
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < off_t(kHeaderSize)) {
+		::close(fd);
+		err = "文件过小";
+		return false;
+	}
+	void *view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (view == MAP_FAILED) {
+		err = "映射文件失败";
+		return false;
+	}
+	madvise(view, size_t(st.st_size), MADV_SEQUENTIAL);
+	m_data = static_cast<const uint8_t *>(view);
+	m_size = size_t(st.st_size);
+#endif
+
+	if (memcmp(m_data, kMagic, sizeof kMagic) != 0 || getU32(m_data + 8) != kVersion ||
+	    getU32(m_data + 12) < kHeaderSize || getU32(m_data + 12) > m_size) {
+		close();
+		err = "不是有效的场次日志";
+		return false;
+	}
+	m_startMs = int64_t(getU64(m_data + 16));
+	m_roomId = int64_t(getU64(m_data + 24));
+	return true;
+}
+
+void EventLogReader::close()
+{
+	if (!m_data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_fileHandle);
+	m_mapping = nullptr;
+	m_fileHandle = nullptr;
+#else
+	munmap(const_cast<uint8_t *>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+size_t EventLogReader::scan(const std::function<void(const Danmaku::Event &event)> &fn) const
+{
+	if (!m_data)
+		return 0;
+
+	Danmaku::Event event;
+	size_t count = 0;
+	const uint8_t *p = m_data + getU32(m_data + 12);
+	const uint8_t *end = m_data + m_size;
+	while (end - p >= 4) {
+		uint32_t len = getU32(p);
+		if (len > kMaxRecord || len > size_t(end - p - 4))
+			break; // 末尾被截断的记录
+		if (!decodeRecord(p + 4, p + 4 + len, event, m_startMs))
+			break;
+		fn(event);
+		++count;
+		p += 4 + len;
+	}
+	return count;
+}
+
+size_t EventLogReader::replay(double speed,
+			      const std::function<void(const Danmaku::Event *events, size_t count)> &consumer,
+			      const std::atomic<bool> *stop) const
+{
+	using Clock = std::chrono::steady_clock;
+	std::vector<Danmaku::Event> batch;
+	batch.reserve(kReplayBatch);
+	const auto wallStart = Clock::now();
+	int64_t firstTs = 0;
+	size_t delivered = 0;
+	bool aborted = false;
+
+	auto flush = [&]() {
+		if (!batch.empty())
+			consumer(batch.data(), batch.size());
+		batch.clear();
+	};
+
+	scan([&](const Danmaku::Event &event) {
+		if (aborted)
+			return;
+		if (delivered++ == 0)
+			firstTs = event.timestamp_ms;
+		if (speed > 0) {
+			// 同一毫秒内的事件合并为一批，其余按原始间隔缩放后等待
+			auto due = wallStart + std::chrono::microseconds(
+						       int64_t(double(event.timestamp_ms - firstTs) * 1000.0 / speed));
+			if (due > Clock::now()) {
+				flush();
+				std::this_thread::sleep_until(due);
+			}
+		}
+		batch.push_back(event);
+		if (batch.size() >= kReplayBatch)
+			flush();
+		if (stop && stop->load(std::memory_order_relaxed))
+			aborted = true;
+	});
+	flush();
+	return delivered;
+}
+} // namespace Core
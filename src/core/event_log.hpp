@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "danmaku/danmaku_event.hpp"
+
+namespace Core {
+// 直播场次事件日志（.blog）：32 字节文件头 + 若干记录，每条记录为 u32 小端长度前缀 + 变长编码的事件字段。
+// 只追加写入；进程异常退出时末尾不完整的记录在读取时被忽略。
+class EventLogWriter {
+public:
+	EventLogWriter();
+	~EventLogWriter();
+
+	// 模块配置目录下 sessions/<name>-<开播时间><extension>，目录不存在时创建
+	static std::string sessionPath(const std::string &name, const char *extension = ".blog");
+	// 按 UTF-8 路径打开文件；Windows 上走宽字符接口，用户名含非 ASCII 字符时也能打开
+	static FILE *openFile(const std::string &path, const char *mode);
+
+	bool open(const std::string &path, int64_t roomId);
+	void close();
+	bool isOpen() const { return m_open.load(); }
+
+	// 任意线程调用（一般是事件总线分发线程），只做入队
+	void append(const Danmaku::Event *events, size_t count);
+
+private:
+	void run();
+
+	FILE *m_file = nullptr;
+	int64_t m_startMs = 0;
+	std::atomic<bool> m_open{false};
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::vector<Danmaku::Event> m_pending;
+	bool m_stop = false;
+};
+
+class EventLogReader {
+public:
+	EventLogReader();
+	~EventLogReader();
+	EventLogReader(const EventLogReader &) = delete;
+	EventLogReader &operator=(const EventLogReader &) = delete;
+
+	bool open(const std::string &path, std::string &err);
+	void close();
+
+	int64_t startMs() const { return m_startMs; }
+	int64_t roomId() const { return m_roomId; }
+
+	// 顺序扫描全部事件；回调中的 Event 对象被复用，需要保留时自行拷贝。返回事件数
+	size_t scan(const std::function<void(const Danmaku::Event &event)> &fn) const;
+
+	// 按记录的时间间隔以 speed 倍速回放给消费者（speed <= 0 表示不等待）；stop 置位时提前结束
+	size_t replay(double speed, const std::function<void(const Danmaku::Event *events, size_t count)> &consumer,
+		      const std::atomic<bool> *stop = nullptr) const;
+
+private:
+	const uint8_t *m_data = nullptr;
+	size_t m_size = 0;
+	int64_t m_startMs = 0;
+	int64_t m_roomId = 0;
+#ifdef _WIN32
+	void *m_fileHandle = nullptr;
+	void *m_mapping = nullptr;
+#endif
+};
+} // namespace Core
@@ -0,0 +1,253 @@
+#include "core/gift_aggregator.hpp"
+#include <obs-module.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const int kRollupIntervalMs = 10000;
+static const int kLogEveryTicks = 6; // 每分钟写一次日志
+static const int kWindowMinutes[3] = {1, 5, 60};
+// 每级时间轮多一个槽，留给窗口最旧、只有一部分落在窗口内的那一段
+static const size_t kFineSlots = 61;
+static const size_t kFineCapacity = 256;
+static const int64_t kFineWidthMs = 5000;
+static const size_t kCoarseSlots = 61;
+static const size_t kCoarseCapacity = 512;
+static const int64_t kCoarseWidthMs = 60000;
+
+static int64_t nowMs()
+{
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static int64_t scale(int64_t value, double weight)
+{
+	return weight >= 1.0 ? value : static_cast<int64_t>(std::llround(static_cast<double>(value) * weight));
+}
+
+static uint64_t mix(uint64_t x)
+{
+	// splitmix64 终结函数
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+// 截断到 UTF-8 字符边界，避免把多字节字符截成半个
+static void copyName(char *dst, size_t size, const std::string &src)
+{
+	size_t n = std::min(src.size(), size - 1);
+	while (n > 0 && n < src.size() && (static_cast<uint8_t>(src[n]) & 0xC0) == 0x80)
+		--n;
+	memcpy(dst, src.data(), n);
+	dst[n] = '\0';
+}
+
+GiftAggregator::GiftAggregator(QObject *parent, size_t topN)
+	: QObject(parent),
+	  m_fine(kFineSlots, kFineCapacity, kFineWidthMs),
+	  m_coarse(kCoarseSlots, kCoarseCapacity, kCoarseWidthMs),
+	  m_merge(kMergeCapacity),
+	  m_topN(topN)
+{
+	for (int i = 0; i < 3; ++i)
+		m_latest.windows[i].minutes = kWindowMinutes[i];
+	connect(&m_timer, &QTimer::timeout, this, &GiftAggregator::onTick);
+	m_timer.start(kRollupIntervalMs);
+}
+
+GiftAggregator::Wheel::Wheel(size_t count, size_t capacity, int64_t width) : widthMs(width), slots(count)
+{
+	for (auto &slot : slots)
+		slot.entries.resize(capacity);
+}
+
+GiftAggregator::Slot &GiftAggregator::Wheel::slotFor(int64_t ms)
+{
+	int64_t index = ms / widthMs;
+	Slot &slot = slots[size_t(index % int64_t(slots.size()))];
+	if (slot.index != index) {
+		// 时间轮转过一圈，旧数据整槽作废
+		for (auto &entry : slot.entries)
+			entry.used = false;
+		slot.index = index;
+		slot.used = 0;
+		slot.otherValue = 0;
+		slot.otherCount = 0;
+	}
+	return slot;
+}
+
+void GiftAggregator::fold(Slot &slot, const Danmaku::Event &event)
+{
+	int64_t value = event.gift_price * event.gift_num;
+	const size_t capacity = slot.entries.size();
+	size_t mask = capacity - 1;
+	size_t i = size_t(mix(uint64_t(event.uid) * 31 + uint64_t(event.gift_id))) & mask;
+	Entry *smallest = nullptr;
+	for (size_t probe = 0; probe < capacity; ++probe, i = (i + 1) & mask) {
+		Entry &entry = slot.entries[i];
+		if (entry.used && entry.uid == event.uid && entry.gift_id == event.gift_id) {
+			entry.count += event.gift_num;
+			entry.value += value;
+			return;
+		}
+		if (!entry.used) {
+			// 负载超过 3/4 后不再插入新键，线性探测保持短链
+			if (slot.used >= capacity * 3 / 4)
+				break;
+			entry.used = true;
+			entry.uid = event.uid;
+			entry.gift_id = event.gift_id;
+			entry.count = event.gift_num;
+			entry.value = value;
+			copyName(entry.uname, kNameSize, event.uname);
+			++slot.used;
+			return;
+		}
+		if (probe < kEvictWindow && (!smallest || entry.value < smallest->value))
+			smallest = &entry;
+	}
+
+	// 表已满：挤掉探测窗口内价值最小的记录，保证大额礼物不会因为来得晚而只计入 otherValue
+	if (smallest && smallest->value < value) {
+		slot.otherValue += smallest->value;
+		slot.otherCount += smallest->count;
+		smallest->uid = event.uid;
+		smallest->gift_id = event.gift_id;
+		smallest->count = event.gift_num;
+		smallest->value = value;
+		copyName(smallest->uname, kNameSize, event.uname);
+		return;
+	}
+	slot.otherValue += value;
+	slot.otherCount += event.gift_num;
+}
+
+void GiftAggregator::add(const Danmaku::Event *events, size_t count)
+{
+	int64_t now = nowMs();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Slot *fine = nullptr;
+	Slot *coarse = nullptr;
+	for (size_t i = 0; i < count; ++i) {
+		if (events[i].type != Danmaku::EventType::Gift)
+			continue;
+		if (!fine) {
+			fine = &m_fine.slotFor(now);
+			coarse = &m_coarse.slotFor(now);
+		}
+		fold(*fine, events[i]);
+		fold(*coarse, events[i]);
+	}
+}
+
+void GiftAggregator::buildWindow(int64_t now, GiftWindow &window)
+{
+	window.totalValue = 0;
+	window.totalCount = 0;
+	window.otherValue = 0;
+	window.top.clear();
+	for (auto &total : m_merge)
+		total.used = false;
+
+	// 细轮能覆盖的窗口用细轮，否则用粗轮
+	const int64_t spanMs = int64_t(window.minutes) * 60000;
+	const Wheel &wheel = spanMs <= m_fine.widthMs * int64_t(m_fine.slots.size() - 1) ? m_fine : m_coarse;
+	const int64_t width = wheel.widthMs;
+	const int64_t start = now - spanMs;
+
+	// 按用户合并窗口内各槽、各礼物的记录
+	size_t used = 0;
+	size_t mask = kMergeCapacity - 1;
+	for (int64_t index = start / width; index <= now / width; ++index) {
+		const Slot &slot = wheel.slots[size_t(index % int64_t(wheel.slots.size()))];
+		if (slot.index != index)
+			continue;
+		// 最旧的一槽只有 [start, 槽末尾) 落在窗口内，假定槽内均匀分布，按比例折算
+		double weight = std::min(1.0, double((index + 1) * width - start) / double(width));
+		window.totalValue += scale(slot.otherValue, weight);
+		window.totalCount += scale(slot.otherCount, weight);
+		window.otherValue += scale(slot.otherValue, weight);
+		for (const auto &entry : slot.entries) {
+			if (!entry.used)
+				continue;
+			int64_t value = scale(entry.value, weight);
+			int64_t count = scale(entry.count, weight);
+			if (!value && !count)
+				continue;
+			window.totalValue += value;
+			window.totalCount += count;
+
+			size_t i = size_t(mix(uint64_t(entry.uid))) & mask;
+			while (m_merge[i].used && m_merge[i].uid != entry.uid)
+				i = (i + 1) & mask;
+			UserTotal &total = m_merge[i];
+			if (!total.used) {
+				if (used >= kMergeCapacity * 3 / 4) {
+					window.otherValue += value;
+					continue;
+				}
+				total.used = true;
+				total.uid = entry.uid;
+				total.value = 0;
+				total.count = 0;
+				++used;
+			}
+			total.value += value;
+			total.count += count;
+			total.uname = entry.uname;
+		}
+	}
+
+	std::vector<const UserTotal *> users;
+	users.reserve(used);
+	for (const auto &total : m_merge) {
+		if (total.used)
+			users.push_back(&total);
+	}
+	size_t n = std::min(m_topN, users.size());
+	std::partial_sort(users.begin(), users.begin() + n, users.end(), [](const UserTotal *a, const UserTotal *b) {
+		return a->value != b->value ? a->value > b->value : a->count > b->count;
+	});
+	for (size_t i = 0; i < n; ++i)
+		window.top.push_back({users[i]->uid, users[i]->uname, users[i]->value, users[i]->count});
+}
+
+GiftRollup GiftAggregator::rollup()
+{
+	GiftRollup result;
+	int64_t now = nowMs();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (int i = 0; i < 3; ++i) {
+		result.windows[i].minutes = kWindowMinutes[i];
+		buildWindow(now, result.windows[i]);
+	}
+	return result;
+}
+
+void GiftAggregator::onTick()
+{
+	m_latest = rollup();
+	emit rollupReady(m_latest);
+
+	if (++m_ticks % kLogEveryTicks != 0)
+		return;
+	const GiftWindow &window = m_latest.windows[0];
+	if (!window.totalCount)
+		return;
+	std::string top;
+	for (size_t i = 0; i < window.top.size() && i < 3; ++i) {
+		top += " " + window.top[i].uname + "(" + std::to_string(window.top[i].value) + ")";
+	}
+	obs_log(LOG_INFO, "礼物统计(1分钟): %lld 个，%lld 金瓜子，前三:%s", (long long)window.totalCount,
+		(long long)window.totalValue, top.c_str());
+}
+} // namespace Core
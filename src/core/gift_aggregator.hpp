@@ -0,0 +1,95 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "danmaku/danmaku_event.hpp"
+
+namespace Core {
+struct GiftRank {
+	int64_t uid = 0;
+	std::string uname;
+	int64_t value = 0; // 金瓜子
+	int64_t count = 0; // 礼物个数
+};
+
+struct GiftWindow {
+	int minutes = 0;
+	int64_t totalValue = 0;
+	int64_t totalCount = 0;
+	int64_t otherValue = 0; // 超出表容量、未能按用户区分的部分
+	std::vector<GiftRank> top;
+};
+
+struct GiftRollup {
+	GiftWindow windows[3]; // 最近 1 / 5 / 60 分钟
+};
+
+// 礼物连击聚合：按 (用户, 礼物) 折叠到固定大小的哈希表，哈希表组成两级时间轮：5 秒一槽的细轮覆盖最近
+// 5 分钟（1 / 5 分钟窗口），1 分钟一槽的粗轮覆盖最近 1 小时（60 分钟窗口）。窗口最旧的一槽只有一部分
+// 落在窗口内，按覆盖比例折算，因此每个窗口都是随时间滑动的最近 N 分钟。
+// 内存上限固定，与直播间规模无关；表满时挤掉小额记录，被挤掉的部分计入 otherValue
+class GiftAggregator : public QObject {
+	Q_OBJECT
+public:
+	explicit GiftAggregator(QObject *parent = nullptr, size_t topN = 10);
+
+	// 任意线程调用（事件总线分发线程），非礼物事件忽略
+	void add(const Danmaku::Event *events, size_t count);
+	GiftRollup rollup();
+	const GiftRollup &latest() const { return m_latest; }
+
+signals:
+	void rollupReady(const Core::GiftRollup &rollup);
+
+private:
+	static constexpr size_t kEvictWindow = 16;
+	static constexpr size_t kMergeCapacity = 4096;
+	static constexpr size_t kNameSize = 48;
+
+	struct Entry {
+		bool used = false;
+		int64_t uid = 0;
+		int64_t gift_id = 0;
+		int64_t count = 0;
+		int64_t value = 0;
+		char uname[kNameSize] = {};
+	};
+	struct Slot {
+		int64_t index = -1; // 覆盖 [index * width, (index + 1) * width) 毫秒
+		size_t used = 0;
+		int64_t otherValue = 0;
+		int64_t otherCount = 0;
+		std::vector<Entry> entries; // 容量为 2 的幂
+	};
+	struct Wheel {
+		Wheel(size_t slots, size_t capacity, int64_t widthMs);
+		Slot &slotFor(int64_t ms);
+
+		int64_t widthMs;
+		std::vector<Slot> slots;
+	};
+	struct UserTotal {
+		bool used = false;
+		int64_t uid = 0;
+		int64_t value = 0;
+		int64_t count = 0;
+		const char *uname = nullptr;
+	};
+
+	void onTick();
+	static void fold(Slot &slot, const Danmaku::Event &event);
+	void buildWindow(int64_t now, GiftWindow &window);
+
+	std::mutex m_mutex;
+	Wheel m_fine;
+	Wheel m_coarse;
+	std::vector<UserTotal> m_merge;
+	size_t m_topN;
+	QTimer m_timer;
+	int m_ticks = 0;
+	GiftRollup m_latest;
+};
+} // namespace Core
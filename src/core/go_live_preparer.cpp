@@ -0,0 +1,76 @@
+#include "core/go_live_preparer.hpp"
+#include <obs-module.h>
+#include <QPointer>
+#include "core/ingest_prober.hpp"
+#include "core/uplink_tester.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const int kUplinkTestMs = 3000;
+static const int kUplinkDefaultCapKbps = 10000;
+
+GoLivePreparer::GoLivePreparer(QObject *parent) : QObject(parent) {}
+
+GoLivePreparer::~GoLivePreparer()
+{
+	// 测速的每一步都受 deadline 约束，置位 abort 后很快结束
+	m_abort = true;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+int GoLivePreparer::testUplink(const std::string &rtmpAddr, int capKbps, const std::atomic<bool> &abort)
+{
+	// 以分区上限的 1.5 倍限速发送，既能判断带宽是否够用，又不会在几秒内灌入过多数据
+	int ceiling = (capKbps > 0 ? capKbps : kUplinkDefaultCapKbps) * 3 / 2;
+	auto result = UplinkTester::run(rtmpAddr, kUplinkTestMs, ceiling, &abort);
+	if (!result.ok) {
+		obs_log(LOG_WARNING, "上行测速失败: %s，不限制码率", result.error.c_str());
+		return 0;
+	}
+	int recommended = UplinkTester::recommend(result, capKbps);
+	obs_log(LOG_INFO, "上行测速: %.0f kbps%s，RTT 空载 %d ms / 负载 %.0f ms（抖动 %.0f ms），建议码率 %d kbps",
+		result.throughput_kbps, result.saturated ? "（已达测速上限）" : "", result.rtt_idle_ms,
+		result.rtt_loaded_ms, result.rtt_jitter_ms, recommended);
+	return recommended;
+}
+
+bool GoLivePreparer::prepare(const std::vector<Bili::RtmpInfo> &candidates, const Bili::RtmpInfo &fallback,
+			     int probeTimeoutMs, int uplinkCapKbps)
+{
+	if (m_busy)
+		return false;
+	if (m_thread.joinable())
+		m_thread.join();
+	m_busy = true;
+	m_abort = false;
+	uint64_t generation = ++m_generation;
+
+	m_thread = std::thread([this, candidates, fallback, probeTimeoutMs, uplinkCapKbps, generation]() {
+		GoLivePlan plan;
+		plan.chosen = fallback;
+		IngestProber::selectFastest(candidates, plan.chosen, probeTimeoutMs, &plan.backups);
+		if (uplinkCapKbps >= 0 && !m_abort)
+			plan.uplink_kbps = testUplink(plan.chosen.addr, uplinkCapKbps, m_abort);
+
+		QPointer<GoLivePreparer> self(this);
+		QMetaObject::invokeMethod(
+			this,
+			[self, generation, plan = std::move(plan)]() {
+				if (!self)
+					return;
+				self->m_busy = false;
+				if (generation == self->m_generation)
+					emit self->ready(plan);
+			},
+			Qt::QueuedConnection);
+	});
+	return true;
+}
+
+void GoLivePreparer::cancel()
+{
+	m_abort = true;
+	++m_generation;
+}
+} // namespace Core
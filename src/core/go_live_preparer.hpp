@@ -0,0 +1,42 @@
+#pragma once
+#include <QObject>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "bilibili_schema.hpp"
+
+namespace Core {
+struct GoLivePlan {
+	Bili::RtmpInfo chosen;               // 测速最快的节点；测速失败时为接口默认节点
+	std::vector<Bili::RtmpInfo> backups; // 其余健康节点，按延迟从低到高
+	int uplink_kbps = 0;                 // 上行测速建议的码率上限，0 表示不限制
+};
+
+// 开播接口返回后、OBS 连接推流前的准备工作（推流节点测速、上行测速）放在后台线程进行，
+// 完成后在 UI 线程发出 ready，开播流程从那里继续，测速期间界面不会卡住
+class GoLivePreparer : public QObject {
+	Q_OBJECT
+public:
+	explicit GoLivePreparer(QObject *parent = nullptr);
+	~GoLivePreparer();
+
+	// uplinkCapKbps < 0 时跳过上行测速，0 表示分区没有码率上限。上一次准备的线程尚未结束时返回 false
+	bool prepare(const std::vector<Bili::RtmpInfo> &candidates, const Bili::RtmpInfo &fallback,
+		     int probeTimeoutMs, int uplinkCapKbps);
+	// 中止正在进行的测速并丢弃尚未发出的结果（下播、直播间在别处被关闭时调用）
+	void cancel();
+	bool isBusy() const { return m_busy; }
+
+signals:
+	void ready(const Core::GoLivePlan &plan);
+
+private:
+	static int testUplink(const std::string &rtmpAddr, int capKbps, const std::atomic<bool> &abort);
+
+	std::thread m_thread;
+	std::atomic<bool> m_abort{false};
+	uint64_t m_generation = 0; // 只在 UI 线程读写
+	bool m_busy = false;
+};
+} // namespace Core
@@ -0,0 +1,122 @@
+#include "core/ingest_failover.hpp"
+#include <obs-module.h>
+#include <QMetaObject>
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const double kCongestionThreshold = 0.8;
+static const int kCongestedUpdates = 5; // 健康数据每秒更新一次，即持续 5 秒
+static const size_t kReconnectLimit = 2;
+static const auto kReconnectWindow = std::chrono::seconds(60);
+static const auto kSwitchCooldown = std::chrono::seconds(60);
+
+IngestFailover::IngestFailover(OutputHealthMonitor *health, StreamLauncher *launcher, QObject *parent)
+	: QObject(parent),
+	  m_launcher(launcher)
+{
+	connect(health, &OutputHealthMonitor::healthUpdated, this, &IngestFailover::onHealth);
+	obs_frontend_add_event_callback(&IngestFailover::onFrontendEvent, this);
+}
+
+IngestFailover::~IngestFailover()
+{
+	obs_frontend_remove_event_callback(&IngestFailover::onFrontendEvent, this);
+	detachOutput();
+}
+
+void IngestFailover::arm(const Bili::RtmpInfo &primary, const std::vector<Bili::RtmpInfo> &backups)
+{
+	m_primary = primary;
+	m_backups.assign(backups.begin(), backups.end());
+	m_armed = !m_backups.empty();
+	m_congestedUpdates = 0;
+	m_reconnects.clear();
+	m_lastSwitch = {};
+	if (m_armed)
+		obs_log(LOG_INFO, "备用推流已就绪: %zu 个备用节点", m_backups.size());
+	else
+		obs_log(LOG_WARNING, "备用推流: 接口没有返回可用的备用节点");
+}
+
+void IngestFailover::disarm()
+{
+	m_armed = false;
+	m_backups.clear();
+}
+
+void IngestFailover::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	auto *self = static_cast<IngestFailover *>(data);
+	if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED)
+		self->attachOutput();
+	else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED)
+		self->detachOutput();
+}
+
+void IngestFailover::attachOutput()
+{
+	detachOutput();
+	m_output = obs_frontend_get_streaming_output();
+	if (m_output)
+		signal_handler_connect(obs_output_get_signal_handler(m_output), "reconnect",
+				       &IngestFailover::onOutputReconnect, this);
+}
+
+void IngestFailover::detachOutput()
+{
+	if (!m_output)
+		return;
+	signal_handler_disconnect(obs_output_get_signal_handler(m_output), "reconnect",
+				  &IngestFailover::onOutputReconnect, this);
+	obs_output_release(m_output);
+	m_output = nullptr;
+}
+
+void IngestFailover::onOutputReconnect(void *data, calldata_t *)
+{
+	// 输出线程回调，转到 UI 线程处理
+	auto *self = static_cast<IngestFailover *>(data);
+	QMetaObject::invokeMethod(self, [self]() { self->onReconnect(); }, Qt::QueuedConnection);
+}
+
+void IngestFailover::onReconnect()
+{
+	if (!m_armed)
+		return;
+	auto now = std::chrono::steady_clock::now();
+	m_reconnects.push_back(now);
+	while (!m_reconnects.empty() && now - m_reconnects.front() > kReconnectWindow)
+		m_reconnects.pop_front();
+	obs_log(LOG_WARNING, "推流输出重连（60 秒内第 %zu 次）", m_reconnects.size());
+	if (m_reconnects.size() >= kReconnectLimit)
+		failover("频繁重连");
+}
+
+void IngestFailover::onHealth(const OutputHealth &health)
+{
+	if (!m_armed || !health.active || m_launcher->isSwitching())
+		return;
+	m_congestedUpdates = health.congestion >= kCongestionThreshold ? m_congestedUpdates + 1 : 0;
+	if (m_congestedUpdates >= kCongestedUpdates)
+		failover("持续拥塞");
+}
+
+void IngestFailover::failover(const char *reason)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (m_backups.empty() || m_launcher->isSwitching() || now - m_lastSwitch < kSwitchCooldown)
+		return;
+
+	Bili::RtmpInfo target = m_backups.front();
+	obs_log(LOG_WARNING, "主推流节点异常（%s），切换到备用节点 %s", reason, target.addr.c_str());
+	if (!m_launcher->switchTo(target))
+		return;
+	// 原主节点排到备用队尾，备用节点也出问题时还能切回去
+	m_backups.pop_front();
+	m_backups.push_back(m_primary);
+	m_primary = target;
+	m_lastSwitch = now;
+	m_congestedUpdates = 0;
+	m_reconnects.clear();
+}
+} // namespace Core
@@ -0,0 +1,41 @@
+#pragma once
+#include <QObject>
+#include <chrono>
+#include <deque>
+#include <obs-frontend-api.h>
+#include <vector>
+#include "bilibili_schema.hpp"
+#include "core/output_health.hpp"
+#include "core/stream_launcher.hpp"
+
+namespace Core {
+// 备用推流：主节点持续拥塞或短时间内反复重连时，自动把推流输出切换到备用节点
+class IngestFailover : public QObject {
+	Q_OBJECT
+public:
+	IngestFailover(OutputHealthMonitor *health, StreamLauncher *launcher, QObject *parent = nullptr);
+	~IngestFailover();
+
+	// primary 为当前推流节点，backups 按优先级排列
+	void arm(const Bili::RtmpInfo &primary, const std::vector<Bili::RtmpInfo> &backups);
+	void disarm();
+
+private:
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	static void onOutputReconnect(void *data, calldata_t *params);
+	void attachOutput();
+	void detachOutput();
+	void onHealth(const OutputHealth &health);
+	void onReconnect();
+	void failover(const char *reason);
+
+	StreamLauncher *m_launcher;
+	bool m_armed = false;
+	Bili::RtmpInfo m_primary;
+	std::deque<Bili::RtmpInfo> m_backups;
+	obs_output_t *m_output = nullptr;
+	int m_congestedUpdates = 0;
+	std::deque<std::chrono::steady_clock::time_point> m_reconnects;
+	std::chrono::steady_clock::time_point m_lastSwitch;
+};
+} // namespace Core
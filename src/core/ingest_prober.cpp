@@ -0,0 +1,141 @@
+#include "core/ingest_prober.hpp"
+#include <obs-module.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "core/tcp_socket.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const size_t kHandshakeSize = 1536;
+
+using Clock = TcpSocket::Clock;
+
+static void probeOne(IngestProbe &result, Clock::time_point deadline)
+{
+	std::string host;
+	int port = 0;
+	if (!IngestProber::parseRtmpUrl(result.target.addr, host, port)) {
+		result.error = "无效的推流地址";
+		return;
+	}
+
+	TcpSocket socket;
+	auto started = Clock::now();
+	if (!socket.connect(host, port, deadline, result.error))
+		return;
+	result.connect_ms = TcpSocket::msSince(started);
+
+	// C0（版本 3）+ C1（4 字节时间 + 4 字节 0 + 1528 字节随机数，测速只需要长度正确）
+	std::string c0c1(1 + kHandshakeSize, '\0');
+	c0c1[0] = 3;
+	for (size_t i = 9; i < c0c1.size(); ++i)
+		c0c1[i] = static_cast<char>(i * 131);
+
+	started = Clock::now();
+	if (!socket.sendAll(c0c1.data(), c0c1.size(), deadline)) {
+		result.error = "发送握手超时";
+		return;
+	}
+
+	char s0 = 0;
+	if (!socket.recvAll(&s0, 1, deadline)) {
+		result.error = "握手超时";
+		return;
+	}
+	if (s0 != 3) {
+		result.error = "握手应答版本错误";
+		return;
+	}
+	result.handshake_ms = TcpSocket::msSince(started);
+	result.healthy = true;
+}
+
+bool IngestProber::parseRtmpUrl(const std::string &url, std::string &host, int &port)
+{
+	static const char scheme[] = "rtmp://";
+	if (url.compare(0, sizeof(scheme) - 1, scheme) != 0)
+		return false;
+	size_t begin = sizeof(scheme) - 1;
+	size_t end = url.find('/', begin);
+	std::string authority = url.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+	port = 1935;
+
+	size_t colon = authority.rfind(':');
+	if (colon != std::string::npos && authority.find(']') == std::string::npos && authority.find(':') == colon) {
+		port = atoi(authority.c_str() + colon + 1);
+		authority.resize(colon);
+	} else if (!authority.empty() && authority[0] == '[') {
+		// [IPv6]:port
+		size_t close = authority.find(']');
+		if (close == std::string::npos)
+			return false;
+		if (close + 1 < authority.size() && authority[close + 1] == ':')
+			port = atoi(authority.c_str() + close + 2);
+		authority = authority.substr(1, close - 1);
+	}
+	host = authority;
+	return !host.empty() && port > 0 && port < 65536;
+}
+
+std::vector<IngestProbe> IngestProber::probe(const std::vector<Bili::RtmpInfo> &targets, int timeoutMs)
+{
+	std::vector<IngestProbe> results(targets.size());
+	std::vector<std::thread> threads;
+	auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+	for (size_t i = 0; i < targets.size(); ++i) {
+		results[i].target = targets[i];
+		threads.emplace_back(probeOne, std::ref(results[i]), deadline);
+	}
+	for (auto &thread : threads)
+		thread.join();
+	return results;
+}
+
+int IngestProber::pickFastest(const std::vector<IngestProbe> &results)
+{
+	int best = -1;
+	for (size_t i = 0; i < results.size(); ++i) {
+		if (!results[i].healthy)
+			continue;
+		if (best < 0 || results[i].connect_ms + results[i].handshake_ms <
+					results[size_t(best)].connect_ms + results[size_t(best)].handshake_ms)
+			best = int(i);
+	}
+	return best;
+}
+
+void IngestProber::selectFastest(const std::vector<Bili::RtmpInfo> &candidates, Bili::RtmpInfo &chosen,
+				 int timeoutMs, std::vector<Bili::RtmpInfo> *backups)
+{
+	if (backups)
+		backups->clear();
+	if (candidates.size() < 2)
+		return;
+
+	auto started = Clock::now();
+	auto results = probe(candidates, timeoutMs);
+	for (const auto &result : results) {
+		obs_log(LOG_INFO, "推流节点测速: %s 建连 %d ms，握手 %d ms %s", result.target.addr.c_str(),
+			result.connect_ms, result.handshake_ms, result.error.c_str());
+	}
+	int best = pickFastest(results);
+	if (best < 0) {
+		obs_log(LOG_WARNING, "推流节点测速全部失败，使用默认节点");
+		return;
+	}
+	chosen = results[size_t(best)].target;
+	obs_log(LOG_INFO, "选择推流节点: %s（测速耗时 %d ms）", chosen.addr.c_str(), TcpSocket::msSince(started));
+
+	if (!backups)
+		return;
+	results.erase(results.begin() + best);
+	while (true) {
+		int next = pickFastest(results);
+		if (next < 0)
+			break;
+		backups->push_back(results[size_t(next)].target);
+		results.erase(results.begin() + next);
+	}
+}
+} // namespace Core
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "bilibili_schema.hpp"
+
+namespace Core {
+struct IngestProbe {
+	Bili::RtmpInfo target;
+	bool healthy = false;  // TCP 连接成功且收到 RTMP 握手应答 S0
+	int connect_ms = -1;   // TCP 建连耗时
+	int handshake_ms = -1; // 发出 C0+C1 到收到 S0 的耗时
+	std::string error;
+};
+
+// 推流节点测速：对每个候选节点并行做 TCP 建连和 RTMP 握手（C0+C1 → S0），整体受 timeoutMs 限制
+class IngestProber {
+public:
+	// rtmp://host[:port]/app/ → host, port（默认 1935）
+	static bool parseRtmpUrl(const std::string &url, std::string &host, int &port);
+
+	static std::vector<IngestProbe> probe(const std::vector<Bili::RtmpInfo> &targets, int timeoutMs);
+	// 握手最快的健康节点下标；全部失败时返回 -1
+	static int pickFastest(const std::vector<IngestProbe> &results);
+	// 测速并把 chosen 换成最快的健康节点；只有一个候选或全部失败时保持接口默认节点。
+	// backups 非空时按延迟从低到高填入其余健康节点
+	static void selectFastest(const std::vector<Bili::RtmpInfo> &candidates, Bili::RtmpInfo &chosen,
+				  int timeoutMs, std::vector<Bili::RtmpInfo> *backups = nullptr);
+};
+} // namespace Core
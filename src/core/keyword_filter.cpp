@@ -0,0 +1,117 @@
+#include "core/keyword_filter.hpp"
+#include <obs-module.h>
+#include <chrono>
+#include <fstream>
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const auto kWatchInterval = std::chrono::seconds(5);
+
+static std::string trim(const std::string &s)
+{
+	size_t begin = s.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos)
+		return std::string();
+	size_t end = s.find_last_not_of(" \t\r\n");
+	return s.substr(begin, end - begin + 1);
+}
+
+KeywordFilter::KeywordFilter() : m_matcher(KeywordMatcher::compile({})) {}
+
+KeywordFilter::~KeywordFilter()
+{
+	stop();
+}
+
+std::string KeywordFilter::defaultPath()
+{
+	char *path = obs_module_config_path("blocklist.txt");
+	if (!path)
+		return std::string();
+	std::string result = path;
+	bfree(path);
+	return result;
+}
+
+void KeywordFilter::start(const std::string &path)
+{
+	stop();
+	m_path = path;
+	m_mtime = {};
+	m_stop = false;
+	m_thread = std::thread(&KeywordFilter::run, this);
+}
+
+void KeywordFilter::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void KeywordFilter::setPatterns(const std::vector<std::string> &patterns)
+{
+	std::atomic_store(&m_matcher, KeywordMatcher::compile(patterns));
+}
+
+std::shared_ptr<const KeywordMatcher> KeywordFilter::matcher() const
+{
+	return std::atomic_load(&m_matcher);
+}
+
+bool KeywordFilter::matches(std::string_view text)
+{
+	m_checked.fetch_add(1, std::memory_order_relaxed);
+	if (!matcher()->contains(text))
+		return false;
+	m_hits.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool KeywordFilter::reload()
+{
+	std::error_code ec;
+	auto path = std::filesystem::u8path(m_path);
+	auto mtime = std::filesystem::last_write_time(path, ec);
+	if (ec || mtime == m_mtime)
+		return false;
+	m_mtime = mtime;
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		return false;
+	std::vector<std::string> patterns;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (patterns.empty() && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+			line.erase(0, 3);
+		line = trim(line);
+		if (!line.empty() && line[0] != '#')
+			patterns.push_back(std::move(line));
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	auto compiled = KeywordMatcher::compile(patterns);
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+	std::atomic_store(&m_matcher, compiled);
+	obs_log(LOG_INFO, "屏蔽词已加载: %zu 个，编译耗时 %lld ms", compiled->patternCount(),
+		(long long)elapsed.count());
+	return true;
+}
+
+void KeywordFilter::run()
+{
+	// 启动时加载一次，之后按修改时间检测词表变化
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop) {
+		lock.unlock();
+		reload();
+		lock.lock();
+		m_cv.wait_for(lock, kWatchInterval, [this] { return m_stop; });
+	}
+}
+} // namespace Core
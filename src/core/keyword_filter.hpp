@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "core/keyword_matcher.hpp"
+
+namespace Core {
+// 弹幕屏蔽词过滤：词表文件每行一个词（# 开头为注释），修改后自动重新编译。
+// 编译在后台线程完成后整体替换匹配器，匹配端不会因重载而暂停。取匹配器快照用的 std::atomic_load 并非无锁
+// （libstdc++ 按地址分片加自旋锁），但只在拷贝 shared_ptr 的一瞬间持有
+class KeywordFilter {
+public:
+	KeywordFilter();
+	~KeywordFilter();
+
+	// 模块配置目录下的 blocklist.txt
+	static std::string defaultPath();
+
+	void start(const std::string &path);
+	void stop();
+
+	void setPatterns(const std::vector<std::string> &patterns);
+	std::shared_ptr<const KeywordMatcher> matcher() const;
+
+	// 任意线程调用
+	bool matches(std::string_view text);
+	uint64_t checkedCount() const { return m_checked.load(std::memory_order_relaxed); }
+	uint64_t hitCount() const { return m_hits.load(std::memory_order_relaxed); }
+
+private:
+	void run();
+	bool reload();
+
+	std::shared_ptr<const KeywordMatcher> m_matcher;
+
+	std::string m_path;
+	std::filesystem::file_time_type m_mtime;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+
+	std::atomic<uint64_t> m_checked{0};
+	std::atomic<uint64_t> m_hits{0};
+};
+} // namespace Core
@@ -0,0 +1,231 @@
+#include "core/keyword_matcher.hpp"
+#include <algorithm>
+#include <map>
+#include <queue>
+
+namespace Core {
+static const uint32_t kMaxClasses = 0xFFFF;
+
+// 解码一个 UTF-8 码点；非法序列按单字节 U+FFFD 处理，保证总能前进
+static uint32_t decodeUtf8(const uint8_t *&p, const uint8_t *end)
+{
+	uint8_t b0 = *p++;
+	if (b0 < 0x80)
+		return b0;
+
+	int extra;
+	uint32_t cp;
+	if ((b0 & 0xE0) == 0xC0) {
+		extra = 1;
+		cp = b0 & 0x1F;
+	} else if ((b0 & 0xF0) == 0xE0) {
+		extra = 2;
+		cp = b0 & 0x0F;
+	} else if ((b0 & 0xF8) == 0xF0) {
+		extra = 3;
+		cp = b0 & 0x07;
+	} else {
+		return 0xFFFD;
+	}
+	if (end - p < extra)
+		return 0xFFFD;
+	for (int i = 0; i < extra; ++i) {
+		if ((p[i] & 0xC0) != 0x80)
+			return 0xFFFD;
+		cp = (cp << 6) | (p[i] & 0x3F);
+	}
+	p += extra;
+	return cp;
+}
+
+uint32_t KeywordMatcher::fold(uint32_t cp)
+{
+	if (cp >= 0xFF01 && cp <= 0xFF5E)
+		cp -= 0xFEE0; // 全角 ASCII → 半角
+	else if (cp == 0x3000)
+		cp = 0x20;
+	if (cp >= 'A' && cp <= 'Z')
+		cp += 'a' - 'A';
+	return cp;
+}
+
+uint32_t KeywordMatcher::classOf(uint32_t cp) const
+{
+	if (cp < 0x10000)
+		return m_bmpClass[cp];
+	auto it = m_astralClass.find(cp);
+	return it == m_astralClass.end() ? 0 : it->second;
+}
+
+std::shared_ptr<const KeywordMatcher> KeywordMatcher::compile(const std::vector<std::string> &patterns)
+{
+	std::shared_ptr<KeywordMatcher> m(new KeywordMatcher());
+	m->m_bmpClass.assign(0x10000, 0);
+	uint32_t classCount = 1;
+
+	// 先建普通字典树，子节点用有序 map，最后再压平
+	std::vector<std::map<uint32_t, uint32_t>> children(1);
+	std::vector<int32_t> output(1, -1);
+
+	for (const auto &pattern : patterns) {
+		std::vector<uint32_t> classes;
+		const uint8_t *p = reinterpret_cast<const uint8_t *>(pattern.data());
+		const uint8_t *end = p + pattern.size();
+		bool overflow = false;
+		while (p < end) {
+			uint32_t cp = fold(decodeUtf8(p, end));
+			uint32_t cls = m->classOf(cp);
+			if (!cls) {
+				if (classCount >= kMaxClasses) {
+					overflow = true;
+					break;
+				}
+				cls = classCount++;
+				if (cp < 0x10000)
+					m->m_bmpClass[cp] = uint16_t(cls);
+				else
+					m->m_astralClass[cp] = cls;
+			}
+			classes.push_back(cls);
+		}
+		if (overflow || classes.empty())
+			continue;
+
+		uint32_t node = 0;
+		for (uint32_t cls : classes) {
+			auto it = children[node].find(cls);
+			if (it == children[node].end()) {
+				uint32_t next = uint32_t(children.size());
+				children[node].emplace(cls, next);
+				children.emplace_back();
+				output.push_back(-1);
+				node = next;
+			} else {
+				node = it->second;
+			}
+		}
+		if (output[node] >= 0)
+			continue; // 重复的词
+		output[node] = int32_t(m->m_patterns.size());
+		m->m_patterns.push_back(pattern);
+		m->m_patternLength.push_back(uint32_t(classes.size()));
+		m->m_maxLength = std::max(m->m_maxLength, uint32_t(classes.size()));
+	}
+
+	m->m_states.resize(children.size());
+	m->m_rootNext.assign(classCount, 0);
+	for (size_t i = 0; i < children.size(); ++i) {
+		State &s = m->m_states[i];
+		s.output = output[i];
+		s.edgeBegin = uint32_t(m->m_edges.size());
+		s.edgeCount = uint32_t(children[i].size());
+		for (const auto &child : children[i])
+			m->m_edges.push_back({child.first, child.second});
+	}
+	for (const auto &child : children[0])
+		m->m_rootNext[child.first] = child.second;
+
+	// 按层序计算失配链和输出链
+	std::queue<uint32_t> queue;
+	for (const auto &child : children[0])
+		queue.push(child.second);
+	while (!queue.empty()) {
+		uint32_t u = queue.front();
+		queue.pop();
+		for (const auto &child : children[u]) {
+			uint32_t v = child.second;
+			uint32_t f = m->m_states[u].fail;
+			uint32_t target = 0;
+			while (true) {
+				auto it = children[f].find(child.first);
+				if (it != children[f].end()) {
+					target = it->second;
+					break;
+				}
+				if (f == 0)
+					break;
+				f = m->m_states[f].fail;
+			}
+			State &s = m->m_states[v];
+			s.fail = target;
+			const State &fs = m->m_states[target];
+			s.dictLink = fs.output >= 0 ? target : fs.dictLink;
+			queue.push(v);
+		}
+	}
+	return m;
+}
+
+uint32_t KeywordMatcher::step(uint32_t state, uint32_t cls) const
+{
+	if (!cls)
+		return 0;
+	while (state) {
+		const State &s = m_states[state];
+		const Edge *first = m_edges.data() + s.edgeBegin;
+		const Edge *last = first + s.edgeCount;
+		// 非根节点的分支通常很少，线性查找比二分更快
+		for (const Edge *e = first; e != last; ++e) {
+			if (e->cls == cls)
+				return e->target;
+			if (e->cls > cls)
+				break;
+		}
+		state = s.fail;
+	}
+	return m_rootNext[cls];
+}
+
+template<typename F> void KeywordMatcher::run(std::string_view text, F &&onHit) const
+{
+	if (m_patterns.empty())
+		return;
+
+	// 记录最近 m_maxLength 个码点的起始字节，用于还原命中区间
+	thread_local std::vector<size_t> ring;
+	size_t mask = 1;
+	while (mask < m_maxLength)
+		mask <<= 1;
+	if (ring.size() < mask)
+		ring.resize(mask);
+	--mask;
+
+	const uint8_t *begin = reinterpret_cast<const uint8_t *>(text.data());
+	const uint8_t *p = begin;
+	const uint8_t *end = begin + text.size();
+	uint32_t state = 0;
+	size_t index = 0;
+	while (p < end) {
+		ring[index & mask] = size_t(p - begin);
+		state = step(state, classOf(fold(decodeUtf8(p, end))));
+		++index;
+
+		uint32_t s = m_states[state].output >= 0 ? state : m_states[state].dictLink;
+		while (s) {
+			const State &hit = m_states[s];
+			size_t length = m_patternLength[size_t(hit.output)];
+			if (!onHit(size_t(hit.output), ring[(index - length) & mask], size_t(p - begin)))
+				return;
+			s = hit.dictLink;
+		}
+	}
+}
+
+bool KeywordMatcher::contains(std::string_view text) const
+{
+	bool found = false;
+	run(text, [&](size_t, size_t, size_t) {
+		found = true;
+		return false;
+	});
+	return found;
+}
+
+void KeywordMatcher::findAll(std::string_view text, std::vector<KeywordHit> &hits) const
+{
+	run(text, [&](size_t pattern, size_t begin, size_t end) {
+		hits.push_back({pattern, begin, end});
+		return true;
+	});
+}
+} // namespace Core
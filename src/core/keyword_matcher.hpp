@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+struct KeywordHit {
+	size_t pattern = 0; // 词表中的下标
+	size_t begin = 0;   // 原文中的字节区间 [begin, end)
+	size_t end = 0;
+};
+
+// 编译后的多模式匹配器（Aho-Corasick），构建后只读，可在多个线程间共享。
+// 按 UTF-8 码点匹配：全角 ASCII 折叠为半角、全角空格折叠为空格、英文字母不区分大小写
+class KeywordMatcher {
+public:
+	static std::shared_ptr<const KeywordMatcher> compile(const std::vector<std::string> &patterns);
+
+	// 命中任意一个词即返回
+	bool contains(std::string_view text) const;
+	void findAll(std::string_view text, std::vector<KeywordHit> &hits) const;
+
+	size_t patternCount() const { return m_patterns.size(); }
+	const std::string &pattern(size_t index) const { return m_patterns[index]; }
+
+	static uint32_t fold(uint32_t cp);
+
+private:
+	struct State {
+		uint32_t edgeBegin = 0;
+		uint32_t edgeCount = 0;
+		uint32_t fail = 0;
+		uint32_t dictLink = 0; // 沿失配链最近的终止状态，0 表示没有
+		int32_t output = -1;   // 终止状态对应的词下标
+	};
+	struct Edge {
+		uint32_t cls;
+		uint32_t target;
+	};
+
+	KeywordMatcher() = default;
+	uint32_t classOf(uint32_t cp) const;
+	uint32_t step(uint32_t state, uint32_t cls) const;
+	template<typename F> void run(std::string_view text, F &&onHit) const;
+
+	std::vector<std::string> m_patterns;
+	std::vector<uint32_t> m_patternLength; // 码点数
+	uint32_t m_maxLength = 0;
+
+	// 码点 → 字符类；未出现在词表中的码点为类 0
+	std::vector<uint16_t> m_bmpClass;
+	std::unordered_map<uint32_t, uint32_t> m_astralClass;
+
+	std::vector<State> m_states;
+	std::vector<Edge> m_edges;
+	std::vector<uint32_t> m_rootNext; // 根节点分支最多，按字符类直接索引
+};
+} // namespace Core
@@ -0,0 +1,300 @@
+#include "core/live_scheduler.hpp"
+#include <obs-module.h>
+#include <QPointer>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include "json11/json11.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const int64_t kTickMs = 100;
+static const size_t kSlots = 1024;
+static const int64_t kPrewarmMs = 60 * 1000;
+static const int64_t kClockJumpMs = 500;
+static const auto kReloadInterval = std::chrono::seconds(5);
+
+static int64_t steadyMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+static int64_t wallMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+static const char *actionName(ScheduleAction action)
+{
+	switch (action) {
+	case ScheduleAction::Start:
+		return "开播";
+	case ScheduleAction::Stop:
+		return "下播";
+	case ScheduleAction::Title:
+		return "修改标题";
+	case ScheduleAction::Area:
+		return "修改分区";
+	}
+	return "";
+}
+
+LiveScheduler::LiveScheduler(QObject *parent) : QObject(parent), m_wheel(kTickMs, kSlots) {}
+
+LiveScheduler::~LiveScheduler()
+{
+	stop();
+}
+
+std::string LiveScheduler::defaultPath()
+{
+	char *path = obs_module_config_path("schedule.json");
+	std::string result = path ? path : "";
+	bfree(path);
+	return result;
+}
+
+void LiveScheduler::start(const std::string &path)
+{
+	stop();
+	m_path = path;
+	m_mtime = {};
+	m_entries.clear();
+	m_stop = false;
+	m_thread = std::thread(&LiveScheduler::run, this);
+}
+
+void LiveScheduler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool LiveScheduler::parse(const std::string &text, std::vector<ScheduleEntry> &entries, std::string &error)
+{
+	// {"events": [{"action": "start", "time": "20:00", "days": [1, 2, 3, 4, 5]},
+	//             {"action": "title", "time": "21:00:00", "date": "2026-10-20", "title": "..."},
+	//             {"action": "area", "time": "22:00", "part_id": 2, "area_id": 86},
+	//             {"action": "stop", "time": "23:30"}]}
+	json11::Json json = json11::Json::parse(text, error);
+	if (!error.empty())
+		return false;
+
+	entries.clear();
+	for (const auto &item : json["events"].array_items()) {
+		ScheduleEntry entry;
+		const std::string &action = item["action"].string_value();
+		if (action == "start") {
+			entry.action = ScheduleAction::Start;
+		} else if (action == "stop") {
+			entry.action = ScheduleAction::Stop;
+		} else if (action == "title") {
+			entry.action = ScheduleAction::Title;
+			entry.title = item["title"].string_value();
+			if (entry.title.empty()) {
+				error = "title 计划缺少 title";
+				return false;
+			}
+		} else if (action == "area") {
+			entry.action = ScheduleAction::Area;
+			entry.part_id = item["part_id"].int_value();
+			entry.area_id = item["area_id"].int_value();
+			if (!entry.area_id) {
+				error = "area 计划缺少 area_id";
+				return false;
+			}
+		} else {
+			error = "未知的 action: " + action;
+			return false;
+		}
+
+		const std::string &time = item["time"].string_value();
+		int fields = sscanf(time.c_str(), "%d:%d:%d", &entry.hour, &entry.minute, &entry.second);
+		if (fields < 2 || entry.hour < 0 || entry.hour > 23 || entry.minute < 0 || entry.minute > 59 ||
+		    entry.second < 0 || entry.second > 59) {
+			error = "无效的 time: " + time;
+			return false;
+		}
+		const std::string &date = item["date"].string_value();
+		if (!date.empty() && (sscanf(date.c_str(), "%d-%d-%d", &entry.year, &entry.month, &entry.day) != 3 ||
+				      entry.month < 1 || entry.month > 12 || entry.day < 1 || entry.day > 31)) {
+			error = "无效的 date: " + date;
+			return false;
+		}
+		for (const auto &day : item["days"].array_items()) {
+			int value = day.int_value();
+			if (value < 1 || value > 7) {
+				error = "days 只能是 1（周一）到 7（周日）";
+				return false;
+			}
+			entry.days |= uint8_t(1 << (value - 1));
+		}
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
+
+int64_t LiveScheduler::nextOccurrence(const ScheduleEntry &entry, int64_t afterMs)
+{
+	if (entry.year) {
+		std::tm t = {};
+		t.tm_year = entry.year - 1900;
+		t.tm_mon = entry.month - 1;
+		t.tm_mday = entry.day;
+		t.tm_hour = entry.hour;
+		t.tm_min = entry.minute;
+		t.tm_sec = entry.second;
+		t.tm_isdst = -1;
+		int64_t at = int64_t(mktime(&t)) * 1000;
+		return at > afterMs ? at : -1;
+	}
+
+	std::time_t after = std::time_t(afterMs / 1000);
+	std::tm base = {};
+#ifdef _WIN32
+	localtime_s(&base, &after);
+#else
+	localtime_r(&after, &base);
+#endif
+	// 今天起最多看 8 天，足以覆盖任何每周重复的计划
+	for (int offset = 0; offset <= 7; ++offset) {
+		std::tm t = base;
+		t.tm_mday += offset;
+		t.tm_hour = entry.hour;
+		t.tm_min = entry.minute;
+		t.tm_sec = entry.second;
+		t.tm_isdst = -1;
+		int64_t at = int64_t(mktime(&t)) * 1000;
+		int weekday = t.tm_wday == 0 ? 7 : t.tm_wday;
+		if (entry.days && !(entry.days & (1 << (weekday - 1))))
+			continue;
+		if (at > afterMs)
+			return at;
+	}
+	return -1;
+}
+
+bool LiveScheduler::reloadIfChanged()
+{
+	std::error_code ec;
+	auto mtime = std::filesystem::last_write_time(m_path, ec);
+	if (ec) {
+		// 文件被删除：清空计划
+		if (m_entries.empty())
+			return false;
+		m_entries.clear();
+		m_mtime = {};
+		obs_log(LOG_INFO, "直播计划已清空");
+		return true;
+	}
+	if (mtime == m_mtime)
+		return false;
+	m_mtime = mtime;
+
+	std::ifstream in(m_path, std::ios::binary);
+	std::stringstream text;
+	text << in.rdbuf();
+	std::vector<ScheduleEntry> entries;
+	std::string error;
+	if (!parse(text.str(), entries, error)) {
+		// 解析失败时保留旧计划，避免改到一半的文件清空所有计划
+		obs_log(LOG_WARNING, "直播计划解析失败，继续使用旧计划: %s", error.c_str());
+		return false;
+	}
+	m_entries = std::move(entries);
+	obs_log(LOG_INFO, "已加载 %zu 条直播计划", m_entries.size());
+	return true;
+}
+
+void LiveScheduler::post(const ScheduleEntry &entry, bool prewarm)
+{
+	QPointer<LiveScheduler> self(this);
+	QMetaObject::invokeMethod(
+		this,
+		[self, entry, prewarm]() {
+			if (!self)
+				return;
+			if (prewarm)
+				emit self->prewarmDue(entry);
+			else
+				emit self->triggered(entry);
+		},
+		Qt::QueuedConnection);
+}
+
+void LiveScheduler::arm(size_t index, int64_t afterWallMs, int64_t steadyNow)
+{
+	int64_t at = nextOccurrence(m_entries[index], afterWallMs);
+	if (at < 0)
+		return;
+	int64_t deadline = at - m_wallOffset;
+	if (deadline - kPrewarmMs > steadyNow)
+		m_wheel.schedule(deadline - kPrewarmMs, [this, index]() { post(m_entries[index], true); });
+	m_wheel.schedule(deadline, [this, index, at, deadline]() {
+		const auto &entry = m_entries[index];
+		obs_log(LOG_INFO, "执行直播计划: %s（晚于计划 %lld ms）", actionName(entry.action),
+			(long long)(steadyMs() - deadline));
+		post(entry, false);
+		arm(index, at, steadyMs());
+	});
+}
+
+void LiveScheduler::rebuild(int64_t steadyNow, int64_t wallNow)
+{
+	m_wheel.reset(steadyNow);
+	m_wallOffset = wallNow - steadyNow;
+	for (size_t i = 0; i < m_entries.size(); ++i)
+		arm(i, wallNow, steadyNow);
+}
+
+void LiveScheduler::run()
+{
+	auto nextReload = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point epoch{};
+	rebuild(steadyMs(), wallMs());
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop) {
+		// 睡到最近一个定时器到期的绝对时间，醒晚了由 advance 补上；
+		// 没有临近的定时器时最多睡 kReloadInterval，重新检查文件和系统时间
+		auto wake = std::chrono::steady_clock::now() + kReloadInterval;
+		int64_t deadline = m_wheel.nextDeadlineMs();
+		if (deadline >= 0)
+			wake = std::min(wake, epoch + std::chrono::milliseconds(deadline));
+		m_cv.wait_until(lock, wake, [this] { return m_stop.load(); });
+		if (m_stop)
+			break;
+		lock.unlock();
+
+		int64_t now = steadyMs();
+		int64_t wall = wallMs();
+		bool changed = false;
+		if (std::chrono::steady_clock::now() >= nextReload) {
+			nextReload = std::chrono::steady_clock::now() + kReloadInterval;
+			changed = reloadIfChanged();
+		}
+		int64_t jump = (wall - now) - m_wallOffset;
+		if (jump > kClockJumpMs || jump < -kClockJumpMs) {
+			obs_log(LOG_INFO, "系统时间变化 %lld ms，重新排布直播计划", (long long)jump);
+			changed = true;
+		}
+		if (changed)
+			rebuild(now, wall);
+		m_wheel.advance(now);
+
+		lock.lock();
+	}
+}
+} // namespace Core
@@ -0,0 +1,72 @@
+#pragma once
+#include <QObject>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/timer_wheel.hpp"
+
+namespace Core {
+enum class ScheduleAction { Start, Stop, Title, Area };
+
+// schedule.json 中的一条计划，时间为本地时间
+struct ScheduleEntry {
+	ScheduleAction action = ScheduleAction::Start;
+	int hour = 0;
+	int minute = 0;
+	int second = 0;
+	uint8_t days = 0; // bit0 周一 … bit6 周日，0 表示每天
+	int year = 0;     // 非 0 时为一次性计划，只在 year-month-day 执行
+	int month = 0;
+	int day = 0;
+	std::string title;
+	int part_id = 0;
+	int area_id = 0;
+};
+
+// 定时开播 / 下播 / 改标题 / 改分区。
+// 计划按墙上时间计算，换算成单调时钟后放进 100 ms 一格的时间轮；驱动线程睡到最近一个计划到期，
+// 最长 5 秒醒来一次检查文件修改和系统时间校正（校正后重新排布）。
+// 每个计划提前一分钟发出 prewarmDue，到点发出 triggered（均在 UI 线程）
+class LiveScheduler : public QObject {
+	Q_OBJECT
+public:
+	explicit LiveScheduler(QObject *parent = nullptr);
+	~LiveScheduler();
+
+	// 配置目录下的 schedule.json
+	static std::string defaultPath();
+	// 加载计划并启动调度线程；文件修改后自动重新加载
+	void start(const std::string &path);
+	void stop();
+
+	static bool parse(const std::string &text, std::vector<ScheduleEntry> &entries, std::string &error);
+	// afterMs 之后（不含）最近一次执行的时间，Unix 毫秒；没有下一次时返回 -1
+	static int64_t nextOccurrence(const ScheduleEntry &entry, int64_t afterMs);
+
+signals:
+	void prewarmDue(const Core::ScheduleEntry &entry);
+	void triggered(const Core::ScheduleEntry &entry);
+
+private:
+	void run();
+	bool reloadIfChanged();
+	void rebuild(int64_t steadyNow, int64_t wallNow);
+	void arm(size_t index, int64_t afterWallMs, int64_t steadyNow);
+	void post(const ScheduleEntry &entry, bool prewarm);
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::atomic<bool> m_stop{false};
+	std::string m_path;
+	std::filesystem::file_time_type m_mtime;
+	std::vector<ScheduleEntry> m_entries;
+	TimerWheel m_wheel;
+	int64_t m_wallOffset = 0; // 墙上时间 - 单调时钟
+};
+} // namespace Core
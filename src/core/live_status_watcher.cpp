@@ -0,0 +1,96 @@
+#include "core/live_status_watcher.hpp"
+#include <obs-module.h>
+#include <algorithm>
+#include "bilibili_api.hpp"
+#include "http_client.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const auto kFastInterval = std::chrono::seconds(3);
+static const auto kSteadyInterval = std::chrono::seconds(30);
+static const auto kFastWindow = std::chrono::seconds(60);
+
+LiveStatusWatcher::LiveStatusWatcher(QObject *parent) : QObject(parent) {}
+
+LiveStatusWatcher::~LiveStatusWatcher()
+{
+	stop();
+}
+
+void LiveStatusWatcher::start(const std::string &roomId, bool streaming)
+{
+	stop();
+	m_roomId = roomId;
+	m_streaming = streaming;
+	m_stop = false;
+	m_fastUntil = std::chrono::steady_clock::now() + kFastWindow;
+	m_nextPoll = m_fastUntil;
+	m_thread = std::thread(&LiveStatusWatcher::run, this);
+}
+
+void LiveStatusWatcher::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void LiveStatusWatcher::notifyTransition(bool streaming)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_streaming = streaming;
+		++m_generation;
+		auto now = std::chrono::steady_clock::now();
+		m_fastUntil = now + kFastWindow;
+		// 不立即轮询，给服务端一个快速间隔的时间生效
+		m_nextPoll = std::min(m_nextPoll, now + kFastInterval);
+	}
+	m_cv.notify_all();
+}
+
+void LiveStatusWatcher::run()
+{
+	Http::HttpSession session;
+	session.setAbortFlag(&m_stop);
+	std::string etag;
+
+	while (!m_stop) {
+		uint64_t generation;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			generation = m_generation;
+		}
+		int liveStatus = -1;
+		std::string message;
+		bool ok = Bili::BiliApi::getLiveStatus(session, m_roomId, liveStatus, etag, message);
+		if (m_stop)
+			return;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto now = std::chrono::steady_clock::now();
+		if (generation != m_generation) {
+			// 请求发出后本地刚开播 / 下播，返回的可能还是旧状态
+		} else if (!ok) {
+			obs_log(LOG_WARNING, "直播间状态轮询失败: %s", message.c_str());
+		} else if (liveStatus >= 0) {
+			// 轮播（2）不算我们在推流
+			bool streaming = liveStatus == 1;
+			if (streaming != m_streaming) {
+				obs_log(LOG_INFO, "直播间状态变化: %s", streaming ? "直播中" : "未开播");
+				m_streaming = streaming;
+				m_fastUntil = now + kFastWindow;
+				emit liveStatusChanged(streaming);
+			}
+		}
+
+		m_nextPoll = now + (now < m_fastUntil ? kFastInterval : kSteadyInterval);
+		while (!m_stop && std::chrono::steady_clock::now() < m_nextPoll)
+			m_cv.wait_until(lock, m_nextPoll);
+	}
+}
+} // namespace Core
@@ -0,0 +1,40 @@
+#pragma once
+#include <QObject>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Core {
+// 后台轮询直播间开播状态：状态切换前后快速轮询，稳定后降为慢速
+class LiveStatusWatcher : public QObject {
+	Q_OBJECT
+public:
+	explicit LiveStatusWatcher(QObject *parent = nullptr);
+	~LiveStatusWatcher();
+
+	void start(const std::string &roomId, bool streaming);
+	void stop();
+	// 本地刚发起开播 / 下播，短时间内加快轮询以尽快确认服务端状态
+	void notifyTransition(bool streaming);
+
+signals:
+	void liveStatusChanged(bool streaming);
+
+private:
+	void run();
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::atomic<bool> m_stop{false};
+	std::string m_roomId;
+	bool m_streaming = false;
+	uint64_t m_generation = 0; // 每次 notifyTransition 加一，早于它发出的轮询结果作废
+	std::chrono::steady_clock::time_point m_fastUntil;
+	std::chrono::steady_clock::time_point m_nextPoll;
+};
+} // namespace Core
@@ -0,0 +1,233 @@
+#include "core/output_health.hpp"
+#include <obs-module.h>
+#include <chrono>
+#include "plugin_utils.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace Core {
+static const int64_t kHistoryMs = 60000;
+static const int64_t kBitrateWindowMs = 5000;
+static const int64_t kDropWindowMs = 10000;
+static const int64_t kTrendWindowMs = 30000;
+static const int kDrainIntervalMs = 1000;
+
+static int64_t steadyMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+// 当前线程累计占用的 CPU 时间
+static int64_t threadCpuNs()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+	auto toNs = [](const FILETIME &ft) {
+		return (int64_t(ft.dwHighDateTime) << 32 | ft.dwLowDateTime) * 100;
+	};
+	return toNs(kernel) + toNs(user);
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+OutputHealthMonitor::OutputHealthMonitor(QObject *parent, int sampleIntervalMs)
+	: QObject(parent),
+	  m_intervalMs(sampleIntervalMs),
+	  m_ring(256)
+{
+	connect(&m_timer, &QTimer::timeout, this, &OutputHealthMonitor::drain);
+	obs_frontend_add_event_callback(&OutputHealthMonitor::onFrontendEvent, this);
+}
+
+OutputHealthMonitor::~OutputHealthMonitor()
+{
+	obs_frontend_remove_event_callback(&OutputHealthMonitor::onFrontendEvent, this);
+	stop();
+	setOutput(nullptr);
+}
+
+void OutputHealthMonitor::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	auto *self = static_cast<OutputHealthMonitor *>(data);
+	if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED) {
+		obs_output_t *output = obs_frontend_get_streaming_output();
+		self->setOutput(output);
+		obs_output_release(output);
+	} else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED) {
+		self->setOutput(nullptr);
+	}
+}
+
+// UI 线程调用
+void OutputHealthMonitor::setOutput(obs_output_t *output)
+{
+	obs_weak_output_t *weak = output ? obs_output_get_weak_output(output) : nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::swap(m_output, weak);
+	}
+	if (weak)
+		obs_weak_output_release(weak);
+}
+
+void OutputHealthMonitor::start()
+{
+	if (m_thread.joinable())
+		return;
+	// 插件加载时可能已经在推流，之后的变化由前端事件跟踪
+	if (obs_frontend_streaming_active()) {
+		obs_output_t *output = obs_frontend_get_streaming_output();
+		setOutput(output);
+		obs_output_release(output);
+	}
+	m_stop = false;
+	m_thread = std::thread(&OutputHealthMonitor::run, this);
+	m_timer.start(kDrainIntervalMs);
+}
+
+void OutputHealthMonitor::stop()
+{
+	m_timer.stop();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void OutputHealthMonitor::run()
+{
+	const auto interval = std::chrono::milliseconds(m_intervalMs);
+	auto next = std::chrono::steady_clock::now();
+	const int64_t startCpu = threadCpuNs();
+	const auto startWall = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stop) {
+		// 弱引用由 UI 线程替换，这里只把它升级为强引用
+		obs_output_t *output = m_output ? obs_weak_output_get_output(m_output) : nullptr;
+		lock.unlock();
+
+		OutputSample sample;
+		sample.time_ms = steadyMs();
+		if (output) {
+			sample.active = obs_output_active(output);
+			sample.total_bytes = obs_output_get_total_bytes(output);
+			sample.dropped_frames = obs_output_get_frames_dropped(output);
+			sample.total_frames = obs_output_get_total_frames(output);
+			sample.congestion = obs_output_get_congestion(output);
+			sample.connect_time_ms = obs_output_get_connect_time_ms(output);
+			obs_output_release(output);
+		}
+		// 队列满说明 UI 线程卡住了，丢掉这次采样即可
+		m_ring.tryPush(std::move(sample));
+
+		m_cpuNs.store(threadCpuNs() - startCpu, std::memory_order_relaxed);
+		m_wallNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+										 startWall)
+				       .count(),
+			       std::memory_order_relaxed);
+
+		// 按绝对时间推进，采样间隔不受单次耗时影响
+		next += interval;
+		lock.lock();
+		m_cv.wait_until(lock, next, [this] { return m_stop; });
+	}
+}
+
+void OutputHealthMonitor::drain()
+{
+	bool any = false;
+	m_ring.drain(
+		[&](OutputSample &sample) {
+			// 总字节数回退说明输出重新连接过，之前的历史不再可比
+			if (!m_history.empty() && sample.total_bytes < m_history.back().total_bytes)
+				m_history.clear();
+			m_history.push_back(sample);
+			any = true;
+		},
+		m_ring.capacity());
+	if (!any)
+		return;
+	while (!m_history.empty() && m_history.back().time_ms - m_history.front().time_ms > kHistoryMs)
+		m_history.pop_front();
+
+	recompute();
+	emit healthUpdated(m_health);
+}
+
+void OutputHealthMonitor::recompute()
+{
+	OutputHealth health;
+	const OutputSample &last = m_history.back();
+	health.active = last.active;
+	health.dropped_frames = last.dropped_frames;
+	health.total_frames = last.total_frames;
+	health.congestion = last.congestion;
+	health.connect_time_ms = last.connect_time_ms;
+
+	int64_t wallNs = m_wallNs.load(std::memory_order_relaxed);
+	if (wallNs > 0)
+		health.sampler_cpu = 100.0 * double(m_cpuNs.load(std::memory_order_relaxed)) / double(wallNs);
+
+	auto since = [&](int64_t windowMs) -> const OutputSample & {
+		for (const auto &sample : m_history) {
+			if (last.time_ms - sample.time_ms <= windowMs)
+				return sample;
+		}
+		return last;
+	};
+
+	if (last.active) {
+		const OutputSample &first = since(kBitrateWindowMs);
+		if (last.time_ms > first.time_ms)
+			health.bitrate_kbps = double(last.total_bytes - first.total_bytes) * 8.0 /
+					      double(last.time_ms - first.time_ms);
+
+		const OutputSample &dropFrom = since(kDropWindowMs);
+		int frames = last.total_frames - dropFrom.total_frames;
+		if (frames > 0)
+			health.drop_rate = 100.0 * double(last.dropped_frames - dropFrom.dropped_frames) / double(frames);
+
+		// 相邻采样求瞬时码率，再对时间做最小二乘
+		double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+		const OutputSample *prev = nullptr;
+		for (const auto &sample : m_history) {
+			if (last.time_ms - sample.time_ms > kTrendWindowMs) {
+				continue;
+			}
+			if (prev && sample.time_ms > prev->time_ms) {
+				double x = double(sample.time_ms - last.time_ms) / 1000.0;
+				double y = double(sample.total_bytes - prev->total_bytes) * 8.0 /
+					   double(sample.time_ms - prev->time_ms);
+				n += 1;
+				sx += x;
+				sy += y;
+				sxx += x * x;
+				sxy += x * y;
+			}
+			prev = &sample;
+		}
+		double denom = n * sxx - sx * sx;
+		if (n >= 3 && denom > 0)
+			health.trend_kbps_per_s = (n * sxy - sx * sy) / denom;
+	}
+
+	m_health = health;
+}
+} // namespace Core
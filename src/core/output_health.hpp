@@ -0,0 +1,76 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <obs-frontend-api.h>
+#include <thread>
+#include "core/spsc_ring.hpp"
+
+namespace Core {
+// 推流输出的一次原始采样
+struct OutputSample {
+	int64_t time_ms = 0; // steady_clock
+	bool active = false;
+	uint64_t total_bytes = 0;
+	int dropped_frames = 0;
+	int total_frames = 0;
+	float congestion = 0.0f;
+	int connect_time_ms = 0;
+};
+
+struct OutputHealth {
+	bool active = false;
+	double bitrate_kbps = 0.0;    // 最近 5 秒
+	double drop_rate = 0.0;       // 最近 10 秒丢帧百分比
+	int dropped_frames = 0;       // 本次推流累计
+	int total_frames = 0;
+	double congestion = 0.0;      // 0 ~ 1
+	int connect_time_ms = 0;
+	double trend_kbps_per_s = 0.0; // 最近 30 秒码率的线性回归斜率
+	double sampler_cpu = 0.0;     // 采样线程自身的 CPU 占用百分比
+};
+
+// 在后台线程以固定频率读取 OBS 推流输出的统计，经无锁环形队列交给 UI 线程计算码率、丢帧率和趋势。
+// 推流输出只在 UI 线程上随开始 / 停止推流事件获取，采样线程持有它的弱引用，不调用前端 API
+class OutputHealthMonitor : public QObject {
+	Q_OBJECT
+public:
+	explicit OutputHealthMonitor(QObject *parent = nullptr, int sampleIntervalMs = 500);
+	~OutputHealthMonitor();
+
+	void start();
+	void stop();
+
+	// UI 线程查询
+	const OutputHealth &current() const { return m_health; }
+	const std::deque<OutputSample> &history() const { return m_history; }
+
+signals:
+	void healthUpdated(const Core::OutputHealth &health);
+
+private:
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	void setOutput(obs_output_t *output);
+	void run();
+	void drain();
+	void recompute();
+
+	int m_intervalMs;
+	SpscRing<OutputSample> m_ring;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+	obs_weak_output_t *m_output = nullptr; // m_mutex 保护
+	std::atomic<int64_t> m_cpuNs{0};
+	std::atomic<int64_t> m_wallNs{0};
+
+	QTimer m_timer;
+	std::deque<OutputSample> m_history;
+	OutputHealth m_health;
+};
+} // namespace Core
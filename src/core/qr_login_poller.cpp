@@ -0,0 +1,89 @@
+#include "core/qr_login_poller.hpp"
+#include <algorithm>
+#include <chrono>
+#include "bilibili_api.hpp"
+#include "http_client.hpp"
+
+namespace Core {
+static const int kWaitingIntervalMs = 2000;   // 未扫码：慢速轮询
+static const int kScannedIntervalMs = 500;    // 已扫码等待确认：快速轮询
+static const int kMaxErrorIntervalMs = 8000;  // 网络错误退避上限
+static const auto kQrLifetime = std::chrono::seconds(180);
+
+QrLoginPoller::QrLoginPoller(const std::string &qrKey, QObject *parent) : QObject(parent), m_qrKey(qrKey) {}
+
+QrLoginPoller::~QrLoginPoller()
+{
+	stop();
+}
+
+void QrLoginPoller::start()
+{
+	if (m_thread.joinable())
+		return;
+	m_stop = false;
+	m_thread = std::thread(&QrLoginPoller::run, this);
+}
+
+void QrLoginPoller::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool QrLoginPoller::waitFor(int ms)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return !m_cv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return m_stop.load(); });
+}
+
+void QrLoginPoller::run()
+{
+	Http::HttpSession session;
+	session.setAbortFlag(&m_stop);
+	const auto deadline = std::chrono::steady_clock::now() + kQrLifetime;
+	int lastCode = -2;
+	int errorInterval = kWaitingIntervalMs;
+
+	while (true) {
+		if (std::chrono::steady_clock::now() >= deadline) {
+			emit expired(QString::fromUtf8("二维码已过期，请重新打开"));
+			return;
+		}
+
+		std::string cookies, message, refreshToken;
+		int code = Bili::BiliApi::pollQrLogin(session, m_qrKey, cookies, message, &refreshToken);
+		if (m_stop)
+			return;
+		if (code != lastCode) {
+			lastCode = code;
+			emit stateChanged(code, QString::fromUtf8(message.c_str()));
+		}
+
+		int interval = kWaitingIntervalMs;
+		if (code == 0) {
+			emit succeeded(QString::fromStdString(cookies), QString::fromStdString(refreshToken));
+			return;
+		} else if (code == 86038) {
+			emit expired(QString::fromUtf8(message.c_str()));
+			return;
+		} else if (code == 86090) {
+			interval = kScannedIntervalMs;
+			errorInterval = kWaitingIntervalMs;
+		} else if (code == -1) {
+			interval = errorInterval;
+			errorInterval = std::min(errorInterval * 2, kMaxErrorIntervalMs);
+		} else {
+			errorInterval = kWaitingIntervalMs;
+		}
+
+		if (!waitFor(interval))
+			return;
+	}
+}
+} // namespace Core
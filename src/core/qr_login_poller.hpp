@@ -0,0 +1,36 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Core {
+// 在后台线程轮询扫码登录状态，复用同一条 HTTPS 连接，并按状态调整轮询间隔
+class QrLoginPoller : public QObject {
+	Q_OBJECT
+public:
+	explicit QrLoginPoller(const std::string &qrKey, QObject *parent = nullptr);
+	~QrLoginPoller();
+
+	void start();
+	void stop();
+
+signals:
+	void stateChanged(int code, const QString &message);
+	void succeeded(const QString &cookies, const QString &refreshToken);
+	void expired(const QString &message);
+
+private:
+	void run();
+	bool waitFor(int ms);
+
+	std::string m_qrKey;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::atomic<bool> m_stop{false};
+};
+} // namespace Core
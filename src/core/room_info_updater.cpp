@@ -0,0 +1,139 @@
+#include "core/room_info_updater.hpp"
+#include <obs-module.h>
+#include <QPointer>
+#include <QStringList>
+#include "bilibili_api.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+RoomInfoUpdater::RoomInfoUpdater(ConfigManager &config, QObject *parent, int debounceMs)
+	: QObject(parent), m_config(config)
+{
+	m_timer.setSingleShot(true);
+	m_timer.setInterval(debounceMs);
+	connect(&m_timer, &QTimer::timeout, this, &RoomInfoUpdater::flush);
+}
+
+void RoomInfoUpdater::setTitle(const std::string &title)
+{
+	retarget();
+	m_pendingTitle = title;
+	schedule();
+}
+
+void RoomInfoUpdater::setArea(int partId, int areaId)
+{
+	retarget();
+	m_pendingPartId = partId;
+	m_pendingAreaId = areaId;
+	schedule();
+}
+
+void RoomInfoUpdater::flushNow()
+{
+	m_timer.stop();
+	flush();
+}
+
+Bili::Config *RoomInfoUpdater::findAccount(const std::string &roomId)
+{
+	if (roomId.empty())
+		return nullptr;
+	for (size_t i = 0; i < m_config.accountCount(); ++i) {
+		if (m_config.account(i).room_id == roomId)
+			return &m_config.account(i);
+	}
+	return nullptr;
+}
+
+void RoomInfoUpdater::retarget()
+{
+	const std::string &roomId = m_config.config().room_id;
+	if (roomId == m_pendingRoomId)
+		return;
+	// 还有别的直播间的修改没提交：能提交就立即提交，正在等上一次请求时只能丢弃
+	if (hasPending() && !m_inFlight) {
+		flushNow();
+	} else if (hasPending()) {
+		obs_log(LOG_WARNING, "切换了直播间，丢弃直播间 %s 未提交的修改", m_pendingRoomId.c_str());
+		m_pendingTitle.clear();
+		m_pendingPartId = 0;
+		m_pendingAreaId = 0;
+	}
+	m_pendingRoomId = roomId;
+}
+
+void RoomInfoUpdater::schedule()
+{
+	// 每次修改都重新计时，连续点击只会在最后一次之后提交
+	if (!m_inFlight)
+		m_timer.start();
+}
+
+void RoomInfoUpdater::flush()
+{
+	if (m_inFlight || !hasPending())
+		return;
+
+	// 提交给修改时选中的直播间；账号已被移除时丢弃
+	const Bili::Config *account = findAccount(m_pendingRoomId);
+	std::string roomId = m_pendingRoomId;
+	Bili::RoomInfoUpdate update;
+	update.title = std::move(m_pendingTitle);
+	update.area_id = m_pendingAreaId;
+	int partId = m_pendingPartId;
+	m_pendingTitle.clear();
+	m_pendingPartId = 0;
+	m_pendingAreaId = 0;
+	if (!account)
+		return;
+	m_inFlight = true;
+
+	QPointer<RoomInfoUpdater> self(this);
+	Bili::BiliApi::updateRoomInfoAsync(*account, update,
+					   [self, roomId, update, partId](bool ok, const std::string &message) {
+						   // 回调在 HTTP 工作线程上，切回 UI 线程处理
+						   QMetaObject::invokeMethod(
+							   self,
+							   [self, roomId, ok, message, update, partId]() {
+								   if (self)
+									   self->onResult(roomId, ok, message,
+											  update.title, partId,
+											  update.area_id);
+							   },
+							   Qt::QueuedConnection);
+					   });
+}
+
+void RoomInfoUpdater::onResult(const std::string &roomId, bool ok, const std::string &message,
+			       const std::string &title, int partId, int areaId)
+{
+	m_inFlight = false;
+
+	QString summary;
+	// 请求期间账号可能被移除，按房间号找回提交时的账号
+	Bili::Config *account = ok ? findAccount(roomId) : nullptr;
+	if (account) {
+		auto &cfg = *account;
+		QStringList changed;
+		if (!title.empty()) {
+			cfg.title = title;
+			changed << QString::fromUtf8("标题");
+		}
+		if (areaId) {
+			cfg.part_id = partId;
+			cfg.area_id = areaId;
+			changed << QString::fromUtf8("分区");
+		}
+		m_config.save();
+		summary = QString::fromUtf8("直播间%1已更新").arg(changed.join(QString::fromUtf8("和")));
+	} else {
+		summary = ok ? QString::fromUtf8("直播间已更新") : QString::fromUtf8(message.c_str());
+	}
+	emit finished(ok, summary);
+
+	// 请求期间又有新的修改，继续提交
+	if (hasPending())
+		m_timer.start();
+}
+} // namespace Core
@@ -0,0 +1,41 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <string>
+#include "core/config_manager.hpp"
+
+namespace Core {
+// 合并短时间内的标题 / 分区修改，防抖后只发一次 Room/update
+class RoomInfoUpdater : public QObject {
+	Q_OBJECT
+public:
+	explicit RoomInfoUpdater(ConfigManager &config, QObject *parent = nullptr, int debounceMs = 800);
+
+	// 修改作用于调用时选中的直播间，之后切换账号也不会提交或写回到别的直播间
+	void setTitle(const std::string &title);
+	void setArea(int partId, int areaId);
+	// 跳过防抖立即提交（定时计划要求准点生效）
+	void flushNow();
+
+signals:
+	void finished(bool ok, const QString &message);
+
+private:
+	void retarget();
+	void schedule();
+	void flush();
+	void onResult(const std::string &roomId, bool ok, const std::string &message, const std::string &title,
+		      int partId, int areaId);
+	bool hasPending() const { return !m_pendingTitle.empty() || m_pendingAreaId; }
+	Bili::Config *findAccount(const std::string &roomId);
+
+	ConfigManager &m_config;
+	QTimer m_timer;
+	std::string m_pendingRoomId;
+	std::string m_pendingTitle;
+	int m_pendingPartId = 0;
+	int m_pendingAreaId = 0;
+	bool m_inFlight = false;
+};
+} // namespace Core
@@ -0,0 +1,166 @@
+#include "core/session_keeper.hpp"
+#include <obs-module.h>
+#include <QPointer>
+#include <chrono>
+#include <ctime>
+#include "bilibili_api.hpp"
+#include "http_client.hpp"
+#include "plugin_utils.hpp"
+
+namespace Core {
+// SESSDATA 有效期约半年，提前 3 天刷新；后台每几个小时检查一次，足以在过期前完成
+static const int64_t kRefreshAheadS = 3 * 24 * 3600;
+// 刷新要连续发几个请求，每个最长 10 秒；后台等得起，开播前只等一小会儿
+static const int kBackgroundWaitMs = 60 * 1000;
+static const int kGoLiveWaitMs = 3000;
+
+SessionKeeper::SessionKeeper(QObject *parent) : QObject(parent) {}
+
+SessionKeeper::~SessionKeeper()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+	if (m_goLiveThread.joinable())
+		m_goLiveThread.join();
+}
+
+bool SessionKeeper::expiresWithin(const std::string &cookies, int64_t seconds)
+{
+	int64_t expiry = Bili::BiliApi::sessionExpiry(cookies);
+	return expiry > 0 && expiry - int64_t(time(nullptr)) < seconds;
+}
+
+bool SessionKeeper::renew(Http::HttpSession &session, const SessionCredentials &account, SessionRenewal &renewal,
+			  int waitMs)
+{
+	renewal.old_cookies = account.cookies;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	bool idle = m_cv.wait_for(lock, std::chrono::milliseconds(waitMs),
+				  [&] { return m_stop || !m_refreshing.count(account.cookies); });
+	if (!idle || m_stop) {
+		renewal.message = m_stop ? "已取消" : "登录正在后台刷新，等待超时";
+		return false;
+	}
+	// 另一条路径已经刷新过这份 cookies，旧的 refresh_token 已失效，直接复用结果
+	auto it = m_renewed.find(account.cookies);
+	if (it != m_renewed.end()) {
+		renewal = it->second;
+		return true;
+	}
+	m_refreshing.insert(account.cookies);
+	lock.unlock();
+
+	renewal.ok = Bili::BiliApi::refreshCookies(session, account.cookies, account.refresh_token, renewal.cookies,
+						   renewal.refresh_token, renewal.message);
+
+	lock.lock();
+	m_refreshing.erase(account.cookies);
+	if (renewal.ok)
+		m_renewed[account.cookies] = renewal;
+	lock.unlock();
+	m_cv.notify_all();
+	return renewal.ok;
+}
+
+void SessionKeeper::check(const std::vector<SessionCredentials> &accounts)
+{
+	if (m_busy)
+		return;
+	if (m_thread.joinable())
+		m_thread.join();
+	m_busy = true;
+
+	m_thread = std::thread([this, accounts]() {
+		Http::HttpSession session;
+		session.setAbortFlag(&m_stop);
+		std::vector<SessionRenewal> results;
+		for (const auto &account : accounts) {
+			if (m_stop)
+				return;
+			if (account.cookies.empty())
+				continue;
+			bool nearExpiry = expiresWithin(account.cookies, kRefreshAheadS);
+			bool serverAsks = false;
+			std::string message;
+			if (!Bili::BiliApi::getCookieInfo(session, account.cookies, serverAsks, message))
+				obs_log(LOG_INFO, "%s", message.c_str());
+			if (!nearExpiry && !serverAsks)
+				continue;
+			if (account.refresh_token.empty()) {
+				obs_log(LOG_WARNING, "登录即将过期，但没有 refresh_token，请重新扫码登录");
+				continue;
+			}
+			SessionRenewal renewal;
+			renew(session, account, renewal, kBackgroundWaitMs);
+			results.push_back(std::move(renewal));
+		}
+		if (m_stop)
+			return;
+
+		QPointer<SessionKeeper> self(this);
+		QMetaObject::invokeMethod(
+			this,
+			[self, results = std::move(results)]() {
+				if (!self)
+					return;
+				self->m_busy = false;
+				for (const auto &renewal : results)
+					emit self->renewed(renewal);
+			},
+			Qt::QueuedConnection);
+	});
+}
+
+bool SessionKeeper::ensureFresh(const SessionCredentials &account, int64_t marginS)
+{
+	if (m_goLiveBusy)
+		return false;
+	if (account.cookies.empty() || !expiresWithin(account.cookies, marginS)) {
+		// 无需刷新，不起线程；仍然排队回调，调用方只需处理一种时序
+		QPointer<SessionKeeper> self(this);
+		QMetaObject::invokeMethod(
+			this,
+			[self]() {
+				if (self)
+					emit self->goLiveChecked(true, SessionRenewal());
+			},
+			Qt::QueuedConnection);
+		return true;
+	}
+	if (m_goLiveThread.joinable())
+		m_goLiveThread.join();
+	m_goLiveBusy = true;
+
+	// 刷新要连续发几个请求，再加上最多 kGoLiveWaitMs 的等待，不能放在 UI 线程上
+	m_goLiveThread = std::thread([this, account]() {
+		Http::HttpSession session;
+		session.setAbortFlag(&m_stop);
+		SessionRenewal renewal;
+		bool fresh = renew(session, account, renewal, kGoLiveWaitMs);
+		if (!fresh) {
+			obs_log(LOG_WARNING, "开播前刷新登录失败: %s", renewal.message.c_str());
+			// 还没真正过期时仍可继续开播
+			fresh = !expiresWithin(account.cookies, 0);
+		}
+		if (m_stop)
+			return;
+
+		QPointer<SessionKeeper> self(this);
+		QMetaObject::invokeMethod(
+			this,
+			[self, fresh, renewal = std::move(renewal)]() {
+				if (!self)
+					return;
+				self->m_goLiveBusy = false;
+				emit self->goLiveChecked(fresh, renewal);
+			},
+			Qt::QueuedConnection);
+	});
+	return true;
+}
+} // namespace Core
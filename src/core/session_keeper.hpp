@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Http {
+class HttpSession;
+}
+
+namespace Core {
+struct SessionCredentials {
+	std::string cookies;
+	std::string refresh_token;
+};
+
+struct SessionRenewal {
+	std::string old_cookies; // 回到 UI 线程后按旧 cookies 找回对应账号
+	std::string cookies;
+	std::string refresh_token;
+	bool ok = false;
+	std::string message;
+};
+
+// 会话保活：SESSDATA 临近过期或服务端要求刷新时，用 refresh_token 换取新的 cookies。
+// 后台检查与开播前的同步检查可能同时要刷新同一份 cookies，而 refresh_token 只能用一次：
+// 先发起的一方标记为刷新中，另一方在条件变量上等待并复用其结果。锁只保护这些标记，不跨网络请求持有
+class SessionKeeper : public QObject {
+	Q_OBJECT
+public:
+	explicit SessionKeeper(QObject *parent = nullptr);
+	~SessionKeeper();
+
+	// 在后台线程检查一组账号；上一轮尚未结束时忽略本次调用
+	void check(const std::vector<SessionCredentials> &accounts);
+	// 开播前检查：会话将在 marginS 秒内过期时在工作线程上立即刷新，后台正在刷新时最多等待几秒。
+	// 结果通过 goLiveChecked 返回；上一次开播前检查尚未结束时忽略本次调用并返回 false
+	bool ensureFresh(const SessionCredentials &account, int64_t marginS);
+
+	// SESSDATA 是否会在 seconds 秒内过期；无法得知过期时间时返回 false
+	static bool expiresWithin(const std::string &cookies, int64_t seconds);
+
+signals:
+	// 在 UI 线程上发出，每次尝试刷新（无论成败）一次
+	void renewed(const Core::SessionRenewal &renewal);
+	// 在 UI 线程上发出。fresh 为 false 表示会话已过期且无法刷新；刷新成功时 renewal.ok 为 true
+	void goLiveChecked(bool fresh, const Core::SessionRenewal &renewal);
+
+private:
+	// 另一方正在刷新同一份 cookies 时最多等待 waitMs；超时返回 false
+	bool renew(Http::HttpSession &session, const SessionCredentials &account, SessionRenewal &renewal,
+		   int waitMs);
+
+	std::thread m_thread;
+	std::thread m_goLiveThread;
+	std::atomic<bool> m_stop{false};
+	bool m_busy = false;
+	bool m_goLiveBusy = false;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::set<std::string> m_refreshing;              // 正在刷新的旧 cookies
+	std::map<std::string, SessionRenewal> m_renewed; // 旧 cookies -> 刷新结果
+};
+} // namespace Core
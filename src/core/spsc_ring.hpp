@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Core {
+// 单生产者 / 单消费者无锁环形队列。容量向上取整到 2 的幂；满时 tryPush 返回 false，由调用方决定丢弃还是重试
+template<typename T> class SpscRing {
+public:
+	explicit SpscRing(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+		m_slots.resize(size);
+		m_mask = size - 1;
+	}
+
+	SpscRing(const SpscRing &) = delete;
+	SpscRing &operator=(const SpscRing &) = delete;
+
+	size_t capacity() const { return m_slots.size(); }
+
+	// 生产者线程
+	bool tryPush(T &&value)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_cachedHead == m_slots.size()) {
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			if (tail - m_cachedHead == m_slots.size())
+				return false;
+		}
+		m_slots[tail & m_mask] = std::move(value);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// 消费者线程
+	bool tryPop(T &out)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_cachedTail) {
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head == m_cachedTail)
+				return false;
+		}
+		out = std::move(m_slots[head & m_mask]);
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// 消费者线程：一次取出最多 max 个元素交给 fn(T &)，只发布一次 head
+	template<typename F> size_t drain(F &&fn, size_t max)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		size_t count = m_cachedTail - head;
+		if (count > max)
+			count = max;
+		for (size_t i = 0; i < count; ++i)
+			fn(m_slots[(head + i) & m_mask]);
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	// 近似值，仅用于统计
+	size_t size() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+private:
+	std::vector<T> m_slots;
+	size_t m_mask = 0;
+
+	// 生产者和消费者各自的索引放在不同缓存行，避免伪共享
+	alignas(64) std::atomic<size_t> m_head{0};
+	size_t m_cachedTail = 0;
+	alignas(64) std::atomic<size_t> m_tail{0};
+	size_t m_cachedHead = 0;
+};
+} // namespace Core
@@ -0,0 +1,183 @@
+#include "core/stream_launcher.hpp"
+#include <obs-module.h>
+#include "plugin_utils.hpp"
+
+namespace Core {
+static const int kFirstBytesPollMs = 20;
+static const int kFirstBytesTimeoutMs = 15000;
+
+StreamLauncher::StreamLauncher(QObject *parent) : QObject(parent)
+{
+	m_firstBytes.setInterval(kFirstBytesPollMs);
+	connect(&m_firstBytes, &QTimer::timeout, this, &StreamLauncher::pollFirstBytes);
+	obs_frontend_add_event_callback(&StreamLauncher::onFrontendEvent, this);
+}
+
+StreamLauncher::~StreamLauncher()
+{
+	obs_frontend_remove_event_callback(&StreamLauncher::onFrontendEvent, this);
+}
+
+int64_t StreamLauncher::elapsedMs() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_clickedAt)
+		       .count() +
+	       m_apiMs;
+}
+
+bool StreamLauncher::applyService(const std::string &rtmpAddr, const std::string &rtmpCode, bool persist)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_string(settings, "server", rtmpAddr.c_str());
+	obs_data_set_string(settings, "key", rtmpCode.c_str());
+	obs_data_set_bool(settings, "use_auth", false);
+	obs_service_t *service = obs_service_create("rtmp_custom", "bilibili_live", settings, nullptr);
+	obs_data_release(settings);
+	if (!service) {
+		obs_log(LOG_ERROR, "创建自定义推流服务失败");
+		return false;
+	}
+	obs_frontend_set_streaming_service(service);
+	if (persist)
+		obs_frontend_save_streaming_service();
+	obs_service_release(service);
+	return true;
+}
+
+bool StreamLauncher::launch(const std::string &rtmpAddr, const std::string &rtmpCode, int64_t apiMs)
+{
+	m_apiMs = apiMs;
+	m_clickedAt = std::chrono::steady_clock::now();
+
+	// 推流中无法替换服务，交给用户处理
+	if (obs_frontend_streaming_active()) {
+		obs_log(LOG_WARNING, "OBS 已在推流，跳过自动配置推流服务");
+		return false;
+	}
+	if (!applyService(rtmpAddr, rtmpCode, true))
+		return false;
+	m_applied = {rtmpAddr, rtmpCode};
+	obs_log(LOG_INFO, "开播耗时: 接口及节点测速 %lld ms，配置推流服务 %lld ms", (long long)apiMs,
+		(long long)(elapsedMs() - apiMs));
+
+	m_state = State::Connecting;
+	obs_frontend_streaming_start();
+	return true;
+}
+
+bool StreamLauncher::switchTo(const Bili::RtmpInfo &target)
+{
+	if (m_state != State::Idle || !obs_frontend_streaming_active())
+		return false;
+	obs_log(LOG_INFO, "切换推流节点: %s", target.addr.c_str());
+	m_switchTarget = target;
+	m_apiMs = 0;
+	m_clickedAt = std::chrono::steady_clock::now();
+	// 先停止输出，收到 STREAMING_STOPPED 后再换服务重新推流
+	m_state = State::SwitchStopping;
+	obs_frontend_streaming_stop();
+	return true;
+}
+
+void StreamLauncher::stopOutput()
+{
+	m_state = State::Idle;
+	m_applied = {};
+	m_firstBytes.stop();
+	if (obs_frontend_streaming_active())
+		obs_frontend_streaming_stop();
+}
+
+bool StreamLauncher::servesRoom(const Bili::RtmpInfo &room) const
+{
+	obs_service_t *service = obs_frontend_get_streaming_service();
+	if (!service)
+		return false;
+	obs_data_t *settings = obs_service_get_settings(service);
+	Bili::RtmpInfo current{obs_data_get_string(settings, "server"), obs_data_get_string(settings, "key")};
+	obs_data_release(settings);
+
+	auto matches = [&current](const Bili::RtmpInfo &info) {
+		return !info.addr.empty() && info.addr == current.addr && info.code == current.code;
+	};
+	return matches(m_applied) || matches(room);
+}
+
+void StreamLauncher::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	auto *self = static_cast<StreamLauncher *>(data);
+	if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED)
+		self->onStreamingStarted();
+	else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED)
+		self->onStreamingStopped();
+}
+
+void StreamLauncher::onStreamingStarted()
+{
+	if (m_state != State::Connecting && m_state != State::SwitchConnecting)
+		return;
+	m_startedAt = std::chrono::steady_clock::now();
+	obs_log(LOG_INFO, "%s: 推流输出已连接，累计 %lld ms", m_state == State::Connecting ? "开播耗时" : "切换节点",
+		(long long)elapsedMs());
+	m_firstBytes.start();
+}
+
+void StreamLauncher::onStreamingStopped()
+{
+	if (m_state == State::SwitchStopping) {
+		obs_log(LOG_INFO, "切换节点: 原输出已停止，%lld ms", (long long)elapsedMs());
+		// 不能在 STREAMING_STOPPED 回调里重入前端 API 重新推流，回到事件循环后再启动
+		QMetaObject::invokeMethod(this, &StreamLauncher::restartOnSwitchTarget, Qt::QueuedConnection);
+		return;
+	}
+	if (m_state != State::Connecting && m_state != State::SwitchConnecting)
+		return;
+	// 还没推出数据就停止，多半是地址或网络问题
+	m_state = State::Idle;
+	m_firstBytes.stop();
+	obs_log(LOG_WARNING, "推流输出在 %lld ms 后停止", (long long)elapsedMs());
+	emit failed(QString::fromUtf8("推流输出连接失败，请检查网络或手动推流"));
+}
+
+void StreamLauncher::restartOnSwitchTarget()
+{
+	// 排队期间可能已经下播（stopOutput 会把状态置回 Idle）
+	if (m_state != State::SwitchStopping)
+		return;
+	// 备用节点只用于本场直播，不覆盖用户保存的推流服务
+	if (!applyService(m_switchTarget.addr, m_switchTarget.code, false)) {
+		m_state = State::Idle;
+		emit failed(QString::fromUtf8("切换备用推流节点失败"));
+		return;
+	}
+	m_applied = m_switchTarget;
+	m_state = State::SwitchConnecting;
+	obs_frontend_streaming_start();
+}
+
+void StreamLauncher::pollFirstBytes()
+{
+	obs_output_t *output = obs_frontend_get_streaming_output();
+	uint64_t bytes = output ? obs_output_get_total_bytes(output) : 0;
+	obs_output_release(output);
+
+	if (bytes > 0) {
+		State state = m_state;
+		m_state = State::Idle;
+		m_firstBytes.stop();
+		if (state == State::SwitchConnecting) {
+			obs_log(LOG_INFO, "切换节点完成: 推流中断 %lld ms", (long long)elapsedMs());
+			emit switched(elapsedMs());
+		} else {
+			obs_log(LOG_INFO, "开播耗时: 首帧已推出，点击到首帧共 %lld ms", (long long)elapsedMs());
+			emit launched();
+		}
+		return;
+	}
+	if (std::chrono::steady_clock::now() - m_startedAt > std::chrono::milliseconds(kFirstBytesTimeoutMs)) {
+		m_state = State::Idle;
+		m_firstBytes.stop();
+		obs_log(LOG_WARNING, "推流输出已连接但 %d ms 内没有数据", kFirstBytesTimeoutMs);
+	}
+}
+} // namespace Core
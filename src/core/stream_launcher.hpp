@@ -0,0 +1,55 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <chrono>
+#include <obs-frontend-api.h>
+#include <string>
+#include "bilibili_schema.hpp"
+
+namespace Core {
+// 开播接口返回推流地址后，直接写入 OBS 自定义推流服务并启动推流输出，记录各阶段耗时；
+// 也负责推流中途切换到备用节点
+class StreamLauncher : public QObject {
+	Q_OBJECT
+public:
+	explicit StreamLauncher(QObject *parent = nullptr);
+	~StreamLauncher();
+
+	// apiMs 为 startLive 接口（含节点测速）耗时，计入总耗时；返回 false 时需要用户手动推流
+	bool launch(const std::string &rtmpAddr, const std::string &rtmpCode, int64_t apiMs);
+	// 停止当前输出并改用 target 重新推流，中断时长通过 switched 报告
+	bool switchTo(const Bili::RtmpInfo &target);
+	void stopOutput();
+	// 正在切换节点时输出会短暂停止，外部不应把这次停止当作下播
+	bool isSwitching() const { return m_state == State::SwitchStopping || m_state == State::SwitchConnecting; }
+	// OBS 当前的推流服务是否指向本插件开播得到的地址：本插件写入的（开播或切换节点），
+	// 或与 room（用户手动填入的推流地址）一致。直播间由其他设备开启时返回 false
+	bool servesRoom(const Bili::RtmpInfo &room) const;
+
+signals:
+	void launched();
+	void switched(qint64 interruptionMs);
+	void failed(const QString &message);
+
+private:
+	enum class State { Idle, Connecting, SwitchStopping, SwitchConnecting };
+
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	// persist 为 false 时只替换当前会话的服务，不写入 OBS 的 service.json
+	static bool applyService(const std::string &rtmpAddr, const std::string &rtmpCode, bool persist);
+	void onStreamingStarted();
+	void onStreamingStopped();
+	void restartOnSwitchTarget();
+	void pollFirstBytes();
+	int64_t elapsedMs() const;
+
+	State m_state = State::Idle;
+	int64_t m_apiMs = 0;
+	Bili::RtmpInfo m_switchTarget;
+	Bili::RtmpInfo m_applied; // 最近一次写入 OBS 的推流服务，stopOutput 时清空
+	std::chrono::steady_clock::time_point m_clickedAt;
+	std::chrono::steady_clock::time_point m_startedAt;
+	QTimer m_firstBytes;
+};
+} // namespace Core
@@ -0,0 +1,156 @@
+#include "core/tcp_socket.hpp"
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+namespace Core {
+#ifdef _WIN32
+static bool wouldBlock()
+{
+	int err = WSAGetLastError();
+	return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+}
+#else
+static bool wouldBlock()
+{
+	return errno == EINPROGRESS || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+#endif
+
+int TcpSocket::msSince(Clock::time_point start)
+{
+	return int(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+}
+
+bool TcpSocket::isOpen() const
+{
+	return m_socket != CURL_SOCKET_BAD;
+}
+
+void TcpSocket::close()
+{
+	if (m_curl)
+		curl_easy_cleanup(m_curl);
+	m_curl = nullptr;
+	m_socket = CURL_SOCKET_BAD;
+}
+
+void TcpSocket::setSendBuffer(int bytes)
+{
+	setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char *>(&bytes), sizeof(bytes));
+}
+
+bool TcpSocket::wait(bool write, Clock::time_point deadline)
+{
+	int remaining = int(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+	if (remaining <= 0)
+		return false;
+#ifdef _WIN32
+	WSAPOLLFD fd = {m_socket, short(write ? POLLWRNORM : POLLRDNORM), 0};
+	return WSAPoll(&fd, 1, remaining) > 0;
+#else
+	pollfd fd = {m_socket, short(write ? POLLOUT : POLLIN), 0};
+	return poll(&fd, 1, remaining) > 0;
+#endif
+}
+
+bool TcpSocket::connect(const std::string &host, int port, Clock::time_point deadline, std::string &error)
+{
+	close();
+	auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+	if (remaining <= 0) {
+		error = "连接超时";
+		return false;
+	}
+	m_curl = curl_easy_init();
+	if (!m_curl) {
+		error = "创建套接字失败";
+		return false;
+	}
+
+	// CONNECT_ONLY 只解析和建立 TCP 连接，不发送任何 HTTP 数据
+	bool ipv6 = host.find(':') != std::string::npos;
+	std::string url = "http://" + (ipv6 ? "[" + host + "]" : host) + ":" + std::to_string(port) + "/";
+	curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(m_curl, CURLOPT_CONNECT_ONLY, 1L);
+	curl_easy_setopt(m_curl, CURLOPT_CONNECTTIMEOUT_MS, long(remaining));
+	curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(m_curl, CURLOPT_PROXY, "");
+#if LIBCURL_VERSION_NUM >= 0x075700
+	// 超时后不等待仍卡在 getaddrinfo 里的解析线程，由 curl 在后台回收
+	curl_easy_setopt(m_curl, CURLOPT_QUICK_EXIT, 1L);
+#endif
+
+	CURLcode res = curl_easy_perform(m_curl);
+	if (res == CURLE_OK)
+		curl_easy_getinfo(m_curl, CURLINFO_ACTIVESOCKET, &m_socket);
+	if (res != CURLE_OK || m_socket == CURL_SOCKET_BAD) {
+		if (res == CURLE_COULDNT_RESOLVE_HOST)
+			error = "域名解析失败";
+		else if (res == CURLE_OPERATION_TIMEDOUT)
+			error = "连接超时";
+		else
+			error = "连接失败";
+		close();
+		return false;
+	}
+#ifdef SO_NOSIGPIPE
+	// macOS 没有 MSG_NOSIGNAL，对端断开时不能让 SIGPIPE 结束 OBS
+	int noSigpipe = 1;
+	setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+	return true;
+}
+
+int TcpSocket::sendSome(const char *data, size_t size)
+{
+#ifdef MSG_NOSIGNAL
+	int n = int(send(m_socket, data, int(size), MSG_NOSIGNAL));
+#else
+	int n = int(send(m_socket, data, int(size), 0));
+#endif
+	if (n >= 0)
+		return n;
+	return wouldBlock() ? 0 : -1;
+}
+
+bool TcpSocket::sendAll(const char *data, size_t size, Clock::time_point deadline)
+{
+	size_t sent = 0;
+	while (sent < size) {
+		int n = sendSome(data + sent, size - sent);
+		if (n < 0)
+			return false;
+		if (n > 0) {
+			sent += size_t(n);
+			continue;
+		}
+		if (!wait(true, deadline))
+			return false;
+	}
+	return true;
+}
+
+bool TcpSocket::recvAll(char *data, size_t size, Clock::time_point deadline)
+{
+	size_t received = 0;
+	while (received < size) {
+		if (!wait(false, deadline))
+			return false;
+		int n = int(recv(m_socket, data + received, int(size - received), 0));
+		if (n == 0)
+			return false;
+		if (n < 0) {
+			if (wouldBlock())
+				continue;
+			return false;
+		}
+		received += size_t(n);
+	}
+	return true;
+}
+} // namespace Core
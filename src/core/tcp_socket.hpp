@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <curl/curl.h>
+#include <string>
+#include <cstddef>
+
+namespace Core {
+// 推流节点测速 / 上行测速共用的非阻塞 TCP 封装。
+// 解析和建连交给 libcurl（CONNECT_ONLY）：它的解析器在后台线程运行，整个 connect 受 deadline 约束，
+// 不会像同步 getaddrinfo 那样在 DNS 无响应时卡住调用线程。连接建立后直接在套接字上收发
+class TcpSocket {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	TcpSocket() = default;
+	~TcpSocket() { close(); }
+	TcpSocket(const TcpSocket &) = delete;
+	TcpSocket &operator=(const TcpSocket &) = delete;
+
+	// 解析并建立非阻塞连接，最迟在 deadline 返回；失败时 error 为中文原因
+	bool connect(const std::string &host, int port, Clock::time_point deadline, std::string &error);
+	void close();
+	bool isOpen() const;
+	void setSendBuffer(int bytes);
+
+	// 在 deadline 前发完 / 收满 size 字节
+	bool sendAll(const char *data, size_t size, Clock::time_point deadline);
+	bool recvAll(char *data, size_t size, Clock::time_point deadline);
+	// 非阻塞发送，返回已写入字节数；缓冲区满时返回 0，出错时返回 -1
+	int sendSome(const char *data, size_t size);
+	// 等待套接字可读 / 可写；用 poll 而不是 select，避免 OBS 进程内描述符超过 FD_SETSIZE
+	bool wait(bool write, Clock::time_point deadline);
+
+	static int msSince(Clock::time_point start);
+
+private:
+	CURL *m_curl = nullptr; // 持有连接，close() 时由 curl 关闭套接字
+	curl_socket_t m_socket = CURL_SOCKET_BAD;
+};
+} // namespace Core
@@ -0,0 +1,98 @@
+#include "core/timer_wheel.hpp"
+#include <algorithm>
+
+namespace Core {
+TimerWheel::TimerWheel(int64_t tickMs, size_t slots) : m_tickMs(tickMs), m_slots(slots) {}
+
+void TimerWheel::reset(int64_t nowMs)
+{
+	clear();
+	m_originMs = nowMs;
+	m_tick = 0;
+}
+
+void TimerWheel::clear()
+{
+	for (auto &slot : m_slots)
+		slot.clear();
+	m_timers.clear();
+}
+
+int64_t TimerWheel::tickOf(int64_t ms) const
+{
+	// 向上取整：定时器不会早于 deadline 触发
+	int64_t offset = ms - m_originMs;
+	return offset <= 0 ? 0 : (offset + m_tickMs - 1) / m_tickMs;
+}
+
+uint64_t TimerWheel::schedule(int64_t deadlineMs, Callback callback)
+{
+	int64_t tick = std::max(tickOf(deadlineMs), m_tick + 1);
+	size_t slot = size_t(tick % int64_t(m_slots.size()));
+	uint64_t id = m_nextId++;
+	m_slots[slot].push_back({id, tick, std::move(callback)});
+	m_timers[id] = slot;
+	return id;
+}
+
+void TimerWheel::cancel(uint64_t id)
+{
+	auto it = m_timers.find(id);
+	if (it == m_timers.end())
+		return;
+	auto &slot = m_slots[it->second];
+	slot.erase(std::remove_if(slot.begin(), slot.end(), [id](const Timer &timer) { return timer.id == id; }),
+		   slot.end());
+	m_timers.erase(it);
+}
+
+int64_t TimerWheel::nextDeadlineMs() const
+{
+	if (m_timers.empty())
+		return -1;
+	// 按槽顺序找本圈内到期的定时器；全部在后续轮次时取其中最早的
+	int64_t slots = int64_t(m_slots.size());
+	int64_t earliest = INT64_MAX;
+	for (int64_t i = 1; i <= slots; ++i) {
+		for (const auto &timer : m_slots[size_t((m_tick + i) % slots)]) {
+			if (timer.tick == m_tick + i)
+				return m_originMs + timer.tick * m_tickMs;
+			earliest = std::min(earliest, timer.tick);
+		}
+	}
+	return m_originMs + earliest * m_tickMs;
+}
+
+void TimerWheel::expireSlot(size_t slot, int64_t upToTick, std::vector<Timer> &due)
+{
+	auto &timers = m_slots[slot];
+	auto keep = std::stable_partition(timers.begin(), timers.end(),
+					  [upToTick](const Timer &timer) { return timer.tick > upToTick; });
+	for (auto it = keep; it != timers.end(); ++it) {
+		m_timers.erase(it->id);
+		due.push_back(std::move(*it));
+	}
+	timers.erase(keep, timers.end());
+}
+
+void TimerWheel::advance(int64_t nowMs)
+{
+	int64_t target = (nowMs - m_originMs) / m_tickMs;
+	if (target <= m_tick)
+		return;
+
+	// 落后超过一圈时每个槽只需要扫一次
+	std::vector<Timer> due;
+	int64_t steps = std::min<int64_t>(target - m_tick, int64_t(m_slots.size()));
+	for (int64_t i = 1; i <= steps; ++i)
+		expireSlot(size_t((m_tick + i) % int64_t(m_slots.size())), target, due);
+	m_tick = target;
+
+	std::sort(due.begin(), due.end(), [](const Timer &a, const Timer &b) {
+		return a.tick != b.tick ? a.tick < b.tick : a.id < b.id;
+	});
+	// 回调里可能再 schedule，先收集再执行
+	for (auto &timer : due)
+		timer.callback();
+}
+} // namespace Core
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Core {
+// 哈希时间轮：定时器按到期 tick 放进 tick % slots 的槽，超过一圈的定时器留在槽里等后续轮次。
+// 不是线程安全的，由一个线程驱动；时间单位由调用方决定（这里用毫秒）
+class TimerWheel {
+public:
+	using Callback = std::function<void()>;
+
+	TimerWheel(int64_t tickMs, size_t slots);
+
+	// 从 nowMs 开始计时；已有的定时器全部丢弃
+	void reset(int64_t nowMs);
+	// deadline 早于当前 tick 时在下一次 advance 立即到期
+	uint64_t schedule(int64_t deadlineMs, Callback callback);
+	void cancel(uint64_t id);
+	void clear();
+	bool empty() const { return m_timers.empty(); }
+
+	// 推进到 nowMs 并执行期间到期的定时器。线程醒晚了也会补上漏掉的 tick，不会丢定时器
+	void advance(int64_t nowMs);
+	// 最早一个定时器到期的绝对时间（所在 tick 的起点），没有定时器时返回 -1。
+	// 驱动线程据此一直睡到有事可做，而不是每个 tick 都醒来
+	int64_t nextDeadlineMs() const;
+	int64_t tickMs() const { return m_tickMs; }
+
+private:
+	struct Timer {
+		uint64_t id;
+		int64_t tick;
+		Callback callback;
+	};
+
+	int64_t tickOf(int64_t ms) const;
+	void expireSlot(size_t slot, int64_t upToTick, std::vector<Timer> &due);
+
+	int64_t m_tickMs;
+	int64_t m_originMs = 0;
+	int64_t m_tick = 0; // 已处理到的 tick
+	std::vector<std::vector<Timer>> m_slots;
+	std::unordered_map<uint64_t, size_t> m_timers; // id → 槽位，用于取消
+	uint64_t m_nextId = 1;
+};
+} // namespace Core
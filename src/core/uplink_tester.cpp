@@ -0,0 +1,225 @@
+#include "core/uplink_tester.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "core/ingest_prober.hpp"
+#include "core/tcp_socket.hpp"
+
+namespace Core {
+using Clock = TcpSocket::Clock;
+
+static const size_t kHandshakeSize = 1536;
+static const int kChunkSize = 65536;
+static const size_t kMessageSize = 16 * 1024;
+static const int kSendBuffer = 64 * 1024; // 限制内核缓冲，发送速率才能反映确认速率
+static const int kRttIntervalMs = 200;
+static const int kIdleRttSamples = 3;
+
+static void putBe(std::string &out, uint32_t value, int bytes)
+{
+	for (int i = bytes - 1; i >= 0; --i)
+		out += static_cast<char>((value >> (i * 8)) & 0xff);
+}
+
+// RTMP 消息头（fmt 0，单个 chunk）
+static void putHeader(std::string &out, uint8_t csid, uint8_t type, size_t length)
+{
+	out += static_cast<char>(csid);
+	putBe(out, 0, 3);
+	putBe(out, uint32_t(length), 3);
+	out += static_cast<char>(type);
+	putBe(out, 0, 4); // message stream id，小端，0
+}
+
+static std::string buildBurstPrologue()
+{
+	std::string out;
+	putHeader(out, 2, 1, 4); // Set Chunk Size，之后每条填充消息只需一个 chunk
+	putBe(out, kChunkSize, 4);
+	return out;
+}
+
+static std::string buildFillerMessage()
+{
+	static const char name[] = "onUplinkTest";
+	size_t padding = kMessageSize - (3 + sizeof(name) - 1) - 3;
+	std::string payload;
+	payload += '\x02';
+	putBe(payload, sizeof(name) - 1, 2);
+	payload += name;
+	payload += '\x02';
+	putBe(payload, uint32_t(padding), 2);
+	payload.append(padding, 'x');
+
+	std::string out;
+	putHeader(out, 3, 0x12, payload.size());
+	return out + payload;
+}
+
+static bool handshake(TcpSocket &socket, Clock::time_point deadline, std::string &error)
+{
+	std::string c0c1(1 + kHandshakeSize, '\0');
+	c0c1[0] = 3;
+	for (size_t i = 9; i < c0c1.size(); ++i)
+		c0c1[i] = static_cast<char>(i * 131);
+	if (!socket.sendAll(c0c1.data(), c0c1.size(), deadline)) {
+		error = "发送握手超时";
+		return false;
+	}
+
+	std::string s0s1s2(1 + 2 * kHandshakeSize, '\0');
+	if (!socket.recvAll(&s0s1s2[0], s0s1s2.size(), deadline)) {
+		error = "握手超时";
+		return false;
+	}
+	if (s0s1s2[0] != 3) {
+		error = "握手应答版本错误";
+		return false;
+	}
+	// C2 回显 S1
+	if (!socket.sendAll(s0s1s2.data() + 1, kHandshakeSize, deadline)) {
+		error = "发送握手超时";
+		return false;
+	}
+	return true;
+}
+
+static int connectMs(const std::string &host, int port, int timeoutMs)
+{
+	TcpSocket socket;
+	std::string error;
+	auto started = Clock::now();
+	if (!socket.connect(host, port, started + std::chrono::milliseconds(timeoutMs), error))
+		return -1;
+	return TcpSocket::msSince(started);
+}
+
+UplinkResult UplinkTester::run(const std::string &rtmpAddr, int durationMs, int ceilingKbps,
+			       const std::atomic<bool> *abort)
+{
+	auto aborted = [abort]() { return abort && abort->load(); };
+	UplinkResult result;
+	std::string host;
+	int port = 0;
+	if (!IngestProber::parseRtmpUrl(rtmpAddr, host, port)) {
+		result.error = "无效的推流地址";
+		return result;
+	}
+
+	std::vector<int> idle;
+	for (int i = 0; i < kIdleRttSamples && !aborted(); ++i) {
+		int ms = connectMs(host, port, 1000);
+		if (ms >= 0)
+			idle.push_back(ms);
+	}
+	if (idle.empty()) {
+		result.error = aborted() ? "已取消" : "连接失败";
+		return result;
+	}
+	std::sort(idle.begin(), idle.end());
+	result.rtt_idle_ms = idle[idle.size() / 2];
+
+	TcpSocket socket;
+	auto setupDeadline = Clock::now() + std::chrono::milliseconds(2000);
+	if (!socket.connect(host, port, setupDeadline, result.error))
+		return result;
+	if (!handshake(socket, setupDeadline, result.error))
+		return result;
+	socket.setSendBuffer(kSendBuffer);
+
+	// 突发期间另开线程周期性建连，建连耗时的升高反映上行队列的堆积
+	std::atomic<bool> done{false};
+	std::vector<int> loaded;
+	std::thread rttThread([&]() {
+		while (!done.load()) {
+			auto next = Clock::now() + std::chrono::milliseconds(kRttIntervalMs);
+			int ms = connectMs(host, port, 1000);
+			if (ms >= 0)
+				loaded.push_back(ms);
+			std::this_thread::sleep_until(next);
+		}
+	});
+
+	std::string prologue = buildBurstPrologue();
+	std::string filler = buildFillerMessage();
+	auto started = Clock::now();
+	auto end = started + std::chrono::milliseconds(durationMs);
+	// 前 1/3 为预热（TCP 慢启动、填满发送缓冲），只统计之后的发送量
+	auto warm = started + std::chrono::milliseconds(durationMs / 3);
+	double bytesPerMs = ceilingKbps > 0 ? ceilingKbps / 8.0 : 0;
+	bool ok = socket.sendAll(prologue.data(), prologue.size(), end);
+	uint64_t sent = 0;
+	uint64_t sentAtWarm = 0;
+	bool warmed = false;
+	size_t offset = 0;
+	while (ok && Clock::now() < end && !aborted()) {
+		auto now = Clock::now();
+		if (!warmed && now >= warm) {
+			warmed = true;
+			sentAtWarm = sent;
+		}
+		double elapsedMs = std::chrono::duration<double, std::milli>(now - started).count();
+		if (bytesPerMs > 0 && sent >= uint64_t(elapsedMs * bytesPerMs)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			continue;
+		}
+		int n = socket.sendSome(filler.data() + offset, filler.size() - offset);
+		if (n < 0) {
+			ok = false;
+			break;
+		}
+		if (n == 0) {
+			socket.wait(true, std::min(end, Clock::now() + std::chrono::milliseconds(20)));
+			continue;
+		}
+		sent += uint64_t(n);
+		offset = (offset + size_t(n)) % filler.size();
+	}
+	auto finished = Clock::now();
+	done = true;
+	rttThread.join();
+	socket.close();
+
+	if (aborted()) {
+		result.error = "已取消";
+		return result;
+	}
+	double measuredMs = std::chrono::duration<double, std::milli>(finished - warm).count();
+	if (!warmed || measuredMs < durationMs / 3.0) {
+		result.error = ok ? "测速时间过短" : "服务器中断了连接";
+		return result;
+	}
+	result.throughput_kbps = double(sent - sentAtWarm) * 8.0 / measuredMs;
+	result.saturated = bytesPerMs > 0 && result.throughput_kbps >= ceilingKbps * 0.95;
+
+	if (!loaded.empty()) {
+		double sum = 0;
+		for (int ms : loaded)
+			sum += ms;
+		result.rtt_loaded_ms = sum / double(loaded.size());
+		double var = 0;
+		for (int ms : loaded)
+			var += (ms - result.rtt_loaded_ms) * (ms - result.rtt_loaded_ms);
+		result.rtt_jitter_ms = std::sqrt(var / double(loaded.size()));
+	}
+	result.ok = true;
+	return result;
+}
+
+int UplinkTester::recommend(const UplinkResult &result, int maxKbps)
+{
+	if (!result.ok)
+		return 0;
+	// 视频码率之外还有音频和协议开销，且上行带宽会波动，只用持续吞吐的 75%
+	double usable = result.throughput_kbps * 0.75;
+	// 负载下 RTT 明显上升或抖动大，说明已经在排队，再打 8 折
+	if (result.rtt_idle_ms >= 0 &&
+	    (result.rtt_loaded_ms - result.rtt_idle_ms > 100 || result.rtt_jitter_ms > 50))
+		usable *= 0.8;
+	int kbps = int(usable) / 100 * 100;
+	if (maxKbps > 0)
+		kbps = std::min(kbps, maxKbps);
+	return std::max(kbps, 0);
+}
+} // namespace Core
@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <string>
+
+namespace Core {
+struct UplinkResult {
+	bool ok = false;
+	double throughput_kbps = 0; // 预热结束后的持续发送速率
+	bool saturated = false;     // 达到了限速上限，实际带宽可能更高
+	int rtt_idle_ms = -1;       // 空载时建连耗时（≈ 1 个 RTT）的中位数
+	double rtt_loaded_ms = 0;   // 突发期间建连耗时的平均值
+	double rtt_jitter_ms = 0;   // 突发期间建连耗时的标准差
+	std::string error;
+};
+
+// 开播前的上行测速：RTMP 握手后以最多 ceilingKbps 的速率向推流节点发送填充数据（AMF0 数据消息），
+// 同时另开连接测量负载下的 RTT。整体耗时约 durationMs，可以用任意回应 RTMP 握手的本地服务器测试。
+// 会阻塞数秒，应在工作线程上调用；abort 置位后尽快返回
+class UplinkTester {
+public:
+	static UplinkResult run(const std::string &rtmpAddr, int durationMs, int ceilingKbps,
+				const std::atomic<bool> *abort = nullptr);
+	// 持续吞吐留出余量，RTT 明显上升（排队）时再打折；结果不超过 maxKbps
+	static int recommend(const UplinkResult &result, int maxKbps);
+};
+} // namespace Core
@@ -0,0 +1,343 @@
+#include "danmaku/danmaku_client.hpp"
+#include <curl/curl.h>
+#include <obs-module.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/select.h>
+#endif
+#include "danmaku/danmaku_protocol.hpp"
+#include "bilibili_api.hpp"
+#include "http_client.hpp"
+#include "json11/json11.hpp"
+#include "plugin_utils.hpp"
+
+namespace Danmaku {
+using Clock = std::chrono::steady_clock;
+
+static const auto kHeartbeatInterval = std::chrono::seconds(30);
+static const auto kSilenceTimeout = std::chrono::seconds(70);
+static const auto kStatsInterval = std::chrono::seconds(60);
+static const int kMaxBackoffMs = 30000;
+
+#ifdef HAVE_BROTLI
+static const int kProtocolVersion = PROTO_BROTLI;
+#else
+static const int kProtocolVersion = PROTO_ZLIB;
+#endif
+
+static int64_t nowMs()
+{
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static bool waitSocket(curl_socket_t sock, bool writable, int timeout_ms)
+{
+	fd_set fds;
+	FD_ZERO(&fds);
+	FD_SET(sock, &fds);
+	timeval tv;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000;
+	return select(static_cast<int>(sock + 1), writable ? nullptr : &fds, writable ? &fds : nullptr, nullptr, &tv) >
+	       0;
+}
+
+// 连接阶段（DNS、TCP、TLS、websocket 握手）也要能被 stop() 立即打断
+static int abortCallback(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+	return static_cast<const std::atomic<bool> *>(clientp)->load() ? 1 : 0;
+}
+
+// curl_ws_recv 的 metap 在 7.x 和早期 8.x 是 struct curl_ws_frame **，之后改成了 const；按实际原型推导
+template<typename Frame>
+static CURLcode wsRecv(CURLcode (*fn)(CURL *, void *, size_t, size_t *, Frame **), CURL *curl, void *buffer,
+		       size_t buflen, size_t *received, const struct curl_ws_frame **meta)
+{
+	Frame *frame = nullptr;
+	CURLcode res = fn(curl, buffer, buflen, received, &frame);
+	*meta = frame;
+	return res;
+}
+
+static bool sendAll(CURL *curl, curl_socket_t sock, const std::string &data, const std::atomic<bool> &stop)
+{
+	size_t offset = 0;
+	while (offset < data.size()) {
+		if (stop)
+			return false;
+		size_t sent = 0;
+		CURLcode res = curl_ws_send(curl, data.data() + offset, data.size() - offset, &sent, 0, CURLWS_BINARY);
+		if (res == CURLE_AGAIN) {
+			// 发送缓冲已满，等套接字可写再重试；每 200ms 检查一次 stop
+			waitSocket(sock, true, 200);
+			continue;
+		}
+		if (res != CURLE_OK)
+			return false;
+		offset += sent;
+	}
+	return true;
+}
+
+DanmakuClient::DanmakuClient(EventHandler handler) : m_handler(std::move(handler)) {}
+
+DanmakuClient::~DanmakuClient()
+{
+	stop();
+}
+
+bool DanmakuClient::supported()
+{
+	const curl_version_info_data *info = curl_version_info(CURLVERSION_NOW);
+	for (const char *const *p = info ? info->protocols : nullptr; p && *p; ++p) {
+		if (strcmp(*p, "wss") == 0)
+			return true;
+	}
+	return false;
+}
+
+void DanmakuClient::start(const ClientOptions &options)
+{
+	stop();
+	if (!supported()) {
+		obs_log(LOG_ERROR, "当前 libcurl (%s) 不支持 websocket，弹幕功能不可用",
+			curl_version_info(CURLVERSION_NOW)->version);
+		return;
+	}
+	m_options = options;
+	m_stop = false;
+	m_thread = std::thread(&DanmakuClient::run, this);
+}
+
+void DanmakuClient::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+ClientStats DanmakuClient::stats() const
+{
+	ClientStats stats;
+	stats.frames = m_frames;
+	stats.packets = m_packets;
+	stats.events = m_events;
+	stats.bytes = m_bytes;
+	stats.errors = m_errors;
+	stats.reconnects = m_reconnects;
+	return stats;
+}
+
+bool DanmakuClient::sleepFor(int ms)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return !m_cv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return m_stop.load(); });
+}
+
+void DanmakuClient::run()
+{
+	Http::HttpSession session;
+	session.setAbortFlag(&m_stop);
+	int backoff = 1000;
+	size_t hostIndex = 0;
+	while (!m_stop) {
+		std::string url = m_options.url;
+		std::string token = m_options.token;
+		if (url.empty()) {
+			Bili::DanmuInfoData info;
+			std::string message;
+			if (!Bili::BiliApi::getDanmuInfo(session, m_options.cookies, m_options.room_id, info,
+							 message)) {
+				if (m_stop)
+					return;
+				obs_log(LOG_WARNING, "弹幕服务器信息获取失败: %s", message.c_str());
+				if (!sleepFor(backoff))
+					return;
+				backoff = std::min(backoff * 2, kMaxBackoffMs);
+				continue;
+			}
+			// 重连时轮换服务器
+			const auto &host = info.host_list[hostIndex++ % info.host_list.size()];
+			url = "wss://" + host.host + ":" + std::to_string(host.wss_port ? host.wss_port : 443) + "/sub";
+			token = info.token;
+		}
+
+		auto started = Clock::now();
+		serve(url, token);
+		if (m_stop)
+			return;
+
+		if (Clock::now() - started > std::chrono::minutes(1))
+			backoff = 1000;
+		++m_reconnects;
+		obs_log(LOG_INFO, "弹幕连接断开，%d ms 后重连", backoff);
+		if (!sleepFor(backoff))
+			return;
+		backoff = std::min(backoff * 2, kMaxBackoffMs);
+	}
+}
+
+void DanmakuClient::serve(const std::string &url, const std::string &token)
+{
+	CURL *curl = curl_easy_init();
+	if (!curl)
+		return;
+
+	struct curl_slist *headers = nullptr;
+	headers = curl_slist_append(headers, "Origin: https://live.bilibili.com");
+	headers = curl_slist_append(headers, "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+					     "(KHTML, like Gecko) Chrome/129.0.0.0 Safari/537.36");
+	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 2L);
+	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 10000L);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+	curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abortCallback);
+	curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &m_stop);
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+	if (!m_options.cookies.empty())
+		curl_easy_setopt(curl, CURLOPT_COOKIE, m_options.cookies.c_str());
+
+	CURLcode res = curl_easy_perform(curl);
+	curl_socket_t sock = CURL_SOCKET_BAD;
+	if (res == CURLE_OK)
+		curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &sock);
+	if (res != CURLE_OK || sock == CURL_SOCKET_BAD) {
+		// stop() 打断的连接不算失败
+		if (!m_stop)
+			obs_log(LOG_WARNING, "弹幕服务器连接失败: %s", curl_easy_strerror(res));
+		curl_easy_cleanup(curl);
+		curl_slist_free_all(headers);
+		return;
+	}
+
+	json11::Json auth = json11::Json::object{
+		{"uid", static_cast<double>(m_options.uid)},
+		{"roomid", static_cast<double>(strtoll(m_options.room_id.c_str(), nullptr, 10))},
+		{"protover", kProtocolVersion},
+		{"platform", "web"},
+		{"type", 2},
+		{"key", token},
+	};
+	const std::string heartbeat = encodePacket(OP_HEARTBEAT, "[object Object]");
+	if (!sendAll(curl, sock, encodePacket(OP_AUTH, auth.dump()), m_stop) ||
+	    !sendAll(curl, sock, heartbeat, m_stop)) {
+		obs_log(LOG_WARNING, "弹幕鉴权包发送失败");
+		curl_easy_cleanup(curl);
+		curl_slist_free_all(headers);
+		return;
+	}
+	obs_log(LOG_INFO, "弹幕服务器已连接: %s", url.c_str());
+
+	auto lastHeartbeat = Clock::now();
+	auto lastReceive = Clock::now();
+	auto lastStats = Clock::now();
+	// 完整帧直接在接收缓冲上原地解包；只有跨多次读取的大帧才拼接到 frame
+	std::vector<char> buffer(64 * 1024);
+	std::string frame;
+
+	while (!m_stop) {
+		auto now = Clock::now();
+		if (now - lastHeartbeat >= kHeartbeatInterval) {
+			if (!sendAll(curl, sock, heartbeat, m_stop))
+				break;
+			lastHeartbeat = now;
+		}
+		if (now - lastReceive >= kSilenceTimeout) {
+			obs_log(LOG_WARNING, "弹幕服务器长时间无数据");
+			break;
+		}
+		if (now - lastStats >= kStatsInterval) {
+			lastStats = now;
+			obs_log(LOG_INFO, "弹幕统计: 帧 %llu, 包 %llu, 事件 %llu, 字节 %llu, 错误 %llu",
+				(unsigned long long)m_frames.load(), (unsigned long long)m_packets.load(),
+				(unsigned long long)m_events.load(), (unsigned long long)m_bytes.load(),
+				(unsigned long long)m_errors.load());
+		}
+
+		// 最多等待 200ms，保证 stop() 和心跳能及时得到处理
+		if (!waitSocket(sock, false, 200))
+			continue;
+
+		bool closed = false;
+		while (true) {
+			size_t received = 0;
+			const struct curl_ws_frame *meta = nullptr;
+			res = wsRecv(curl_ws_recv, curl, buffer.data(), buffer.size(), &received, &meta);
+			if (res == CURLE_AGAIN)
+				break;
+			if (res != CURLE_OK || !meta) {
+				obs_log(LOG_WARNING, "弹幕连接读取失败: %s", curl_easy_strerror(res));
+				closed = true;
+				break;
+			}
+			lastReceive = Clock::now();
+			if (meta->flags & CURLWS_CLOSE) {
+				closed = true;
+				break;
+			}
+			bool complete = meta->bytesleft == 0 && !(meta->flags & CURLWS_CONT);
+			if (complete && frame.empty()) {
+				if (meta->flags & CURLWS_BINARY)
+					handleFrame(buffer.data(), received);
+				continue;
+			}
+			frame.append(buffer.data(), received);
+			if (complete) {
+				if (meta->flags & CURLWS_BINARY)
+					handleFrame(frame.data(), frame.size());
+				frame.clear();
+			}
+		}
+		if (closed)
+			break;
+	}
+
+	curl_easy_cleanup(curl);
+	curl_slist_free_all(headers);
+}
+
+void DanmakuClient::handleFrame(const char *data, size_t len)
+{
+	++m_frames;
+	m_bytes += len;
+
+	std::string err;
+	if (!m_decoder.decode(data, len, m_packetViews, err)) {
+		++m_errors;
+		obs_log(LOG_WARNING, "弹幕帧解析失败: %s", err.c_str());
+	}
+	m_packets += m_packetViews.size();
+
+	for (const auto &packet : m_packetViews) {
+		Event event;
+		if (packet.op == OP_MESSAGE) {
+			if (!parseMessage(packet.body, event))
+				continue;
+		} else if (packet.op == OP_HEARTBEAT_REPLY && packet.body.size() >= 4) {
+			auto u = reinterpret_cast<const unsigned char *>(packet.body.data());
+			event.type = EventType::ViewerCount;
+			event.value = (int64_t(u[0]) << 24) | (int64_t(u[1]) << 16) | (int64_t(u[2]) << 8) | u[3];
+		} else if (packet.op == OP_AUTH_REPLY) {
+			obs_log(LOG_INFO, "弹幕鉴权结果: %.*s", static_cast<int>(packet.body.size()), packet.body.data());
+			continue;
+		} else {
+			continue;
+		}
+		event.timestamp_ms = nowMs();
+		++m_events;
+		if (m_handler)
+			m_handler(std::move(event));
+	}
+}
+} // namespace Danmaku
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "danmaku/danmaku_event.hpp"
+#include "danmaku/danmaku_protocol.hpp"
+
+namespace Danmaku {
+struct ClientOptions {
+	std::string room_id;
+	int64_t uid = 0;
+	std::string cookies;
+	// 直接连接指定地址（如本地测试服务 ws://127.0.0.1:9000/sub），为空时通过 getDanmuInfo 获取
+	std::string url;
+	std::string token;
+};
+
+struct ClientStats {
+	uint64_t frames = 0;
+	uint64_t packets = 0;
+	uint64_t events = 0;
+	uint64_t bytes = 0;
+	uint64_t errors = 0;
+	uint64_t reconnects = 0;
+};
+
+// 弹幕 websocket 客户端：独立网络线程负责连接、鉴权、心跳和解包，事件回调也在该线程上执行
+class DanmakuClient {
+public:
+	using EventHandler = std::function<void(Event &&event)>;
+
+	explicit DanmakuClient(EventHandler handler);
+	~DanmakuClient();
+	DanmakuClient(const DanmakuClient &) = delete;
+	DanmakuClient &operator=(const DanmakuClient &) = delete;
+
+	// 7.x 的 libcurl 只有以 --enable-websockets 构建时才支持 ws / wss，8.11 起默认开启
+	static bool supported();
+
+	// 运行时的 libcurl 不支持 wss 时记录错误并不启动网络线程
+	void start(const ClientOptions &options);
+	void stop();
+	bool running() const { return m_thread.joinable(); }
+	ClientStats stats() const;
+
+private:
+	void run();
+	void serve(const std::string &url, const std::string &token);
+	void handleFrame(const char *data, size_t len);
+	bool sleepFor(int ms);
+
+	EventHandler m_handler;
+	ClientOptions m_options;
+	FrameDecoder m_decoder;
+	std::vector<PacketView> m_packetViews;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::atomic<bool> m_stop{false};
+
+	std::atomic<uint64_t> m_frames{0};
+	std::atomic<uint64_t> m_packets{0};
+	std::atomic<uint64_t> m_events{0};
+	std::atomic<uint64_t> m_bytes{0};
+	std::atomic<uint64_t> m_errors{0};
+	std::atomic<uint64_t> m_reconnects{0};
+};
+} // namespace Danmaku
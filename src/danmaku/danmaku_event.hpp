@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Danmaku {
+enum class EventType : uint8_t {
+	Chat = 1,
+	Gift = 2,
+	StatusChange = 3,
+	ViewerCount = 4,
+};
+
+// 直播间事件；不同类型只使用其中部分字段
+struct Event {
+	EventType type = EventType::Chat;
+	int64_t timestamp_ms = 0;
+	int64_t uid = 0;
+	std::string uname;
+	std::string text;      // Chat: 弹幕内容；Gift: 礼物名
+	int64_t gift_id = 0;   // Gift
+	int64_t gift_num = 0;  // Gift
+	int64_t gift_price = 0; // Gift: 单价（金瓜子）
+	int64_t value = 0;     // StatusChange: 1 开播 / 0 下播；ViewerCount: 人数 / 人气值
+};
+} // namespace Danmaku
@@ -0,0 +1,306 @@
+#include "danmaku/danmaku_protocol.hpp"
+#include <zlib.h>
+#include <algorithm>
+#ifdef HAVE_BROTLI
+#include <brotli/decode.h>
+#endif
+#include "json11/json11.hpp"
+
+namespace Danmaku {
+static const int max_nesting = 4;
+// 单个压缩包解压后的上限，正常的弹幕合包只有几 KB 到几十 KB
+static const size_t max_inflated = 4 * 1024 * 1024;
+
+static uint32_t readBE32(const char *p)
+{
+	auto u = reinterpret_cast<const unsigned char *>(p);
+	return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+static uint16_t readBE16(const char *p)
+{
+	auto u = reinterpret_cast<const unsigned char *>(p);
+	return static_cast<uint16_t>((u[0] << 8) | u[1]);
+}
+
+static void writeBE32(std::string &out, uint32_t v)
+{
+	out += static_cast<char>((v >> 24) & 0xFF);
+	out += static_cast<char>((v >> 16) & 0xFF);
+	out += static_cast<char>((v >> 8) & 0xFF);
+	out += static_cast<char>(v & 0xFF);
+}
+
+static void writeBE16(std::string &out, uint16_t v)
+{
+	out += static_cast<char>((v >> 8) & 0xFF);
+	out += static_cast<char>(v & 0xFF);
+}
+
+std::string encodePacket(uint32_t op, const std::string &body)
+{
+	std::string out;
+	out.reserve(kHeaderSize + body.size());
+	writeBE32(out, static_cast<uint32_t>(kHeaderSize + body.size()));
+	writeBE16(out, static_cast<uint16_t>(kHeaderSize));
+	writeBE16(out, PROTO_INT32);
+	writeBE32(out, op);
+	writeBE32(out, 1);
+	out += body;
+	return out;
+}
+
+struct FrameDecoder::Inflater {
+	z_stream zlib = {};
+	bool zlib_ready = false;
+
+	~Inflater()
+	{
+		if (zlib_ready)
+			inflateEnd(&zlib);
+	}
+};
+
+FrameDecoder::FrameDecoder() : m_inflater(std::make_unique<Inflater>()) {}
+
+FrameDecoder::~FrameDecoder() = default;
+
+std::string &FrameDecoder::nextBuffer()
+{
+	if (m_used == m_buffers.size())
+		m_buffers.emplace_back();
+	std::string &buffer = m_buffers[m_used++];
+	buffer.clear();
+	return buffer;
+}
+
+// 为下一次解压准备输出空间，总长不超过 max_inflated；已达上限时返回 false
+static bool growOutput(std::string &out, size_t &used, std::string &err)
+{
+	used = out.size();
+	if (used >= max_inflated) {
+		err = "解压后数据超过 4 MB 上限";
+		return false;
+	}
+	if (out.capacity() - used < 4096)
+		out.reserve(std::min(out.capacity() * 2, max_inflated));
+	out.resize(std::min(out.capacity(), max_inflated));
+	return true;
+}
+
+static bool inflateZlib(z_stream &stream, bool &ready, const char *data, size_t len, std::string &out,
+			std::string &err)
+{
+	// z_stream 跨包复用，只做 reset，避免每个包都重新分配内部窗口
+	if (!ready) {
+		if (inflateInit(&stream) != Z_OK) {
+			err = "zlib 初始化失败";
+			return false;
+		}
+		ready = true;
+	} else {
+		inflateReset(&stream);
+	}
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	stream.avail_in = static_cast<uInt>(len);
+
+	if (out.capacity() < len * 4)
+		out.reserve(std::min(len * 4, max_inflated));
+	int ret;
+	do {
+		size_t used;
+		if (!growOutput(out, used, err))
+			return false;
+		stream.next_out = reinterpret_cast<Bytef *>(&out[used]);
+		stream.avail_out = static_cast<uInt>(out.size() - used);
+		ret = inflate(&stream, Z_NO_FLUSH);
+		out.resize(out.size() - stream.avail_out);
+		if (ret != Z_OK && ret != Z_STREAM_END) {
+			err = "zlib 解压失败";
+			return false;
+		}
+		// 输入耗尽且输出缓冲未满：数据被截断
+		if (ret == Z_OK && stream.avail_in == 0 && stream.avail_out != 0)
+			break;
+	} while (ret != Z_STREAM_END);
+	return true;
+}
+
+#ifdef HAVE_BROTLI
+static bool inflateBrotli(const char *data, size_t len, std::string &out, std::string &err)
+{
+	BrotliDecoderState *state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+	if (!state) {
+		err = "brotli 初始化失败";
+		return false;
+	}
+	size_t avail_in = len;
+	const uint8_t *next_in = reinterpret_cast<const uint8_t *>(data);
+	if (out.capacity() < len * 4)
+		out.reserve(std::min(len * 4, max_inflated));
+	BrotliDecoderResult result;
+	do {
+		size_t used;
+		if (!growOutput(out, used, err)) {
+			BrotliDecoderDestroyInstance(state);
+			return false;
+		}
+		size_t avail_out = out.size() - used;
+		uint8_t *next_out = reinterpret_cast<uint8_t *>(&out[used]);
+		result = BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+		out.resize(out.size() - avail_out);
+	} while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+	BrotliDecoderDestroyInstance(state);
+	if (result != BROTLI_DECODER_RESULT_SUCCESS) {
+		err = "brotli 解压失败";
+		return false;
+	}
+	return true;
+}
+#endif
+
+// 解压失败时返回 false；超过上限的包可能是恶意的，连同已解出的包整帧丢弃
+static bool dropOversized(const std::string &inflated, std::vector<PacketView> &out)
+{
+	if (inflated.size() >= max_inflated)
+		out.clear();
+	return false;
+}
+
+bool FrameDecoder::walk(const char *data, size_t len, std::vector<PacketView> &out, std::string &err, int depth)
+{
+	if (depth > max_nesting) {
+		err = "压缩包嵌套过深";
+		return false;
+	}
+
+	size_t offset = 0;
+	while (offset < len) {
+		if (len - offset < kHeaderSize) {
+			err = "包头不完整";
+			return false;
+		}
+		const char *header = data + offset;
+		uint32_t packet_len = readBE32(header);
+		uint16_t header_len = readBE16(header + 4);
+		if (packet_len < header_len || header_len < kHeaderSize || packet_len > len - offset) {
+			err = "包长度无效";
+			return false;
+		}
+
+		PacketView packet;
+		packet.version = readBE16(header + 6);
+		packet.op = readBE32(header + 8);
+		const char *body = header + header_len;
+		size_t body_len = packet_len - header_len;
+
+		if (packet.op == OP_MESSAGE && packet.version == PROTO_ZLIB) {
+			std::string &inflated = nextBuffer();
+			if (!inflateZlib(m_inflater->zlib, m_inflater->zlib_ready, body, body_len, inflated, err))
+				return dropOversized(inflated, out);
+			if (!walk(inflated.data(), inflated.size(), out, err, depth + 1))
+				return false;
+#ifdef HAVE_BROTLI
+		} else if (packet.op == OP_MESSAGE && packet.version == PROTO_BROTLI) {
+			std::string &inflated = nextBuffer();
+			if (!inflateBrotli(body, body_len, inflated, err))
+				return dropOversized(inflated, out);
+			if (!walk(inflated.data(), inflated.size(), out, err, depth + 1))
+				return false;
+#endif
+		} else {
+			packet.body = std::string_view(body, body_len);
+			out.push_back(packet);
+		}
+		offset += packet_len;
+	}
+	return true;
+}
+
+bool FrameDecoder::decode(const char *data, size_t len, std::vector<PacketView> &out, std::string &err)
+{
+	out.clear();
+	m_used = 0;
+	return walk(data, len, out, err, 0);
+}
+
+std::string_view peekCommand(std::string_view body)
+{
+	// 服务器下发的消息 cmd 几乎总在开头附近，只在前 64 字节里找
+	static const std::string_view key = "\"cmd\"";
+	size_t pos = body.substr(0, 64).find(key);
+	if (pos == std::string_view::npos)
+		return {};
+	pos += key.size();
+	while (pos < body.size() && (body[pos] == ' ' || body[pos] == ':'))
+		++pos;
+	if (pos >= body.size() || body[pos] != '"')
+		return {};
+	size_t end = body.find('"', ++pos);
+	if (end == std::string_view::npos)
+		return {};
+	return body.substr(pos, end - pos);
+}
+
+static int64_t toInt64(const json11::Json &value)
+{
+	// json11 的 int_value() 只有 32 位，uid 等字段按 double 读取（2^53 以内精确）
+	if (value.is_string())
+		return strtoll(std::string(value.string_view_value()).c_str(), nullptr, 10);
+	return static_cast<int64_t>(value.number_value());
+}
+
+static bool isInteresting(std::string_view cmd)
+{
+	return cmd.substr(0, 9) == "DANMU_MSG" || cmd == "SEND_GIFT" || cmd == "LIVE" || cmd == "PREPARING" ||
+	       cmd == "WATCHED_CHANGE";
+}
+
+bool parseMessage(std::string_view body, Event &event)
+{
+	// 忙碌的直播间里大部分消息（INTERACT_WORD、ONLINE_RANK_V2 等）用不到，先看 cmd 再决定是否解析
+	std::string_view peeked = peekCommand(body);
+	if (!peeked.empty() && !isInteresting(peeked))
+		return false;
+
+	// 直接在包体上解析，不拷贝：节点分配在一块 arena 上，不含转义的字符串是指向 body 的视图。
+	// 下面取到的引用都不会越过 json 与 body 的生命周期，需要保留的内容都拷进 event
+	std::string err;
+	json11::Json json = json11::Json::parse(body, err, json11::JsonParse::STANDARD, json11::JsonAlloc::ARENA,
+						json11::JsonStrings::BORROW);
+	if (!err.empty())
+		return false;
+
+	std::string_view cmd = json["cmd"].string_view_value();
+	if (cmd.substr(0, 9) == "DANMU_MSG") {
+		const auto &info = json["info"];
+		event.type = EventType::Chat;
+		event.text = info[1].string_view_value();
+		event.uid = toInt64(info[2][0]);
+		event.uname = info[2][1].string_view_value();
+		return true;
+	}
+	if (cmd == "SEND_GIFT") {
+		const auto &data = json["data"];
+		event.type = EventType::Gift;
+		event.uid = toInt64(data["uid"]);
+		event.uname = data["uname"].string_view_value();
+		event.text = data["giftName"].string_view_value();
+		event.gift_id = toInt64(data["giftId"]);
+		event.gift_num = toInt64(data["num"]);
+		event.gift_price = toInt64(data["price"]);
+		return true;
+	}
+	if (cmd == "LIVE" || cmd == "PREPARING") {
+		event.type = EventType::StatusChange;
+		event.value = cmd == "LIVE" ? 1 : 0;
+		return true;
+	}
+	if (cmd == "WATCHED_CHANGE") {
+		event.type = EventType::ViewerCount;
+		event.value = toInt64(json["data"]["num"]);
+		return true;
+	}
+	return false;
+}
+} // namespace Danmaku
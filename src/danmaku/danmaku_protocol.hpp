@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "danmaku/danmaku_event.hpp"
+
+namespace Danmaku {
+// 弹幕服务器二进制协议：每个包 16 字节大端头（包长、头长、协议版本、操作码、序号）+ 包体
+enum Operation : uint32_t {
+	OP_HEARTBEAT = 2,
+	OP_HEARTBEAT_REPLY = 3,
+	OP_MESSAGE = 5,
+	OP_AUTH = 7,
+	OP_AUTH_REPLY = 8,
+};
+
+enum ProtocolVersion : uint16_t {
+	PROTO_JSON = 0,
+	PROTO_INT32 = 1,
+	PROTO_ZLIB = 2,
+	PROTO_BROTLI = 3,
+};
+
+static const size_t kHeaderSize = 16;
+
+// 包体视图，指向接收缓冲或 FrameDecoder 内部的解压缓冲
+struct PacketView {
+	uint16_t version = 0;
+	uint32_t op = 0;
+	std::string_view body;
+};
+
+std::string encodePacket(uint32_t op, const std::string &body);
+
+// 原地遍历 websocket 帧中拼接的子包，压缩包解压到复用的内部缓冲后继续展开。
+// 输出的视图在下一次 decode() 之前有效。单个压缩包解压后超过 4 MB 时整帧丢弃，out 为空。
+class FrameDecoder {
+public:
+	FrameDecoder();
+	~FrameDecoder();
+
+	bool decode(const char *data, size_t len, std::vector<PacketView> &out, std::string &err);
+
+private:
+	struct Inflater;
+
+	bool walk(const char *data, size_t len, std::vector<PacketView> &out, std::string &err, int depth);
+	std::string &nextBuffer();
+
+	std::unique_ptr<Inflater> m_inflater;
+	// deque 追加时不移动已有元素，已输出的视图保持有效
+	std::deque<std::string> m_buffers;
+	size_t m_used = 0;
+};
+
+// 取包体中的 cmd 字段而不解析整个 JSON；找不到时返回空视图
+std::string_view peekCommand(std::string_view body);
+
+// 将一个 OP_MESSAGE 包体解析为事件；不关心的 cmd 在解析 JSON 之前就被跳过并返回 false
+bool parseMessage(std::string_view body, Event &event);
+} // namespace Danmaku
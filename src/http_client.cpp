@@ -1,5 +1,6 @@
 #include "http_client.hpp"
 #include <curl/curl.h>
+#include <cctype>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -14,12 +15,38 @@ static size_t writeCallback(void *contents, size_t size, size_t nmemb, void *use
 	return realsize;
 }
 
+static bool headerIs(const char *buffer, size_t len, const char *name)
+{
+	size_t n = strlen(name);
+	if (len <= n)
+		return false;
+	for (size_t i = 0; i < n; ++i) {
+		if (tolower(static_cast<unsigned char>(buffer[i])) != name[i])
+			return false;
+	}
+	return true;
+}
+
+struct HeaderData {
+	std::string cookies;
+	std::string etag;
+};
+
 static size_t headerCallback(char *buffer, size_t size, size_t nitems, void *userp)
 {
 	size_t realsize = size * nitems;
-	auto *cookies = static_cast<std::string *>(userp);
-	const char *set_cookie = "Set-Cookie: ";
-	if (strncmp(buffer, set_cookie, strlen(set_cookie)) == 0) {
+	auto *headers = static_cast<HeaderData *>(userp);
+	auto *cookies = &headers->cookies;
+	const char *set_cookie = "set-cookie: ";
+	const char *etag = "etag: ";
+	if (headerIs(buffer, realsize, etag)) {
+		headers->etag.assign(buffer + strlen(etag), realsize - strlen(etag));
+		while (!headers->etag.empty() && (headers->etag.back() == '\r' || headers->etag.back() == '\n'))
+			headers->etag.pop_back();
+		return realsize;
+	}
+	// HTTP/2 下头部名为小写
+	if (headerIs(buffer, realsize, set_cookie)) {
 		std::string cookie(buffer + strlen(set_cookie), realsize - strlen(set_cookie));
 		size_t end = cookie.find(';');
 		if (end != std::string::npos)
@@ -41,8 +68,32 @@ struct AsyncRequest {
 	std::function<void(HttpResponse)> callback;
 	bool is_post;
 	long timeout_ms;
+	std::function<void()> task; // 非空时只执行 task
 };
 
+// HttpClient 的一次性请求共享 DNS 缓存和 TLS 会话，新连接可以跳过解析并恢复 TLS 会话。
+// 连接缓存不共享：libcurl 不支持多个线程同时使用共享的连接池，需要复用连接时用 HttpSession
+static CURLSH *share = nullptr;
+static std::mutex share_locks[CURL_LOCK_DATA_LAST];
+
+static void shareLock(CURL *, curl_lock_data data, curl_lock_access, void *)
+{
+	share_locks[data].lock();
+}
+
+static void shareUnlock(CURL *, curl_lock_data data, void *)
+{
+	share_locks[data].unlock();
+}
+
+static CURL *createHandle()
+{
+	CURL *curl = curl_easy_init();
+	if (curl && share)
+		curl_easy_setopt(curl, CURLOPT_SHARE, share);
+	return curl;
+}
+
 static std::queue<AsyncRequest> async_queue;
 static std::mutex queue_mutex;
 static std::condition_variable queue_cv;
@@ -60,6 +111,10 @@ static void workerLoop()
 		async_queue.pop();
 		lock.unlock();
 
+		if (req.task) {
+			req.task();
+			continue;
+		}
 		HttpResponse response;
 		if (req.is_post) {
 			response = HttpClient::post(req.url, req.data, req.headers, req.timeout_ms);
@@ -73,6 +128,13 @@ static void workerLoop()
 void HttpClient::init()
 {
 	curl_global_init(CURL_GLOBAL_ALL);
+	share = curl_share_init();
+	if (share) {
+		curl_share_setopt(share, CURLSHOPT_LOCKFUNC, shareLock);
+		curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, shareUnlock);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
 	stop_worker = false;
 	worker_thread = std::thread(workerLoop);
 }
@@ -86,28 +148,46 @@ void HttpClient::cleanup()
 	queue_cv.notify_all();
 	if (worker_thread.joinable())
 		worker_thread.join();
+	if (share) {
+		curl_share_cleanup(share);
+		share = nullptr;
+	}
 	curl_global_cleanup();
 }
 
-HttpResponse HttpClient::get(const std::string &url, const std::vector<std::string> &headers, long timeout_ms)
+static int abortCallback(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+	auto *abort = static_cast<const std::atomic<bool> *>(clientp);
+	return abort->load() ? 1 : 0;
+}
+
+static HttpResponse perform(CURL *curl, const std::string &url, const std::string *post_data,
+			    const std::vector<std::string> &headers, long timeout_ms,
+			    const std::atomic<bool> *abort = nullptr)
 {
 	HttpResponse response;
 	response.status = 0;
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		response.data = "CURL 初始化失败";
-		return response;
-	}
 
 	std::string response_data;
-	std::string response_cookies;
+	HeaderData response_headers;
 	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+	if (post_data) {
+		curl_easy_setopt(curl, CURLOPT_POST, 1L);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data->c_str());
+	} else {
+		curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+	}
 	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
 	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
 	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
-	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_cookies);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_headers);
 	curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
 	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	if (abort) {
+		curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abortCallback);
+		curl_easy_setopt(curl, CURLOPT_XFERINFODATA, abort);
+	}
 
 	struct curl_slist *header_list = nullptr;
 	for (const auto &header : headers) {
@@ -116,66 +196,47 @@ HttpResponse HttpClient::get(const std::string &url, const std::vector<std::stri
 	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
 
 	CURLcode res = curl_easy_perform(curl);
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+	curl_slist_free_all(header_list);
 	if (res != CURLE_OK) {
 		response.timeout = (res == CURLE_OPERATION_TIMEDOUT);
 		response.data = std::string("网络错误: ") + curl_easy_strerror(res);
 		response.status = 0;
-		curl_slist_free_all(header_list);
-		curl_easy_cleanup(curl);
 		return response;
 	}
 
 	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
 	response.data = std::move(response_data);
-	response.cookies = std::move(response_cookies);
-	curl_slist_free_all(header_list);
-	curl_easy_cleanup(curl);
+	response.cookies = std::move(response_headers.cookies);
+	response.etag = std::move(response_headers.etag);
 	return response;
 }
 
-HttpResponse HttpClient::post(const std::string &url, const std::string &data,
-			      const std::vector<std::string> &headers, long timeout_ms)
+HttpResponse HttpClient::get(const std::string &url, const std::vector<std::string> &headers, long timeout_ms)
 {
-	HttpResponse response;
-	response.status = 0;
-	CURL *curl = curl_easy_init();
+	CURL *curl = createHandle();
 	if (!curl) {
+		HttpResponse response;
+		response.status = 0;
 		response.data = "CURL 初始化失败";
 		return response;
 	}
+	HttpResponse response = perform(curl, url, nullptr, headers, timeout_ms);
+	curl_easy_cleanup(curl);
+	return response;
+}
 
-	std::string response_data;
-	std::string response_cookies;
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-	curl_easy_setopt(curl, CURLOPT_POST, 1L);
-	curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
-	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_cookies);
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
-	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-
-	struct curl_slist *header_list = nullptr;
-	for (const auto &header : headers) {
-		header_list = curl_slist_append(header_list, header.c_str());
-	}
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
-
-	CURLcode res = curl_easy_perform(curl);
-	if (res != CURLE_OK) {
-		response.timeout = (res == CURLE_OPERATION_TIMEDOUT);
-		response.data = std::string("网络错误: ") + curl_easy_strerror(res);
+HttpResponse HttpClient::post(const std::string &url, const std::string &data,
+			      const std::vector<std::string> &headers, long timeout_ms)
+{
+	CURL *curl = createHandle();
+	if (!curl) {
+		HttpResponse response;
 		response.status = 0;
-		curl_slist_free_all(header_list);
-		curl_easy_cleanup(curl);
+		response.data = "CURL 初始化失败";
 		return response;
 	}
-
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
-	response.data = std::move(response_data);
-	response.cookies = std::move(response_cookies);
-	curl_slist_free_all(header_list);
+	HttpResponse response = perform(curl, url, &data, headers, timeout_ms);
 	curl_easy_cleanup(curl);
 	return response;
 }
@@ -185,7 +246,7 @@ void HttpClient::getAsync(const std::string &url, const std::vector<std::string>
 {
 	{
 		std::lock_guard<std::mutex> lock(queue_mutex);
-		async_queue.push({url, "", headers, callback, false, timeout_ms});
+		async_queue.push({url, "", headers, callback, false, timeout_ms, nullptr});
 	}
 	queue_cv.notify_one();
 }
@@ -196,8 +257,48 @@ void HttpClient::postAsync(const std::string &url, const std::string &data,
 {
 	{
 		std::lock_guard<std::mutex> lock(queue_mutex);
-		async_queue.push({url, data, headers, callback, true, timeout_ms});
+		async_queue.push({url, data, headers, callback, true, timeout_ms, nullptr});
+	}
+	queue_cv.notify_one();
+}
+
+void HttpClient::runAsync(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queue_mutex);
+		async_queue.push({"", "", {}, nullptr, false, 0, std::move(task)});
 	}
 	queue_cv.notify_one();
 }
+
+HttpSession::HttpSession() : m_curl(curl_easy_init()) {}
+
+HttpSession::~HttpSession()
+{
+	if (m_curl)
+		curl_easy_cleanup(static_cast<CURL *>(m_curl));
+}
+
+HttpResponse HttpSession::get(const std::string &url, const std::vector<std::string> &headers, long timeout_ms)
+{
+	if (!m_curl) {
+		HttpResponse response;
+		response.status = 0;
+		response.data = "CURL 初始化失败";
+		return response;
+	}
+	return perform(static_cast<CURL *>(m_curl), url, nullptr, headers, timeout_ms, m_abort);
+}
+
+HttpResponse HttpSession::post(const std::string &url, const std::string &data,
+			       const std::vector<std::string> &headers, long timeout_ms)
+{
+	if (!m_curl) {
+		HttpResponse response;
+		response.status = 0;
+		response.data = "CURL 初始化失败";
+		return response;
+	}
+	return perform(static_cast<CURL *>(m_curl), url, &data, headers, timeout_ms, m_abort);
+}
 } // namespace Http
@@ -3,12 +3,14 @@
 #include <vector>
 #include <cstring>
 #include <functional>
+#include <atomic>
 
 namespace Http {
 struct HttpResponse {
 	long status;
 	std::string data;
 	std::string cookies;
+	std::string etag;
 	bool timeout = false;
 };
 
@@ -25,5 +27,28 @@ public:
 	static void postAsync(const std::string &url, const std::string &data,
 			      const std::vector<std::string> &headers,
 			      std::function<void(HttpResponse)> callback, long timeout_ms = 10000);
+	// 在 HTTP 工作线程上执行 task，与异步请求按提交顺序排队
+	static void runAsync(std::function<void()> task);
+};
+
+// 持有一个 CURL 句柄，连续请求复用同一条连接；不是线程安全的，只应在一个线程内使用
+class HttpSession {
+public:
+	HttpSession();
+	~HttpSession();
+	HttpSession(const HttpSession &) = delete;
+	HttpSession &operator=(const HttpSession &) = delete;
+
+	HttpResponse get(const std::string &url, const std::vector<std::string> &headers = {},
+			 long timeout_ms = 10000);
+	HttpResponse post(const std::string &url, const std::string &data,
+			  const std::vector<std::string> &headers = {}, long timeout_ms = 10000);
+
+	// 标志置位后，进行中的请求会被立即中断（用于后台线程快速退出）
+	void setAbortFlag(const std::atomic<bool> *abort) { m_abort = abort; }
+
+private:
+	void *m_curl;
+	const std::atomic<bool> *m_abort = nullptr;
 };
 } // namespace Http
@@ -20,12 +20,33 @@
  */
 
 #include "json11.hpp"
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <functional>
 #include <limits>
+#include <new>
+
+#if !defined(JSON11_NO_SIMD)
+#if defined(__AVX2__)
+#define JSON11_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON11_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define JSON11_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && (defined(JSON11_SIMD_AVX2) || defined(JSON11_SIMD_SSE2) || defined(JSON11_SIMD_NEON))
+#include <intrin.h>
+#endif
 
 namespace json11 {
 
@@ -33,7 +54,6 @@ static const int max_depth = 200;
 
 using std::string;
 using std::vector;
-using std::map;
 using std::make_shared;
 using std::initializer_list;
 using std::move;
@@ -79,7 +99,7 @@ static void dump(bool value, string &out)
 	out += value ? "true" : "false";
 }
 
-static void dump(const string &value, string &out)
+static void dump(std::string_view value, string &out)
 {
 	out += '"';
 	for (size_t i = 0; i < value.length(); i++) {
@@ -102,12 +122,10 @@ static void dump(const string &value, string &out)
 			char buf[8];
 			snprintf(buf, sizeof buf, "\\u%04x", ch);
 			out += buf;
-		} else if (static_cast<uint8_t>(ch) == 0xe2 && static_cast<uint8_t>(value[i + 1]) == 0x80 &&
-			   static_cast<uint8_t>(value[i + 2]) == 0xa8) {
+		} else if (value.compare(i, 3, "\xe2\x80\xa8") == 0) {
 			out += "\\u2028";
 			i += 2;
-		} else if (static_cast<uint8_t>(ch) == 0xe2 && static_cast<uint8_t>(value[i + 1]) == 0x80 &&
-			   static_cast<uint8_t>(value[i + 2]) == 0xa9) {
+		} else if (value.compare(i, 3, "\xe2\x80\xa9") == 0) {
 			out += "\\u2029";
 			i += 2;
 		} else {
@@ -183,6 +201,8 @@ class JsonDouble final : public Value<Json::NUMBER, double> {
 	bool equals(const JsonValue *other) const override { return m_value == other->number_value(); }
 	bool less(const JsonValue *other) const override { return m_value < other->number_value(); }
 
+	std::shared_ptr<JsonValue> clone() const override { return make_shared<JsonDouble>(m_value); }
+
 public:
 	explicit JsonDouble(double value) : Value(value) {}
 };
@@ -193,12 +213,15 @@ class JsonInt final : public Value<Json::NUMBER, int> {
 	bool equals(const JsonValue *other) const override { return m_value == other->number_value(); }
 	bool less(const JsonValue *other) const override { return m_value < other->number_value(); }
 
+	std::shared_ptr<JsonValue> clone() const override { return make_shared<JsonInt>(m_value); }
+
 public:
 	explicit JsonInt(int value) : Value(value) {}
 };
 
 class JsonBoolean final : public Value<Json::BOOL, bool> {
 	bool bool_value() const override { return m_value; }
+	std::shared_ptr<JsonValue> clone() const override;
 
 public:
 	explicit JsonBoolean(bool value) : Value(value) {}
@@ -206,15 +229,85 @@ public:
 
 class JsonString final : public Value<Json::STRING, string> {
 	const string &string_value() const override { return m_value; }
+	std::string_view string_view_value() const override { return m_value; }
+	// The other side may be a JsonBorrowedString
+	bool equals(const JsonValue *other) const override { return string_view_value() == other->string_view_value(); }
+	bool less(const JsonValue *other) const override { return string_view_value() < other->string_view_value(); }
+	std::shared_ptr<JsonValue> clone() const override { return make_shared<JsonString>(m_value); }
 
 public:
 	explicit JsonString(const string &value) : Value(value) {}
 	explicit JsonString(string &&value) : Value(std::move(value)) {}
 };
 
+/* JsonBorrowedString
+ *
+ * String node of a JsonStrings::BORROW parse: a view of the input bytes. string_value() has to
+ * return a std::string, so the first call makes one (safely against concurrent readers) and
+ * keeps it. Debug builds hash the viewed bytes on construction and assert on every access that
+ * the input is still the same.
+ */
+class JsonBorrowedString final : public JsonValue {
+public:
+	explicit JsonBorrowedString(std::string_view value) : m_view(value)
+	{
+#ifndef NDEBUG
+		m_check = hash(value);
+#endif
+	}
+	~JsonBorrowedString() override { delete m_copy.load(std::memory_order_acquire); }
+
+private:
+	Json::Type type() const override { return Json::STRING; }
+	bool equals(const JsonValue *other) const override { return string_view_value() == other->string_view_value(); }
+	bool less(const JsonValue *other) const override { return string_view_value() < other->string_view_value(); }
+	void dump(string &out) const override { json11::dump(string_view_value(), out); }
+	std::shared_ptr<JsonValue> clone() const override
+	{
+		return make_shared<JsonString>(string(string_view_value()));
+	}
+
+	std::string_view string_view_value() const override
+	{
+#ifndef NDEBUG
+		assert(hash(m_view) == m_check && "json11: input of a BORROW parse was modified or freed");
+#endif
+		return m_view;
+	}
+
+	const string &string_value() const override
+	{
+		const string *copy = m_copy.load(std::memory_order_acquire);
+		if (copy)
+			return *copy;
+		string *made = new string(string_view_value());
+		string *expected = nullptr;
+		if (m_copy.compare_exchange_strong(expected, made, std::memory_order_acq_rel))
+			return *made;
+		delete made;
+		return *expected;
+	}
+
+#ifndef NDEBUG
+	// FNV-1a
+	static uint64_t hash(std::string_view bytes)
+	{
+		uint64_t h = 14695981039346656037ull;
+		for (char c : bytes)
+			h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+		return h;
+	}
+	uint64_t m_check;
+#endif
+	const std::string_view m_view;
+	mutable std::atomic<string *> m_copy{nullptr};
+};
+
 class JsonArray final : public Value<Json::ARRAY, Json::array> {
 	const Json::array &array_items() const override { return m_value; }
 	const Json &operator[](size_t i) const override;
+	// Copying the container puts it on the heap and copies each element, which recurses here
+	std::shared_ptr<JsonValue> clone() const override { return make_shared<JsonArray>(m_value); }
 
 public:
 	explicit JsonArray(const Json::array &value) : Value(value) {}
@@ -224,6 +317,7 @@ public:
 class JsonObject final : public Value<Json::OBJECT, Json::object> {
 	const Json::object &object_items() const override { return m_value; }
 	const Json &operator[](const string &key) const override;
+	std::shared_ptr<JsonValue> clone() const override { return make_shared<JsonObject>(m_value); }
 
 public:
 	explicit JsonObject(const Json::object &value) : Value(value) {}
@@ -231,6 +325,8 @@ public:
 };
 
 class JsonNull final : public Value<Json::NUL, NullStruct> {
+	std::shared_ptr<JsonValue> clone() const override;
+
 public:
 	JsonNull() : Value({}) {}
 };
@@ -243,8 +339,8 @@ struct Statics {
 	const std::shared_ptr<JsonValue> t = make_shared<JsonBoolean>(true);
 	const std::shared_ptr<JsonValue> f = make_shared<JsonBoolean>(false);
 	const string empty_string;
-	const vector<Json> empty_vector;
-	const map<string, Json> empty_map;
+	const Json::array empty_vector;
+	const Json::object empty_map;
 	Statics() {}
 };
 
@@ -254,6 +350,16 @@ static const Statics &statics()
 	return s;
 }
 
+std::shared_ptr<JsonValue> JsonBoolean::clone() const
+{
+	return m_value ? statics().t : statics().f;
+}
+
+std::shared_ptr<JsonValue> JsonNull::clone() const
+{
+	return statics().null;
+}
+
 static const Json &static_null()
 {
 	// This has to be separate, not in Statics, because Json() accesses statics().null.
@@ -261,6 +367,127 @@ static const Json &static_null()
 	return json_null;
 }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * Arena
+ */
+
+/* JsonArena
+ *
+ * Bump allocator behind JsonAlloc::ARENA. Nodes are placement-constructed into its blocks and
+ * referenced through non-owning shared_ptrs (no control block, no reference counting); only the
+ * root returned from parse() shares ownership of the arena. Destruction frees all blocks at once
+ * and runs destructors only for the few nodes that still own heap memory (long strings).
+ */
+class JsonArena final {
+public:
+	explicit JsonArena(size_t first_block) : m_next_size(first_block) {}
+	~JsonArena()
+	{
+		for (Cleanup *cleanup = m_cleanups; cleanup; cleanup = cleanup->next)
+			cleanup->node->~JsonValue();
+		while (m_blocks) {
+			Block *next = m_blocks->next;
+			::operator delete(m_blocks);
+			m_blocks = next;
+		}
+	}
+	JsonArena(const JsonArena &) = delete;
+	JsonArena &operator=(const JsonArena &) = delete;
+
+	// Size the first block so a typical document fits in it without a second allocation.
+	static size_t first_block_for(size_t input_size) { return input_size * 3 + 256; }
+
+	void *allocate(size_t size, size_t align)
+	{
+		uintptr_t cur = (reinterpret_cast<uintptr_t>(m_cur) + align - 1) & ~(uintptr_t)(align - 1);
+		if (!m_cur || cur + size > reinterpret_cast<uintptr_t>(m_end)) {
+			add_block(size + align);
+			cur = (reinterpret_cast<uintptr_t>(m_cur) + align - 1) & ~(uintptr_t)(align - 1);
+		}
+		m_cur = reinterpret_cast<char *>(cur + size);
+		return reinterpret_cast<void *>(cur);
+	}
+
+	template<typename T, typename V> Json make(V &&value)
+	{
+		T *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<V>(value));
+		if (owns_heap(node)) {
+			Cleanup *cleanup = new (allocate(sizeof(Cleanup), alignof(Cleanup))) Cleanup{node, m_cleanups};
+			m_cleanups = cleanup;
+		}
+		return Json(std::shared_ptr<JsonValue>(std::shared_ptr<JsonValue>(), node));
+	}
+
+	// Reference one of the shared static nodes without touching its reference count.
+	static Json borrow(const std::shared_ptr<JsonValue> &node)
+	{
+		return Json(std::shared_ptr<JsonValue>(std::shared_ptr<JsonValue>(), node.get()));
+	}
+
+	// Hand out a heap node of a type that has no public Json constructor.
+	static Json wrap(std::shared_ptr<JsonValue> node) { return Json(std::move(node)); }
+
+	// Make the root of a parse share ownership of the arena holding it.
+	static Json adopt(const std::shared_ptr<JsonArena> &arena, const Json &root)
+	{
+		return Json(std::shared_ptr<JsonValue>(arena, root.m_ptr.get()));
+	}
+
+private:
+	struct Block {
+		Block *next;
+	};
+	struct Cleanup {
+		JsonValue *node;
+		Cleanup *next;
+	};
+
+	static bool is_inline(const string &s)
+	{
+		std::less<const char *> before;
+		const char *self = reinterpret_cast<const char *>(&s);
+		return !before(s.data(), self) && before(s.data(), self + sizeof(s));
+	}
+	static bool owns_heap(const JsonValue *) { return false; }
+	static bool owns_heap(const JsonString *node)
+	{
+		return !is_inline(static_cast<const JsonValue *>(node)->string_value());
+	}
+	// May make a std::string copy later, on first string_value()
+	static bool owns_heap(const JsonBorrowedString *) { return true; }
+	static bool owns_heap(const JsonObject *node)
+	{
+		for (const auto &kv : static_cast<const JsonValue *>(node)->object_items()) {
+			if (!is_inline(kv.first))
+				return true;
+		}
+		return false;
+	}
+
+	void add_block(size_t min_size)
+	{
+		size_t size = m_next_size > min_size ? m_next_size : min_size;
+		const size_t header = (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+		Block *block = static_cast<Block *>(::operator new(header + size));
+		block->next = m_blocks;
+		m_blocks = block;
+		m_cur = reinterpret_cast<char *>(block) + header;
+		m_end = m_cur + size;
+		m_next_size = size * 2;
+	}
+
+	char *m_cur = nullptr;
+	char *m_end = nullptr;
+	Block *m_blocks = nullptr;
+	Cleanup *m_cleanups = nullptr;
+	size_t m_next_size;
+};
+
+void *arena_allocate(JsonArena *arena, size_t size, size_t align)
+{
+	return arena->allocate(size, align);
+}
+
 /* * * * * * * * * * * * * * * * * * * *
  * Constructors
  */
@@ -278,6 +505,24 @@ Json::Json(Json::array &&values) : m_ptr(make_shared<JsonArray>(std::move(values
 Json::Json(const Json::object &values) : m_ptr(make_shared<JsonObject>(values)) {}
 Json::Json(Json::object &&values) : m_ptr(make_shared<JsonObject>(std::move(values))) {}
 
+/* Copying
+ *
+ * Heap nodes and the root of an arena parse are held through a control block. Nodes inside an
+ * arena (and the shared statics they borrow) are referenced without one, so a copy of such a
+ * node could outlive the arena; it is cloned instead. The parser only ever moves nodes.
+ */
+Json::Json(const Json &other)
+	: m_ptr(other.m_ptr && other.m_ptr.use_count() == 0 ? other.m_ptr->clone() : other.m_ptr)
+{
+}
+
+Json &Json::operator=(const Json &other)
+{
+	if (this != &other)
+		m_ptr = Json(other).m_ptr;
+	return *this;
+}
+
 /* * * * * * * * * * * * * * * * * * * *
  * Accessors
  */
@@ -302,11 +547,15 @@ const string &Json::string_value() const
 {
 	return m_ptr->string_value();
 }
-const vector<Json> &Json::array_items() const
+std::string_view Json::string_view_value() const
+{
+	return m_ptr->string_view_value();
+}
+const Json::array &Json::array_items() const
 {
 	return m_ptr->array_items();
 }
-const map<string, Json> &Json::object_items() const
+const Json::object &Json::object_items() const
 {
 	return m_ptr->object_items();
 }
@@ -335,11 +584,15 @@ const string &JsonValue::string_value() const
 {
 	return statics().empty_string;
 }
-const vector<Json> &JsonValue::array_items() const
+std::string_view JsonValue::string_view_value() const
+{
+	return std::string_view();
+}
+const Json::array &JsonValue::array_items() const
 {
 	return statics().empty_vector;
 }
-const map<string, Json> &JsonValue::object_items() const
+const Json::object &JsonValue::object_items() const
 {
 	return statics().empty_map;
 }
@@ -413,6 +666,147 @@ static inline bool in_range(long x, long lower, long upper)
 	return (x >= lower && x <= upper);
 }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * Vectorized scanning
+ *
+ * The parser's two hot loops - skipping whitespace and copying the plain bytes of a string -
+ * look at 32 (AVX2) or 16 (SSE2, NEON) bytes per step. The last partial block is left to the
+ * scalar loop, so each helper returns exactly the position the byte-at-a-time loop would reach.
+ * Define JSON11_NO_SIMD to build the scalar code only.
+ */
+
+static inline bool is_json_space(char c)
+{
+	return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+}
+
+// A byte that ends a run of plain string content: quote, backslash or an unescaped control byte.
+static inline bool is_string_special(char c)
+{
+	return c == '"' || c == '\\' || static_cast<uint8_t>(c) < 0x20;
+}
+
+#if defined(JSON11_SIMD_AVX2) || defined(JSON11_SIMD_SSE2) || defined(JSON11_SIMD_NEON)
+static inline unsigned first_set_bit(uint64_t mask)
+{
+#ifdef _MSC_VER
+	// _BitScanForward64 is not available on 32-bit x86
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(mask)))
+		return static_cast<unsigned>(index);
+	_BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+	return static_cast<unsigned>(index) + 32;
+#else
+	return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+#endif
+
+#if defined(JSON11_SIMD_NEON)
+// One bit per byte is not available on NEON; narrowing gives 4 bits per byte instead.
+static inline uint64_t neon_mask(uint8x16_t matches)
+{
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+}
+#endif
+
+/* skip_whitespace(s, i, end)
+ *
+ * Return the index of the first non-whitespace byte at or after i, or end.
+ */
+static size_t skip_whitespace(const char *s, size_t i, size_t end)
+{
+	// Compact API responses rarely have more than one space in a row: check before vectorizing.
+	if (i < end && !is_json_space(s[i]))
+		return i;
+#if defined(JSON11_SIMD_AVX2)
+	const __m256i space = _mm256_set1_epi8(' '), cr = _mm256_set1_epi8('\r');
+	const __m256i lf = _mm256_set1_epi8('\n'), tab = _mm256_set1_epi8('\t');
+	for (; i + 32 <= end; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+		__m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, cr)),
+					     _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, tab)));
+		uint32_t other = ~static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+		if (other)
+			return i + first_set_bit(other);
+	}
+#elif defined(JSON11_SIMD_SSE2)
+	const __m128i space = _mm_set1_epi8(' '), cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n'), tab = _mm_set1_epi8('\t');
+	for (; i + 16 <= end; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, cr)),
+					  _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, tab)));
+		uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(ws)) & 0xffff;
+		if (other)
+			return i + first_set_bit(other);
+	}
+#elif defined(JSON11_SIMD_NEON)
+	const uint8x16_t space = vdupq_n_u8(' '), cr = vdupq_n_u8('\r');
+	const uint8x16_t lf = vdupq_n_u8('\n'), tab = vdupq_n_u8('\t');
+	for (; i + 16 <= end; i += 16) {
+		uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(s + i));
+		uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, cr)),
+					 vorrq_u8(vceqq_u8(v, lf), vceqq_u8(v, tab)));
+		uint64_t other = ~neon_mask(ws);
+		if (other)
+			return i + first_set_bit(other) / 4;
+	}
+#endif
+	while (i < end && is_json_space(s[i]))
+		i++;
+	return i;
+}
+
+/* scan_string(s, i, end)
+ *
+ * Return the index of the first quote, backslash or control byte at or after i, or end.
+ */
+static size_t scan_string(const char *s, size_t i, size_t end)
+{
+#if defined(JSON11_SIMD_AVX2)
+	const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+	const __m256i control_max = _mm256_set1_epi8(0x1f);
+	for (; i + 32 <= end; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+		// unsigned v <= 0x1f  <=>  min(v, 0x1f) == v
+		__m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, control_max), v);
+		__m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+								  _mm256_cmpeq_epi8(v, backslash)),
+						  control);
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+		if (mask)
+			return i + first_set_bit(mask);
+	}
+#elif defined(JSON11_SIMD_SSE2)
+	const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+	const __m128i control_max = _mm_set1_epi8(0x1f);
+	for (; i + 16 <= end; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		__m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, control_max), v);
+		__m128i special =
+			_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)), control);
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+		if (mask)
+			return i + first_set_bit(mask);
+	}
+#elif defined(JSON11_SIMD_NEON)
+	const uint8x16_t quote = vdupq_n_u8('"'), backslash = vdupq_n_u8('\\');
+	const uint8x16_t control_limit = vdupq_n_u8(0x20);
+	for (; i + 16 <= end; i += 16) {
+		uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(s + i));
+		uint8x16_t special =
+			vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, control_limit));
+		uint64_t mask = neon_mask(special);
+		if (mask)
+			return i + first_set_bit(mask) / 4;
+	}
+#endif
+	while (i < end && !is_string_special(s[i]))
+		i++;
+	return i;
+}
+
 namespace {
 /* JsonParser
  *
@@ -422,11 +816,19 @@ struct JsonParser final {
 
 	/* State
      */
-	const string &str;
+	const std::string_view str; // not NUL-terminated: read past the end through at()
 	size_t i;
 	string &err;
 	bool failed;
 	const JsonParse strategy;
+	JsonArena *arena; // nullptr: allocate nodes on the heap
+	const JsonStrings strings;
+
+	/* at(pos)
+     *
+     * The character at pos, or 0 at the end of the input.
+     */
+	char at(size_t pos) const { return pos < str.size() ? str[pos] : 0; }
 
 	/* fail(msg, err_ret = Json())
      *
@@ -442,16 +844,31 @@ struct JsonParser final {
 		return err_ret;
 	}
 
-	/* consume_whitespace()
+	/* make<T>(value), number(value), literal(node)
      *
-     * Advance until the current character is non-whitespace.
+     * Create a node for the parsed value, in the arena if there is one.
      */
-	void consume_whitespace()
+	template<typename T, typename V> Json make(V &&value)
 	{
-		while (str[i] == ' ' || str[i] == '\r' || str[i] == '\n' || str[i] == '\t')
-			i++;
+		if (arena)
+			return arena->make<T>(std::forward<V>(value));
+		return Json(std::forward<V>(value));
+	}
+	Json number(int value) { return make<JsonInt>(value); }
+	Json number(double value) { return make<JsonDouble>(value); }
+	Json literal(const std::shared_ptr<JsonValue> &node)
+	{
+		if (arena)
+			return JsonArena::borrow(node);
+		return node == statics().null ? Json() : Json(node == statics().t);
 	}
 
+	/* consume_whitespace()
+     *
+     * Advance until the current character is non-whitespace.
+     */
+	void consume_whitespace() { i = skip_whitespace(str.data(), i, str.size()); }
+
 	/* consume_comment()
      *
      * Advance comments (c-style inline and multiline).
@@ -459,7 +876,7 @@ struct JsonParser final {
 	bool consume_comment()
 	{
 		bool comment_found = false;
-		if (str[i] == '/') {
+		if (at(i) == '/') {
 			i++;
 			if (i == str.size())
 				return fail("unexpected end of input after start of comment", false);
@@ -557,6 +974,15 @@ struct JsonParser final {
 		string out;
 		long last_escaped_codepoint = -1;
 		while (true) {
+			// Copy the run of plain bytes up to the next quote, backslash or control byte at once.
+			size_t run_end = scan_string(str.data(), i, str.size());
+			if (run_end != i) {
+				encode_utf8(last_escaped_codepoint, out);
+				last_escaped_codepoint = -1;
+				out.append(str.data() + i, run_end - i);
+				i = run_end;
+			}
+
 			if (i == str.size())
 				return fail("unexpected end of input in string", "");
 
@@ -570,15 +996,7 @@ struct JsonParser final {
 			if (in_range(ch, 0, 0x1f))
 				return fail("unescaped " + esc(ch) + " in string", "");
 
-			// The usual case: non-escaped characters
-			if (ch != '\\') {
-				encode_utf8(last_escaped_codepoint, out);
-				last_escaped_codepoint = -1;
-				out += ch;
-				continue;
-			}
-
-			// Handle escapes
+			// Anything else stopping the scan is a backslash: handle escapes
 			if (i == str.size())
 				return fail("unexpected end of input in string", "");
 
@@ -586,10 +1004,9 @@ struct JsonParser final {
 
 			if (ch == 'u') {
 				// Extract 4-byte escape sequence
-				string esc = str.substr(i, 4);
-				// Explicitly check length of the substring. The following loop
-				// relies on std::string returning the terminating NUL when
-				// accessing str[length]. Checking here reduces brittleness.
+				string esc(str.substr(i, 4));
+				// Explicitly check length of the substring: the input may end
+				// anywhere, and the loop below reads all four characters.
 				if (esc.length() < 4) {
 					return fail("bad \\u escape: " + esc, "");
 				}
@@ -651,52 +1068,56 @@ struct JsonParser final {
 	{
 		size_t start_pos = i;
 
-		if (str[i] == '-')
+		if (at(i) == '-')
 			i++;
 
 		// Integer part
-		if (str[i] == '0') {
+		if (at(i) == '0') {
 			i++;
-			if (in_range(str[i], '0', '9'))
+			if (in_range(at(i), '0', '9'))
 				return fail("leading 0s not permitted in numbers");
-		} else if (in_range(str[i], '1', '9')) {
+		} else if (in_range(at(i), '1', '9')) {
 			i++;
-			while (in_range(str[i], '0', '9'))
+			while (in_range(at(i), '0', '9'))
 				i++;
 		} else {
-			return fail("invalid " + esc(str[i]) + " in number");
+			return fail("invalid " + esc(at(i)) + " in number");
 		}
 
-		if (str[i] != '.' && str[i] != 'e' && str[i] != 'E' &&
+		if (at(i) != '.' && at(i) != 'e' && at(i) != 'E' &&
 		    (i - start_pos) <= static_cast<size_t>(std::numeric_limits<int>::digits10)) {
-			return std::atoi(str.c_str() + start_pos);
+			// At most digits10 digits and a sign: fits the buffer, and atoi needs the NUL
+			char digits[std::numeric_limits<int>::digits10 + 2];
+			str.copy(digits, i - start_pos, start_pos);
+			digits[i - start_pos] = '\0';
+			return number(std::atoi(digits));
 		}
 
 		// Decimal part
-		if (str[i] == '.') {
+		if (at(i) == '.') {
 			i++;
-			if (!in_range(str[i], '0', '9'))
+			if (!in_range(at(i), '0', '9'))
 				return fail("at least one digit required in fractional part");
 
-			while (in_range(str[i], '0', '9'))
+			while (in_range(at(i), '0', '9'))
 				i++;
 		}
 
 		// Exponent part
-		if (str[i] == 'e' || str[i] == 'E') {
+		if (at(i) == 'e' || at(i) == 'E') {
 			i++;
 
-			if (str[i] == '+' || str[i] == '-')
+			if (at(i) == '+' || at(i) == '-')
 				i++;
 
-			if (!in_range(str[i], '0', '9'))
+			if (!in_range(at(i), '0', '9'))
 				return fail("at least one digit required in exponent");
 
-			while (in_range(str[i], '0', '9'))
+			while (in_range(at(i), '0', '9'))
 				i++;
 		}
 
-		return std::strtod(str.c_str() + start_pos, nullptr);
+		return number(std::strtod(string(str.substr(start_pos, i - start_pos)).c_str(), nullptr));
 	}
 
 	/* expect(str, res)
@@ -712,7 +1133,7 @@ struct JsonParser final {
 			i += expected.length();
 			return res;
 		} else {
-			return fail("parse error: expected " + expected + ", got " + str.substr(i, expected.length()));
+			return fail("parse error: expected " + expected + ", got " + string(str.substr(i, expected.length())));
 		}
 	}
 
@@ -736,22 +1157,35 @@ struct JsonParser final {
 		}
 
 		if (ch == 't')
-			return expect("true", true);
+			return expect("true", literal(statics().t));
 
 		if (ch == 'f')
-			return expect("false", false);
+			return expect("false", literal(statics().f));
 
 		if (ch == 'n')
-			return expect("null", Json());
-
-		if (ch == '"')
-			return parse_string();
+			return expect("null", literal(statics().null));
+
+		if (ch == '"') {
+			if (strings == JsonStrings::BORROW) {
+				// Without escapes the value is exactly the input up to the closing quote
+				size_t end = scan_string(str.data(), i, str.size());
+				if (end < str.size() && str[end] == '"') {
+					std::string_view value = str.substr(i, end - i);
+					i = end + 1;
+					if (arena)
+						return arena->make<JsonBorrowedString>(value);
+					return JsonArena::wrap(make_shared<JsonBorrowedString>(value));
+				}
+			}
+			// On failure this is the empty string, which parse_multi() returns as its last value
+			return make<JsonString>(parse_string());
+		}
 
 		if (ch == '{') {
-			map<string, Json> data;
+			Json::object data{Json::object::allocator_type(arena)};
 			ch = get_next_token();
 			if (ch == '}')
-				return data;
+				return make<JsonObject>(std::move(data));
 
 			while (1) {
 				if (ch != '"')
@@ -765,9 +1199,10 @@ struct JsonParser final {
 				if (ch != ':')
 					return fail("expected ':' in object, got " + esc(ch));
 
-				data[std::move(key)] = parse_json(depth + 1);
+				Json value = parse_json(depth + 1);
 				if (failed)
 					return Json();
+				data.append(std::move(key), std::move(value));
 
 				ch = get_next_token();
 				if (ch == '}')
@@ -777,14 +1212,15 @@ struct JsonParser final {
 
 				ch = get_next_token();
 			}
-			return data;
+			data.normalize();
+			return make<JsonObject>(std::move(data));
 		}
 
 		if (ch == '[') {
-			vector<Json> data;
+			Json::array data{Json::array::allocator_type(arena)};
 			ch = get_next_token();
 			if (ch == ']')
-				return data;
+				return make<JsonArray>(std::move(data));
 
 			while (1) {
 				i--;
@@ -801,7 +1237,7 @@ struct JsonParser final {
 				ch = get_next_token();
 				(void)ch;
 			}
-			return data;
+			return make<JsonArray>(std::move(data));
 		}
 
 		return fail("expected value, got " + esc(ch));
@@ -809,9 +1245,12 @@ struct JsonParser final {
 };
 } // namespace
 
-Json Json::parse(const string &in, string &err, JsonParse strategy)
+Json Json::parse(std::string_view in, string &err, JsonParse strategy, JsonAlloc alloc, JsonStrings strings)
 {
-	JsonParser parser{in, 0, err, false, strategy};
+	std::shared_ptr<JsonArena> arena;
+	if (alloc == JsonAlloc::ARENA)
+		arena = std::make_shared<JsonArena>(JsonArena::first_block_for(in.size()));
+	JsonParser parser{in, 0, err, false, strategy, arena.get(), strings};
 	Json result = parser.parse_json(0);
 
 	// Check for any trailing garbage
@@ -821,14 +1260,16 @@ Json Json::parse(const string &in, string &err, JsonParse strategy)
 	if (parser.i != in.size())
 		return parser.fail("unexpected trailing " + esc(in[parser.i]));
 
+	if (arena)
+		return JsonArena::adopt(arena, result);
 	return result;
 }
 
 // Documented in json11.hpp
-vector<Json> Json::parse_multi(const string &in, std::string::size_type &parser_stop_pos, string &err,
+vector<Json> Json::parse_multi(std::string_view in, std::string::size_type &parser_stop_pos, string &err,
 			       JsonParse strategy)
 {
-	JsonParser parser{in, 0, err, false, strategy};
+	JsonParser parser{in, 0, err, false, strategy, nullptr, JsonStrings::COPY};
 	parser_stop_pos = 0;
 	vector<Json> json_vec;
 	while (parser.i != in.size() && !parser.failed) {
@@ -4,7 +4,7 @@
  *
  * The core object provided by the library is json11::Json. A Json object represents any JSON
  * value: null, bool, number (int or double), string (std::string), array (std::vector), or
- * object (std::map).
+ * object (FlatMap, a std::vector of members sorted by key).
  *
  * Json objects act like values: they can be assigned, copied, moved, compared for equality or
  * order, etc. There are also helper methods Json::dump, to serialize a Json to a string, and
@@ -50,11 +50,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <memory>
 #include <initializer_list>
+#include <type_traits>
 #include <utility>
 
 #ifdef _MSC_VER
@@ -73,7 +75,216 @@ namespace json11 {
 
 enum JsonParse { STANDARD, COMMENTS };
 
+/* Where parse() places the nodes of the resulting tree.
+ *
+ * HEAP: every node is a separately reference-counted heap object (the classic json11 model).
+ * ARENA: all nodes of one parse, together with the storage of their arrays and objects, are
+ * bump-allocated from a single arena that is released in one go when the returned root Json
+ * (and every copy of it) is destroyed. Nodes inside the tree do not own the arena: a reference
+ * into the tree (operator[], array_items(), ...) must not outlive the root, while copying a
+ * node out of the tree (Json copy construction or assignment, or copying its array / object)
+ * deep-copies it onto the heap, including any borrowed strings, so the copy stays valid on its
+ * own. String payloads longer than the std::string small buffer still live on the heap, because
+ * string_value() hands out a std::string (unless they are borrowed, see JsonStrings).
+ */
+enum JsonAlloc { HEAP, ARENA };
+
+/* How parse() stores string values.
+ *
+ * COPY: every string is unescaped into its own std::string.
+ * BORROW: strings without escape sequences are kept as views into the parse input, which the
+ * caller must keep alive and unmodified for as long as any value from the tree is in use.
+ * Read them with string_view_value(); string_value() still works, but makes (and keeps) a
+ * std::string copy on first use. Object keys and escaped strings are copied as with COPY.
+ * Debug builds check on every access that the viewed bytes have not changed.
+ */
+enum JsonStrings { COPY, BORROW };
+
 class JsonValue;
+class JsonArena;
+
+void *arena_allocate(JsonArena *arena, size_t size, size_t align);
+
+/* Allocator for the array / object containers. A default-constructed allocator uses the heap;
+ * one bound to an arena allocates from it and never frees individually. Copies of a container
+ * always go back to the heap.
+ */
+template<typename T> class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef std::false_type propagate_on_container_copy_assignment;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	ArenaAllocator() noexcept {}
+	explicit ArenaAllocator(JsonArena *arena) noexcept : m_arena(arena) {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_arena(other.arena()) {}
+
+	T *allocate(size_t n)
+	{
+		if (m_arena)
+			return static_cast<T *>(arena_allocate(m_arena, n * sizeof(T), alignof(T)));
+		return static_cast<T *>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(T *p, size_t) noexcept
+	{
+		if (!m_arena)
+			::operator delete(p);
+	}
+	ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+	JsonArena *arena() const noexcept { return m_arena; }
+	template<typename U> bool operator==(const ArenaAllocator<U> &other) const noexcept
+	{
+		return m_arena == other.arena();
+	}
+	template<typename U> bool operator!=(const ArenaAllocator<U> &other) const noexcept
+	{
+		return m_arena != other.arena();
+	}
+
+private:
+	JsonArena *m_arena = nullptr;
+};
+
+/* FlatMap
+ *
+ * Storage for Json::object: the members live in one contiguous vector kept sorted by key, so
+ * iteration order (and therefore dump() output and comparisons) is the same as std::map's.
+ * Lookups in small objects - nearly every API response - are a linear scan over adjacent
+ * keys; larger objects use binary search. Iterators and references are invalidated by any
+ * insertion or erasure, as with std::vector.
+ */
+template<typename K, typename T, typename Alloc = std::allocator<std::pair<K, T>>> class FlatMap {
+public:
+	typedef K key_type;
+	typedef T mapped_type;
+	typedef std::pair<K, T> value_type;
+	typedef Alloc allocator_type;
+	typedef std::less<K> key_compare;
+	typedef std::vector<value_type, Alloc> storage_type;
+	typedef typename storage_type::size_type size_type;
+	typedef typename storage_type::iterator iterator;
+	typedef typename storage_type::const_iterator const_iterator;
+
+	// Objects up to this size are searched linearly.
+	static const size_type linear_search_limit = 16;
+
+	FlatMap() {}
+	explicit FlatMap(const Alloc &alloc) : m_items(alloc) {}
+	// Like std::map, the first of several equal keys wins.
+	template<typename It> FlatMap(It first, It last, const Alloc &alloc = Alloc()) : m_items(first, last, alloc)
+	{
+		sort_unique(false);
+	}
+	FlatMap(std::initializer_list<value_type> items, const Alloc &alloc = Alloc()) : m_items(items, alloc)
+	{
+		sort_unique(false);
+	}
+
+	iterator begin() noexcept { return m_items.begin(); }
+	iterator end() noexcept { return m_items.end(); }
+	const_iterator begin() const noexcept { return m_items.begin(); }
+	const_iterator end() const noexcept { return m_items.end(); }
+	const_iterator cbegin() const noexcept { return m_items.cbegin(); }
+	const_iterator cend() const noexcept { return m_items.cend(); }
+	bool empty() const noexcept { return m_items.empty(); }
+	size_type size() const noexcept { return m_items.size(); }
+	void clear() noexcept { m_items.clear(); }
+	void reserve(size_type n) { m_items.reserve(n); }
+	allocator_type get_allocator() const { return m_items.get_allocator(); }
+
+	const_iterator find(const K &key) const
+	{
+		if (m_items.size() <= linear_search_limit) {
+			for (auto it = m_items.begin(); it != m_items.end(); ++it) {
+				if (it->first == key)
+					return it;
+			}
+			return m_items.end();
+		}
+		auto it = lower_bound(key);
+		return (it != m_items.end() && it->first == key) ? it : m_items.end();
+	}
+	iterator find(const K &key)
+	{
+		return m_items.begin() + (static_cast<const FlatMap &>(*this).find(key) - m_items.cbegin());
+	}
+	size_type count(const K &key) const { return find(key) == end() ? 0 : 1; }
+
+	std::pair<iterator, bool> insert(value_type item)
+	{
+		auto it = lower_bound(item.first);
+		if (it != m_items.end() && it->first == item.first)
+			return {it, false};
+		return {m_items.insert(it, std::move(item)), true};
+	}
+	template<typename V> std::pair<iterator, bool> insert_or_assign(K key, V &&value)
+	{
+		auto it = lower_bound(key);
+		if (it != m_items.end() && it->first == key) {
+			it->second = std::forward<V>(value);
+			return {it, false};
+		}
+		return {m_items.emplace(it, std::move(key), std::forward<V>(value)), true};
+	}
+	T &operator[](const K &key) { return insert(value_type(key, T())).first->second; }
+	size_type erase(const K &key)
+	{
+		auto it = find(key);
+		if (it == end())
+			return 0;
+		m_items.erase(it);
+		return 1;
+	}
+
+	/* Bulk loading: append members in any order, then call normalize() once. Sorting at the
+	 * end is O(n log n) however the input is ordered; later duplicates win, as with repeated
+	 * operator[] assignment.
+	 */
+	void append(K &&key, T &&value) { m_items.emplace_back(std::move(key), std::move(value)); }
+	void normalize() { sort_unique(true); }
+
+	bool operator==(const FlatMap &other) const { return m_items == other.m_items; }
+	bool operator!=(const FlatMap &other) const { return m_items != other.m_items; }
+	bool operator<(const FlatMap &other) const { return m_items < other.m_items; }
+
+private:
+	iterator lower_bound(const K &key)
+	{
+		return std::lower_bound(m_items.begin(), m_items.end(), key,
+					[](const value_type &item, const K &k) { return item.first < k; });
+	}
+	const_iterator lower_bound(const K &key) const
+	{
+		return std::lower_bound(m_items.begin(), m_items.end(), key,
+					[](const value_type &item, const K &k) { return item.first < k; });
+	}
+
+	void sort_unique(bool keep_last)
+	{
+		// Already strictly increasing (common for small or pre-sorted input): nothing to do.
+		auto not_increasing = [](const value_type &a, const value_type &b) { return !(a.first < b.first); };
+		if (std::adjacent_find(m_items.begin(), m_items.end(), not_increasing) == m_items.end())
+			return;
+		std::stable_sort(m_items.begin(), m_items.end(),
+				 [](const value_type &a, const value_type &b) { return a.first < b.first; });
+		auto out = m_items.begin();
+		for (auto it = m_items.begin(); it != m_items.end();) {
+			auto run_end = it + 1;
+			while (run_end != m_items.end() && run_end->first == it->first)
+				++run_end;
+			auto keep = keep_last ? run_end - 1 : it;
+			if (out != keep)
+				*out = std::move(*keep);
+			++out;
+			it = run_end;
+		}
+		m_items.erase(out, m_items.end());
+	}
+
+	storage_type m_items;
+};
 
 class Json final {
 public:
@@ -81,8 +292,8 @@ public:
 	enum Type { NUL, NUMBER, BOOL, STRING, ARRAY, OBJECT };
 
 	// Array and object typedefs
-	typedef std::vector<Json> array;
-	typedef std::map<std::string, Json> object;
+	typedef std::vector<Json, ArenaAllocator<Json>> array;
+	typedef FlatMap<std::string, Json, ArenaAllocator<std::pair<std::string, Json>>> object;
 
 	// Constructors for the various types of JSON value.
 	Json() noexcept;                // NUL
@@ -123,6 +334,14 @@ public:
 	// Json(bool(some_pointer)) if that behavior is desired.
 	Json(void *) = delete;
 
+	// Copies share the node, except for nodes inside a JsonAlloc::ARENA tree, which are
+	// deep-copied onto the heap so the copy does not depend on the arena. Moves never copy.
+	Json(const Json &other);
+	Json &operator=(const Json &other);
+	Json(Json &&other) noexcept = default;
+	Json &operator=(Json &&other) noexcept = default;
+	~Json() = default;
+
 	// Accessors
 	Type type() const;
 
@@ -143,9 +362,11 @@ public:
 	bool bool_value() const;
 	// Return the enclosed string if this is a string, "" otherwise.
 	const std::string &string_value() const;
+	// Same without requiring a std::string; for JsonStrings::BORROW this points into the input.
+	std::string_view string_view_value() const;
 	// Return the enclosed std::vector if this is an array, or an empty vector otherwise.
 	const array &array_items() const;
-	// Return the enclosed std::map if this is an object, or an empty map otherwise.
+	// Return the enclosed object (a FlatMap, sorted by key) if this is an object, or an empty one otherwise.
 	const object &object_items() const;
 
 	// Return a reference to arr[i] if this is an array, Json() otherwise.
@@ -163,21 +384,35 @@ public:
 	}
 
 	// Parse. If parse fails, return Json() and assign an error message to err.
-	static Json parse(const std::string &in, std::string &err, JsonParse strategy = JsonParse::STANDARD);
-	static Json parse(const char *in, std::string &err, JsonParse strategy = JsonParse::STANDARD)
+	// The input is read in place; none of the overloads copies it.
+	static Json parse(std::string_view in, std::string &err, JsonParse strategy = JsonParse::STANDARD,
+			  JsonAlloc alloc = JsonAlloc::HEAP, JsonStrings strings = JsonStrings::COPY);
+	static Json parse(const std::string &in, std::string &err, JsonParse strategy = JsonParse::STANDARD,
+			  JsonAlloc alloc = JsonAlloc::HEAP, JsonStrings strings = JsonStrings::COPY)
+	{
+		return parse(std::string_view(in), err, strategy, alloc, strings);
+	}
+	static Json parse(const char *in, std::string &err, JsonParse strategy = JsonParse::STANDARD,
+			  JsonAlloc alloc = JsonAlloc::HEAP, JsonStrings strings = JsonStrings::COPY)
 	{
 		if (in) {
-			return parse(std::string(in), err, strategy);
+			return parse(std::string_view(in), err, strategy, alloc, strings);
 		} else {
 			err = "null input";
 			return nullptr;
 		}
 	}
+	// Raw buffer; it does not need to be NUL-terminated.
+	static Json parse(const char *in, size_t size, std::string &err, JsonParse strategy = JsonParse::STANDARD,
+			  JsonAlloc alloc = JsonAlloc::HEAP, JsonStrings strings = JsonStrings::COPY)
+	{
+		return parse(std::string_view(in, size), err, strategy, alloc, strings);
+	}
 	// Parse multiple objects, concatenated or separated by whitespace
-	static std::vector<Json> parse_multi(const std::string &in, std::string::size_type &parser_stop_pos,
+	static std::vector<Json> parse_multi(std::string_view in, std::string::size_type &parser_stop_pos,
 					     std::string &err, JsonParse strategy = JsonParse::STANDARD);
 
-	static inline std::vector<Json> parse_multi(const std::string &in, std::string &err,
+	static inline std::vector<Json> parse_multi(std::string_view in, std::string &err,
 						    JsonParse strategy = JsonParse::STANDARD)
 	{
 		std::string::size_type parser_stop_pos;
@@ -200,6 +435,9 @@ public:
 	bool has_shape(const shape &types, std::string &err) const;
 
 private:
+	friend class JsonArena;
+	explicit Json(std::shared_ptr<JsonValue> ptr) noexcept : m_ptr(std::move(ptr)) {}
+
 	std::shared_ptr<JsonValue> m_ptr;
 };
 
@@ -207,8 +445,11 @@ private:
 class JsonValue {
 protected:
 	friend class Json;
+	friend class JsonArena;
 	friend class JsonInt;
 	friend class JsonDouble;
+	friend class JsonString;
+	friend class JsonBorrowedString;
 	virtual Json::Type type() const = 0;
 	virtual bool equals(const JsonValue *other) const = 0;
 	virtual bool less(const JsonValue *other) const = 0;
@@ -217,10 +458,13 @@ protected:
 	virtual int int_value() const;
 	virtual bool bool_value() const;
 	virtual const std::string &string_value() const;
+	virtual std::string_view string_view_value() const;
 	virtual const Json::array &array_items() const;
 	virtual const Json &operator[](size_t i) const;
 	virtual const Json::object &object_items() const;
 	virtual const Json &operator[](const std::string &key) const;
+	// A heap copy that does not reference any arena or parse input.
+	virtual std::shared_ptr<JsonValue> clone() const = 0;
 	virtual ~JsonValue() {}
 };
 
@@ -4,16 +4,43 @@
 #include <QMainWindow>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QStringList>
+#include <QTimer>
+#include <chrono>
+#include <memory>
 #include "ui/menu_manager.hpp"
 #include "ui/dialog_factory.hpp"
 #include "core/config_manager.hpp"
 #include "core/qr_generator.hpp"
+#include "core/room_info_updater.hpp"
+#include "core/live_status_watcher.hpp"
+#include "core/event_bus.hpp"
+#include "core/event_log.hpp"
+#include "core/keyword_filter.hpp"
+#include "core/gift_aggregator.hpp"
+#include "core/output_health.hpp"
+#include "core/stream_launcher.hpp"
+#include "core/go_live_preparer.hpp"
+#include "core/ingest_failover.hpp"
+#include "core/auto_stop_live.hpp"
+#include "core/bitrate_controller.hpp"
+#include "core/account_refresher.hpp"
+#include "core/live_scheduler.hpp"
+#include "core/session_keeper.hpp"
+#include "ui/health_dock.hpp"
+#include "danmaku/danmaku_client.hpp"
 #include "bilibili_api.hpp"
 #include "plugin_utils.hpp"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE(PLUGIN_NAME, "en-US")
 
+static const char *kHealthDockId = "bilibili_stream_health";
+static const int kIngestProbeTimeoutMs = 1000;
+static const int kAccountRefreshMs = 60 * 1000;
+static const int kSessionCheckMs = 6 * 3600 * 1000;
+static const int64_t kGoLiveSessionMarginS = 6 * 3600; // 与后台检查间隔一致，开播时很少需要同步刷新
+
 class BilibiliStreamPlugin : public QObject {
 	Q_OBJECT
 public:
@@ -25,47 +52,159 @@ private slots:
 	void onStreamToggle();
 	void onOpenRoom();
 	void onUpdateRoomInfo();
+	void onGiftRanking();
+	void onLiveStatusChanged(bool streaming);
+	void onAddAccount();
+	void onRemoveAccount();
+	void onRoomSelected(int index);
+	void onAccountsRefreshed(const std::vector<Core::AccountStatus> &results);
+	void onScheduleTriggered(const Core::ScheduleEntry &entry);
+	void onSessionRenewed(const Core::SessionRenewal &renewal);
+	void onSessionChecked(bool fresh, const Core::SessionRenewal &renewal);
+	void onGoLiveReady(const Core::GoLivePlan &plan);
 
 private:
 	void updateLoginStatus();
 	void openLiveRoom();
+	void startRoomServices();
+	void stopRoomServices();
+	void applyActiveAccount();
+	void updateRoomMenu();
+	void refreshAccounts();
+	void checkSessions();
+	void updateSessionLog();
 
 	Core::ConfigManager m_config;
 	UI::MenuManager *m_menu;
+	Core::RoomInfoUpdater *m_roomUpdater;
+	Core::LiveStatusWatcher *m_statusWatcher;
+	Core::GiftAggregator *m_gifts;
+	Core::OutputHealthMonitor *m_health;
+	Core::StreamLauncher *m_launcher;
+	Core::GoLivePreparer *m_preparer;
+	Core::IngestFailover *m_failover;
+	Core::AutoStopLive *m_autoStop;
+	Core::BitrateController *m_bitrate;
+	Core::AccountRefresher *m_accounts;
+	QTimer *m_accountTimer;
+	Core::LiveScheduler *m_scheduler;
+	Core::SessionKeeper *m_session;
+	QTimer *m_sessionTimer;
+	std::string m_serviceRoomId; // 弹幕 / 状态轮询当前服务的直播间，空表示未启动
+	std::string m_goLiveRoomId;  // 正在后台准备推流的直播间
+	std::chrono::steady_clock::time_point m_goLiveStarted;
+	Core::KeywordFilter m_keywordFilter;
+	Core::EventLogWriter m_sessionLog;
+	Core::EventBus m_eventBus;
+	std::unique_ptr<Danmaku::DanmakuClient> m_danmaku;
 };
 
 BilibiliStreamPlugin::BilibiliStreamPlugin(QMainWindow *parent)
-	: QObject(nullptr), m_menu(new UI::MenuManager(parent->menuBar(), this))
+	: QObject(nullptr),
+	  m_menu(new UI::MenuManager(parent->menuBar(), this)),
+	  m_roomUpdater(new Core::RoomInfoUpdater(m_config, this)),
+	  m_statusWatcher(new Core::LiveStatusWatcher(this)),
+	  m_gifts(new Core::GiftAggregator(this)),
+	  m_health(new Core::OutputHealthMonitor(this)),
+	  m_launcher(new Core::StreamLauncher(this)),
+	  m_preparer(new Core::GoLivePreparer(this)),
+	  m_failover(new Core::IngestFailover(m_health, m_launcher, this)),
+	  m_autoStop(new Core::AutoStopLive(m_config, m_launcher, this)),
+	  m_bitrate(new Core::BitrateController(m_health, this)),
+	  m_accounts(new Core::AccountRefresher(this)),
+	  m_accountTimer(new QTimer(this)),
+	  m_scheduler(new Core::LiveScheduler(this)),
+	  m_session(new Core::SessionKeeper(this)),
+	  m_sessionTimer(new QTimer(this)),
+	  m_danmaku(std::make_unique<Danmaku::DanmakuClient>([this](Danmaku::Event &&event) {
+		  // 在网络线程上直接匹配屏蔽词，命中的弹幕不进入事件总线，也就不会写进场次日志
+		  if (event.type == Danmaku::EventType::Chat && m_keywordFilter.matches(event.text))
+			  return;
+		  m_eventBus.publish(std::move(event));
+	  }))
 {
 	m_config.load();
 
 	connect(m_menu, &UI::MenuManager::scanQrcodeClicked, this, &BilibiliStreamPlugin::onScanQrcode);
+	connect(m_menu, &UI::MenuManager::addAccountClicked, this, &BilibiliStreamPlugin::onAddAccount);
+	connect(m_menu, &UI::MenuManager::removeAccountClicked, this, &BilibiliStreamPlugin::onRemoveAccount);
+	connect(m_menu, &UI::MenuManager::roomSelected, this, &BilibiliStreamPlugin::onRoomSelected);
+	connect(m_accounts, &Core::AccountRefresher::refreshed, this, &BilibiliStreamPlugin::onAccountsRefreshed);
+	connect(m_accountTimer, &QTimer::timeout, this, &BilibiliStreamPlugin::refreshAccounts);
+	connect(m_scheduler, &Core::LiveScheduler::prewarmDue, this,
+		[this](const Core::ScheduleEntry &) { Bili::BiliApi::prewarmAsync(m_config.config()); });
+	connect(m_scheduler, &Core::LiveScheduler::triggered, this, &BilibiliStreamPlugin::onScheduleTriggered);
+	connect(m_session, &Core::SessionKeeper::renewed, this, &BilibiliStreamPlugin::onSessionRenewed);
+	connect(m_session, &Core::SessionKeeper::goLiveChecked, this, &BilibiliStreamPlugin::onSessionChecked);
+	connect(m_preparer, &Core::GoLivePreparer::ready, this, &BilibiliStreamPlugin::onGoLiveReady);
+	connect(m_sessionTimer, &QTimer::timeout, this, &BilibiliStreamPlugin::checkSessions);
 	connect(m_menu, &UI::MenuManager::streamToggleClicked, this, &BilibiliStreamPlugin::onStreamToggle);
 	connect(m_menu, &UI::MenuManager::openRoomClicked, this, &BilibiliStreamPlugin::onOpenRoom);
 	connect(m_menu, &UI::MenuManager::updateRoomInfoClicked, this, &BilibiliStreamPlugin::onUpdateRoomInfo);
-
-	auto &cfg = m_config.config();
-	if (!cfg.cookies.empty()) {
-		std::string message;
-		if (Bili::BiliApi::checkLoginStatus(cfg.cookies, message, cfg.mid)) {
-			cfg.login_status = true;
-			std::string newRoomId, newCsrfToken;
-			if (Bili::BiliApi::getRoomIdAndCsrf(cfg.cookies, newRoomId, newCsrfToken, message)) {
-				cfg.room_id = newRoomId;
-				cfg.csrf_token = newCsrfToken;
-				m_config.save();
-			}
+	connect(m_menu, &UI::MenuManager::giftRankingClicked, this, &BilibiliStreamPlugin::onGiftRanking);
+	connect(m_roomUpdater, &Core::RoomInfoUpdater::finished, this,
+		[](bool, const QString &message) { UI::DialogFactory::message(message, "消息"); });
+	connect(m_statusWatcher, &Core::LiveStatusWatcher::liveStatusChanged, this,
+		&BilibiliStreamPlugin::onLiveStatusChanged);
+	connect(m_menu, &UI::MenuManager::backupStreamToggled, this, [this](bool enabled) {
+		auto &cfg = m_config.config();
+		if (cfg.backup_stream == enabled)
+			return;
+		cfg.backup_stream = enabled;
+		m_config.save();
+	});
+	connect(m_menu, &UI::MenuManager::adaptiveBitrateToggled, this, [this](bool enabled) {
+		auto &cfg = m_config.config();
+		m_bitrate->setEnabled(enabled);
+		if (cfg.adaptive_bitrate == enabled)
+			return;
+		cfg.adaptive_bitrate = enabled;
+		m_config.save();
+	});
+	connect(m_menu, &UI::MenuManager::uplinkTestToggled, this, [this](bool enabled) {
+		auto &cfg = m_config.config();
+		if (cfg.uplink_test == enabled)
+			return;
+		cfg.uplink_test = enabled;
+		m_config.save();
+	});
+	connect(m_autoStop, &Core::AutoStopLive::stopped, this, [this](bool ok, const QString &message) {
+		if (!ok) {
+			obs_log(LOG_WARNING, "自动下播失败: %s", message.toUtf8().constData());
+			return;
 		}
-	}
+		m_bitrate->setUplinkLimit(0);
+		m_statusWatcher->notifyTransition(false);
+		onLiveStatusChanged(false);
+	});
+	connect(m_launcher, &Core::StreamLauncher::failed, this, [this](const QString &message) {
+		// 自动推流失败时退回手动复制推流地址
+		auto &cfg = m_config.config();
+		UI::DialogFactory::message(message, "开播");
+		UI::DialogFactory::streamStarted((QWidget *)obs_frontend_get_main_window(), cfg.rtmp_addr,
+						 cfg.rtmp_code);
+	});
+	m_eventBus.subscribe(
+		[this](const Danmaku::Event *events, size_t count) { m_sessionLog.append(events, count); });
+	m_eventBus.subscribe([this](const Danmaku::Event *events, size_t count) { m_gifts->add(events, count); });
+	m_keywordFilter.start(Core::KeywordFilter::defaultPath());
+	m_health->start();
+	obs_frontend_add_dock_by_id(kHealthDockId, "B站推流状态", new UI::HealthDock(m_health));
 
-	updateLoginStatus();
-	if (cfg.streaming) {
-		m_menu->actions().streamToggle->setText("停止直播");
-	}
+	// 登录检查在后台对全部账号并发进行，结果回来后再启动当前直播间的服务
+	applyActiveAccount();
+	refreshAccounts();
+	m_accountTimer->start(kAccountRefreshMs);
+	checkSessions();
+	m_sessionTimer->start(kSessionCheckMs);
+	m_scheduler->start(Core::LiveScheduler::defaultPath());
 }
 
 BilibiliStreamPlugin::~BilibiliStreamPlugin()
 {
+	m_scheduler->stop();
+	m_health->stop();
+	obs_frontend_remove_dock(kHealthDockId);
 	obs_log(LOG_DEBUG, "释放 BilibiliStreamPlugin 资源");
 }
 
@@ -89,6 +228,223 @@ void BilibiliStreamPlugin::openLiveRoom()
 	}
 }
 
+void BilibiliStreamPlugin::applyActiveAccount()
+{
+	auto &cfg = m_config.config();
+	updateLoginStatus();
+	updateRoomMenu();
+	m_menu->actions().backupStream->setChecked(cfg.backup_stream);
+	m_menu->actions().adaptiveBitrate->setChecked(cfg.adaptive_bitrate);
+	m_menu->actions().uplinkTest->setChecked(cfg.uplink_test);
+	m_menu->actions().streamToggle->setText(cfg.streaming ? "停止直播" : "开始直播");
+	m_bitrate->setArea(cfg.part_id, cfg.area_id);
+	if (cfg.login_status)
+		startRoomServices();
+}
+
+void BilibiliStreamPlugin::updateRoomMenu()
+{
+	QStringList labels;
+	for (size_t i = 0; i < m_config.accountCount(); ++i) {
+		const auto &account = m_config.account(i);
+		QString label = account.login_status
+					? QString::fromStdString(account.title + " (" + account.room_id + ")")
+					: QString("账号 %1（未登录）").arg(int(i) + 1);
+		if (account.live_status == 1)
+			label += QString::fromUtf8(" · 直播中");
+		labels << label;
+	}
+	m_menu->setRooms(labels, int(m_config.activeIndex()));
+}
+
+void BilibiliStreamPlugin::refreshAccounts()
+{
+	std::vector<std::string> cookies;
+	for (size_t i = 0; i < m_config.accountCount(); ++i)
+		cookies.push_back(m_config.account(i).cookies);
+	m_accounts->refresh(cookies);
+}
+
+void BilibiliStreamPlugin::checkSessions()
+{
+	std::vector<Core::SessionCredentials> accounts;
+	for (size_t i = 0; i < m_config.accountCount(); ++i) {
+		const auto &account = m_config.account(i);
+		accounts.push_back({account.cookies, account.refresh_token});
+	}
+	m_session->check(accounts);
+}
+
+void BilibiliStreamPlugin::onSessionRenewed(const Core::SessionRenewal &renewal)
+{
+	if (!renewal.ok) {
+		obs_log(LOG_WARNING, "刷新登录失败: %s", renewal.message.c_str());
+		return;
+	}
+	bool changed = false;
+	for (size_t i = 0; i < m_config.accountCount(); ++i) {
+		auto &account = m_config.account(i);
+		if (account.cookies != renewal.old_cookies)
+			continue;
+		account.cookies = renewal.cookies;
+		account.refresh_token = renewal.refresh_token;
+		std::string csrf = Bili::BiliApi::cookieValue(renewal.cookies, "bili_jct");
+		if (!csrf.empty())
+			account.csrf_token = csrf;
+		changed = true;
+	}
+	if (!changed)
+		return;
+	m_config.save();
+	obs_log(LOG_INFO, "登录已刷新，有效期至 %lld", (long long)Bili::BiliApi::sessionExpiry(renewal.cookies));
+}
+
+void BilibiliStreamPlugin::onAccountsRefreshed(const std::vector<Core::AccountStatus> &results)
+{
+	bool changed = false;
+	for (const auto &status : results) {
+		// 刷新期间账号可能已被删除或重新登录，按 cookies 找回对应账号
+		for (size_t i = 0; i < m_config.accountCount(); ++i) {
+			auto &account = m_config.account(i);
+			if (account.cookies != status.cookies)
+				continue;
+			account.login_status = status.login;
+			account.live_status = status.live_status;
+			if (status.login && !status.room_id.empty() &&
+			    (account.room_id != status.room_id || account.csrf_token != status.csrf_token ||
+			     account.mid != status.mid)) {
+				account.room_id = status.room_id;
+				account.csrf_token = status.csrf_token;
+				account.mid = status.mid;
+				changed = true;
+			}
+		}
+	}
+	if (changed)
+		m_config.save();
+
+	auto &cfg = m_config.config();
+	updateLoginStatus();
+	updateRoomMenu();
+	if (cfg.login_status && m_serviceRoomId != cfg.room_id)
+		startRoomServices();
+}
+
+void BilibiliStreamPlugin::onAddAccount()
+{
+	if (m_config.config().streaming) {
+		UI::DialogFactory::message(QString::fromUtf8("直播中不能切换账号，请先停止直播"), "消息");
+		return;
+	}
+	stopRoomServices();
+	m_config.setActive(m_config.addAccount());
+	m_config.save();
+	applyActiveAccount();
+	onScanQrcode();
+}
+
+void BilibiliStreamPlugin::onRemoveAccount()
+{
+	auto &cfg = m_config.config();
+	if (cfg.streaming) {
+		UI::DialogFactory::message(QString::fromUtf8("直播中不能移除账号，请先停止直播"), "消息");
+		return;
+	}
+	if (m_config.accountCount() < 2)
+		return;
+	QString name = cfg.login_status ? QString::fromStdString(cfg.title + " (" + cfg.room_id + ")")
+					: QString::fromUtf8("未登录账号");
+	if (!UI::DialogFactory::confirm(QString::fromUtf8("移除 %1 并删除其登录信息？").arg(name), "移除账号"))
+		return;
+	stopRoomServices();
+	m_config.removeAccount(m_config.activeIndex());
+	m_config.save();
+	applyActiveAccount();
+}
+
+void BilibiliStreamPlugin::onRoomSelected(int index)
+{
+	if (index < 0 || size_t(index) >= m_config.accountCount() || size_t(index) == m_config.activeIndex())
+		return;
+	if (m_config.config().streaming) {
+		UI::DialogFactory::message(QString::fromUtf8("直播中不能切换直播间，请先停止直播"), "消息");
+		updateRoomMenu();
+		return;
+	}
+	stopRoomServices();
+	m_config.setActive(size_t(index));
+	m_config.save();
+	applyActiveAccount();
+}
+
+void BilibiliStreamPlugin::onScheduleTriggered(const Core::ScheduleEntry &entry)
+{
+	// 定时计划作用于当前选中的直播间，与手动点击菜单走同一流程
+	auto &cfg = m_config.config();
+	switch (entry.action) {
+	case Core::ScheduleAction::Start:
+		if (cfg.streaming || !cfg.login_status) {
+			obs_log(LOG_INFO, "定时开播跳过: %s", cfg.streaming ? "已在直播" : "未登录");
+			return;
+		}
+		onStreamToggle();
+		break;
+	case Core::ScheduleAction::Stop:
+		if (!cfg.streaming)
+			return;
+		onStreamToggle();
+		break;
+	case Core::ScheduleAction::Title:
+		m_roomUpdater->setTitle(entry.title);
+		m_roomUpdater->flushNow();
+		break;
+	case Core::ScheduleAction::Area:
+		m_roomUpdater->setArea(entry.part_id, entry.area_id);
+		m_roomUpdater->flushNow();
+		break;
+	}
+}
+
+void BilibiliStreamPlugin::stopRoomServices()
+{
+	// 切换账号前把防抖中的标题 / 分区修改提交给原直播间
+	m_roomUpdater->flushNow();
+	m_statusWatcher->stop();
+	m_danmaku->stop();
+	m_sessionLog.close();
+	m_serviceRoomId.clear();
+}
+
+void BilibiliStreamPlugin::startRoomServices()
+{
+	auto &cfg = m_config.config();
+	m_serviceRoomId = cfg.room_id;
+	m_statusWatcher->start(cfg.room_id, cfg.streaming);
+
+	Danmaku::ClientOptions options;
+	options.room_id = cfg.room_id;
+	options.uid = strtoll(cfg.mid.c_str(), nullptr, 10);
+	options.cookies = cfg.cookies;
+	m_eventBus.start();
+	m_danmaku->start(options);
+	updateSessionLog();
+}
+
+void BilibiliStreamPlugin::updateSessionLog()
+{
+	// 每场直播一个日志文件：开播时创建，下播时关闭
+	auto &cfg = m_config.config();
+	if (!cfg.streaming) {
+		m_sessionLog.close();
+		return;
+	}
+	if (m_sessionLog.isOpen())
+		return;
+	std::string path = Core::EventLogWriter::sessionPath(cfg.room_id);
+	if (!path.empty())
+		m_sessionLog.open(path, strtoll(cfg.room_id.c_str(), nullptr, 10));
+}
+
 void BilibiliStreamPlugin::onOpenRoom()
 {
 	openLiveRoom();
@@ -105,9 +461,11 @@ void BilibiliStreamPlugin::onScanQrcode()
 	}
 
 	auto parent = (QWidget *)obs_frontend_get_main_window();
-	UI::DialogFactory::qrLogin(parent, qrData, qrKey, [this, &cfg](const std::string &cookies) {
+	UI::DialogFactory::qrLogin(parent, qrData, qrKey,
+				   [this, &cfg](const std::string &cookies, const std::string &refreshToken) {
 		std::string msg;
 		cfg.cookies = cookies;
+		cfg.refresh_token = refreshToken;
 		cfg.login_status = Bili::BiliApi::checkLoginStatus(cfg.cookies, msg, cfg.mid);
 		updateLoginStatus();
 
@@ -117,6 +475,9 @@ void BilibiliStreamPlugin::onScanQrcode()
 			cfg.csrf_token = newCsrfToken;
 		}
 		m_config.save();
+		updateRoomMenu();
+		if (cfg.login_status)
+			startRoomServices();
 	});
 }
 
@@ -127,9 +488,15 @@ void BilibiliStreamPlugin::onStreamToggle()
 
 	if (cfg.streaming) {
 		if (Bili::BiliApi::stopLive(cfg, message)) {
+			m_preparer->cancel();
+			m_failover->disarm();
+			m_launcher->stopOutput();
+			m_bitrate->setUplinkLimit(0);
 			m_menu->actions().streamToggle->setText("开始直播");
 			cfg.streaming = false;
 			m_config.save();
+			m_statusWatcher->notifyTransition(false);
+			updateSessionLog();
 			UI::DialogFactory::message(QString::fromUtf8("直播已停止"), "消息");
 		} else {
 			UI::DialogFactory::message(QString::fromUtf8(message), "消息");
@@ -137,21 +504,76 @@ void BilibiliStreamPlugin::onStreamToggle()
 	} else if (!cfg.area_id) {
 		UI::DialogFactory::message(QString::fromUtf8("请更新直播间分区"), "消息");
 	} else {
-		std::string rtmpAddr, rtmpCode, faceQr;
-		if (Bili::BiliApi::startLive(cfg, rtmpAddr, rtmpCode, message, faceQr, cfg.mid)) {
-			m_menu->actions().streamToggle->setText("停止直播");
-			cfg.streaming = true;
-			cfg.rtmp_addr = rtmpAddr;
-			cfg.rtmp_code = rtmpCode;
-			m_config.save();
-			UI::DialogFactory::streamStarted((QWidget *)obs_frontend_get_main_window(), rtmpAddr, rtmpCode);
+		// 登录临近过期时先在工作线程上刷新，开播请求不会带着过期的 cookies 发出；结果见 onSessionChecked
+		auto started = std::chrono::steady_clock::now();
+		if (!m_session->ensureFresh({cfg.cookies, cfg.refresh_token}, kGoLiveSessionMarginS)) {
+			obs_log(LOG_INFO, "开播前的登录检查尚未结束，忽略本次开播");
+			return;
+		}
+		m_goLiveRoomId = cfg.room_id;
+		m_goLiveStarted = started;
+	}
+}
+
+void BilibiliStreamPlugin::onSessionChecked(bool fresh, const Core::SessionRenewal &renewal)
+{
+	// 刷新期间直播间可能已在别处开启，或者切换了直播间
+	auto &cfg = m_config.config();
+	if (cfg.streaming || cfg.room_id != m_goLiveRoomId)
+		return;
+	if (renewal.ok)
+		onSessionRenewed(renewal);
+	if (!fresh) {
+		UI::DialogFactory::message(QString::fromUtf8("登录已过期，请重新扫码登录"), "开播失败");
+		return;
+	}
+
+	std::string rtmpAddr, rtmpCode, faceQr, message;
+	std::vector<Bili::RtmpInfo> candidates;
+	if (!Bili::BiliApi::startLive(cfg, rtmpAddr, rtmpCode, message, faceQr, cfg.mid, &candidates)) {
+		if (!faceQr.empty()) {
+			UI::DialogFactory::faceAuth((QWidget *)obs_frontend_get_main_window(), faceQr);
 		} else {
-			if (!faceQr.empty()) {
-				UI::DialogFactory::faceAuth((QWidget *)obs_frontend_get_main_window(), faceQr);
-			} else {
-				UI::DialogFactory::message(QString::fromUtf8(message.c_str()), "开播失败");
-			}
+			UI::DialogFactory::message(QString::fromUtf8(message.c_str()), "开播失败");
 		}
+		return;
+	}
+	m_menu->actions().streamToggle->setText("停止直播");
+	cfg.streaming = true;
+	cfg.rtmp_addr = rtmpAddr;
+	cfg.rtmp_code = rtmpCode;
+	m_config.save();
+	m_statusWatcher->notifyTransition(true);
+	updateSessionLog();
+	m_bitrate->setArea(cfg.part_id, cfg.area_id);
+	// 在 OBS 连接推流前选出延迟最低的节点并测上行带宽；测速在后台进行，耗时一并计入开播前的阶段
+	Bili::RtmpInfo fallback{rtmpAddr, rtmpCode};
+	int uplinkCap = cfg.uplink_test ? Core::BitrateController::capForArea(cfg.part_id, cfg.area_id) : -1;
+	if (!m_preparer->prepare(candidates, fallback, kIngestProbeTimeoutMs, uplinkCap)) {
+		// 上一次的测速还没结束（刚下播又开播），不再测速，直接用接口默认节点
+		onGoLiveReady({fallback, {}});
+	}
+}
+
+void BilibiliStreamPlugin::onGoLiveReady(const Core::GoLivePlan &plan)
+{
+	// 测速期间可能已经下播，或直播间在别处被关闭
+	auto &cfg = m_config.config();
+	if (!cfg.streaming || cfg.room_id != m_goLiveRoomId)
+		return;
+	cfg.rtmp_addr = plan.chosen.addr;
+	cfg.rtmp_code = plan.chosen.code;
+	m_config.save();
+	m_bitrate->setUplinkLimit(plan.uplink_kbps);
+	auto apiMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+									  m_goLiveStarted)
+			     .count();
+	// 直接写入推流服务并开始推流，无法自动推流时才弹出推流地址
+	if (!m_launcher->launch(cfg.rtmp_addr, cfg.rtmp_code, apiMs)) {
+		UI::DialogFactory::streamStarted((QWidget *)obs_frontend_get_main_window(), cfg.rtmp_addr,
+						 cfg.rtmp_code);
+	} else if (cfg.backup_stream) {
+		m_failover->arm(plan.chosen, plan.backups);
 	}
 }
 
@@ -162,21 +584,40 @@ void BilibiliStreamPlugin::onUpdateRoomInfo()
 
 	UI::DialogFactory::roomSettings(parent, cfg.room_id, cfg.title, cfg.area_id, cfg.part_id,
 					[this, &cfg](const std::string &title, int areaId, int partId) {
-						std::string message;
-						if (!title.empty() && Bili::BiliApi::updateRoomInfo(cfg, title, message)) {
-							cfg.title = title;
-							m_config.save();
-							UI::DialogFactory::message(QString::fromUtf8("直播间标题已更新"), "消息");
-						}
-						if (areaId != cfg.area_id || partId != cfg.part_id) {
-							cfg.part_id = partId;
-							cfg.area_id = areaId;
-							m_config.save();
-							UI::DialogFactory::message(QString::fromUtf8("直播间分区已更新"), "消息");
-						}
+						// 标题和分区的修改交给 RoomInfoUpdater 合并为一次 Room/update
+						if (!title.empty() && title != cfg.title)
+							m_roomUpdater->setTitle(title);
+						if (areaId && (areaId != cfg.area_id || partId != cfg.part_id))
+							m_roomUpdater->setArea(partId, areaId);
 					});
 }
 
+void BilibiliStreamPlugin::onGiftRanking()
+{
+	UI::DialogFactory::giftRanking((QWidget *)obs_frontend_get_main_window(), m_gifts);
+}
+
+void BilibiliStreamPlugin::onLiveStatusChanged(bool streaming)
+{
+	// 直播间在服务端或其他设备上被开启 / 关闭，同步本地状态
+	auto &cfg = m_config.config();
+	if (cfg.streaming == streaming)
+		return;
+	cfg.streaming = streaming;
+	// 其他设备开启的直播用的是新推流码，清掉上一场的地址，免得本机输出停止时被当作这一场而自动下播
+	if (streaming) {
+		cfg.rtmp_addr.clear();
+		cfg.rtmp_code.clear();
+	}
+	m_menu->actions().streamToggle->setText(streaming ? "停止直播" : "开始直播");
+	m_config.save();
+	updateSessionLog();
+	if (!streaming) {
+		m_preparer->cancel();
+		m_failover->disarm();
+	}
+}
+
 static BilibiliStreamPlugin *plugin = nullptr;
 
 bool obs_module_load(void)
@@ -193,9 +634,10 @@ bool obs_module_load(void)
 
 void obs_module_unload(void)
 {
-	Bili::BiliApi::cleanup();
+	// 先释放插件（停止后台轮询线程），再清理 HTTP / curl
 	delete plugin;
 	plugin = nullptr;
+	Bili::BiliApi::cleanup();
 	obs_log(LOG_INFO, "插件已卸载");
 }
 
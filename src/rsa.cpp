@@ -0,0 +1,129 @@
+#include "rsa.hpp"
+#include <cstring>
+#include <random>
+#include "sha256.hpp"
+
+namespace Crypto {
+// 只用于少量公钥加密（指数很小），大数运算取最简单的实现：32 位分段、小端，
+// 模乘用移位相加，不追求速度也不需要抗侧信道（加密的内容不是秘密）
+using Limbs = std::vector<uint32_t>;
+
+static Limbs fromBytes(const unsigned char *data, size_t len, size_t limbs)
+{
+	Limbs out(limbs, 0);
+	for (size_t i = 0; i < len; ++i)
+		out[i / 4] |= (uint32_t)data[len - 1 - i] << ((i % 4) * 8);
+	return out;
+}
+
+static void toBytes(const Limbs &value, unsigned char *out, size_t len)
+{
+	for (size_t i = 0; i < len; ++i)
+		out[len - 1 - i] = (unsigned char)(value[i / 4] >> ((i % 4) * 8));
+}
+
+static bool lessThan(const Limbs &a, const Limbs &b)
+{
+	for (size_t i = a.size(); i-- > 0;) {
+		if (a[i] != b[i])
+			return a[i] < b[i];
+	}
+	return false;
+}
+
+// a、b < n，结果 < n；多留的一段容纳相加时的进位
+static void modAdd(Limbs &r, const Limbs &a, const Limbs &b, const Limbs &n)
+{
+	uint64_t carry = 0;
+	for (size_t i = 0; i < r.size(); ++i) {
+		carry += (uint64_t)a[i] + b[i];
+		r[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	if (lessThan(r, n))
+		return;
+	int64_t borrow = 0;
+	for (size_t i = 0; i < r.size(); ++i) {
+		borrow += (int64_t)r[i] - n[i];
+		r[i] = (uint32_t)borrow;
+		borrow >>= 32;
+	}
+}
+
+static Limbs modMul(const Limbs &a, const Limbs &b, const Limbs &n)
+{
+	Limbs r(n.size(), 0);
+	for (size_t i = a.size() * 32; i-- > 0;) {
+		modAdd(r, r, r, n);
+		if ((a[i / 32] >> (i % 32)) & 1)
+			modAdd(r, r, b, n);
+	}
+	return r;
+}
+
+static void mgf1Xor(unsigned char *out, size_t outLen, const unsigned char *seed, size_t seedLen)
+{
+	std::vector<unsigned char> block(seedLen + 4);
+	memcpy(block.data(), seed, seedLen);
+	unsigned char digest[32];
+	for (uint32_t counter = 0; outLen > 0; ++counter) {
+		for (int i = 0; i < 4; ++i)
+			block[seedLen + i] = (unsigned char)(counter >> (24 - i * 8));
+		Sha256Context ctx;
+		sha256Init(&ctx);
+		sha256Update(&ctx, block.data(), block.size());
+		sha256Final(digest, &ctx);
+		size_t n = outLen < sizeof(digest) ? outLen : sizeof(digest);
+		for (size_t i = 0; i < n; ++i)
+			out[i] ^= digest[i];
+		out += n;
+		outLen -= n;
+	}
+}
+
+std::vector<unsigned char> rsaOaepSha256Encrypt(const unsigned char *modulus, size_t modulusLen, uint32_t exponent,
+						const unsigned char *message, size_t messageLen)
+{
+	const size_t hLen = 32;
+	while (modulusLen > 0 && modulus[0] == 0) {
+		++modulus;
+		--modulusLen;
+	}
+	const size_t k = modulusLen;
+	if (k > 512 || k < 2 * hLen + 2 || messageLen > k - 2 * hLen - 2)
+		return {};
+
+	// EM = 0x00 || maskedSeed || maskedDB，DB = lHash || PS || 0x01 || M
+	std::vector<unsigned char> em(k, 0);
+	unsigned char *seed = &em[1];
+	unsigned char *db = &em[1 + hLen];
+	const size_t dbLen = k - hLen - 1;
+	Sha256Context ctx;
+	sha256Init(&ctx);
+	sha256Final(db, &ctx);
+	db[dbLen - messageLen - 1] = 0x01;
+	memcpy(&db[dbLen - messageLen], message, messageLen);
+
+	std::random_device random;
+	for (size_t i = 0; i < hLen; ++i)
+		seed[i] = (unsigned char)random();
+	mgf1Xor(db, dbLen, seed, hLen);
+	mgf1Xor(seed, hLen, db, dbLen);
+
+	// 首字节为 0，EM 一定小于模数
+	size_t limbs = (k + 3) / 4 + 1;
+	Limbs n = fromBytes(modulus, k, limbs);
+	Limbs base = fromBytes(em.data(), k, limbs);
+	Limbs result(limbs, 0);
+	result[0] = 1;
+	for (int bit = 31; bit >= 0; --bit) {
+		result = modMul(result, result, n);
+		if ((exponent >> bit) & 1)
+			result = modMul(result, base, n);
+	}
+
+	std::vector<unsigned char> out(k);
+	toBytes(result, out.data(), k);
+	return out;
+}
+} // namespace Crypto
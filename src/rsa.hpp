@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Crypto {
+// RSAES-OAEP 公钥加密（RFC 8017，哈希与 MGF1 均为 SHA-256，label 为空）。
+// modulus 为大端字节序，最长 4096 位；消息过长时返回空
+std::vector<unsigned char> rsaOaepSha256Encrypt(const unsigned char *modulus, size_t modulusLen, uint32_t exponent,
+						const unsigned char *message, size_t messageLen);
+} // namespace Crypto
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Crypto {
+struct Sha256Context {
+	uint32_t state[8];
+	uint64_t count; // 已处理的字节数
+	unsigned char buffer[64];
+};
+
+void sha256Init(Sha256Context *context);
+void sha256Update(Sha256Context *context, const unsigned char *input, size_t inputLen);
+void sha256Final(unsigned char digest[32], Sha256Context *context);
+} // namespace Crypto
@@ -7,10 +7,11 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QComboBox>
-#include <QTimer>
 #include <QApplication>
 #include <QClipboard>
 #include "core/qr_generator.hpp"
+#include "core/qr_login_poller.hpp"
+#include "core/gift_aggregator.hpp"
 #include "bilibili_api.hpp"
 
 namespace UI {
@@ -36,8 +37,25 @@ void DialogFactory::message(const QString &msg, const QString &title, QWidget *p
 	dialog->exec();
 }
 
+bool DialogFactory::confirm(const QString &msg, const QString &title, QWidget *parent)
+{
+	QDialog *dialog = createBaseDialog(title, parent ? parent : (QWidget *)obs_frontend_get_main_window());
+	QVBoxLayout *layout = (QVBoxLayout *)dialog->layout();
+	layout->addWidget(new QLabel(msg));
+	QHBoxLayout *buttons = new QHBoxLayout();
+	QPushButton *ok = new QPushButton("确认");
+	QPushButton *cancel = new QPushButton("取消");
+	buttons->addWidget(ok);
+	buttons->addWidget(cancel);
+	layout->addLayout(buttons);
+	QObject::connect(ok, &QPushButton::clicked, dialog, &QDialog::accept);
+	QObject::connect(cancel, &QPushButton::clicked, dialog, &QDialog::reject);
+	QObject::connect(dialog, &QDialog::finished, dialog, &QDialog::deleteLater);
+	return dialog->exec() == QDialog::Accepted;
+}
+
 QDialog *DialogFactory::qrLogin(QWidget *parent, const std::string &qrData, std::string &qrKey,
-				std::function<void(const std::string &cookies)> onSuccess)
+				std::function<void(const std::string &cookies, const std::string &refreshToken)> onSuccess)
 {
 	QDialog *dialog = createBaseDialog("Bilibili 登录二维码", parent);
 	QVBoxLayout *layout = (QVBoxLayout *)dialog->layout();
@@ -50,35 +68,35 @@ QDialog *DialogFactory::qrLogin(QWidget *parent, const std::string &qrData, std:
 		qrLabel->setPixmap(pixmap);
 	}
 	layout->addWidget(qrLabel);
-	layout->addWidget(new QLabel("使用手机扫描二维码登录"));
-
-	QTimer *timer = new QTimer(dialog);
-	int retryCount = 0;
-
-	auto timerCallback = [&, retryCount, qrKey, onSuccess, timer, qrLabel, dialog]() mutable {
-		if (retryCount > 180) {
-			timer->stop();
-			qrLabel->setText("二维码已过期，请重新打开");
-			return;
-		}
-		++retryCount;
-
-		std::string cookies, message;
-		if (Bili::BiliApi::qrLogin(qrKey, cookies, message)) {
-			timer->stop();
-			if (onSuccess)
-				onSuccess(cookies);
-			dialog->accept();
-		}
-	};
-
-	QObject::connect(timer, &QTimer::timeout, timerCallback);
-	QObject::connect(dialog, &QDialog::finished, [timer, dialog]() {
-		timer->stop();
+	QLabel *statusLabel = new QLabel("使用手机扫描二维码登录");
+	layout->addWidget(statusLabel);
+
+	// 轮询在后台线程进行，状态变化通过排队信号回到 UI 线程
+	auto *poller = new Core::QrLoginPoller(qrKey, dialog);
+	QObject::connect(poller, &Core::QrLoginPoller::stateChanged, statusLabel,
+			 [statusLabel](int code, const QString &message) {
+				 if (code == 86090)
+					 statusLabel->setText("已扫码，请在手机上确认登录");
+				 else if (code == -1)
+					 statusLabel->setText(message);
+			 });
+	QObject::connect(poller, &Core::QrLoginPoller::expired, qrLabel, [poller, qrLabel](const QString &message) {
+		poller->stop();
+		qrLabel->setText(message);
+	});
+	QObject::connect(poller, &Core::QrLoginPoller::succeeded, dialog,
+			 [poller, onSuccess, dialog](const QString &cookies, const QString &refreshToken) {
+				 poller->stop();
+				 if (onSuccess)
+					 onSuccess(cookies.toStdString(), refreshToken.toStdString());
+				 dialog->accept();
+			 });
+	QObject::connect(dialog, &QDialog::finished, [poller, dialog]() {
+		poller->stop();
 		dialog->deleteLater();
 	});
 
-	timer->start(1000);
+	poller->start();
 	dialog->exec();
 	return dialog;
 }
@@ -170,24 +188,13 @@ QDialog *DialogFactory::roomSettings(QWidget *parent, const std::string &roomUrl
 	partitionRow->addWidget(confirmPartition);
 	layout->addLayout(partitionRow);
 
-	struct Part {
-		int id;
-		std::string name;
-		std::vector<json11::Json> list;
-	};
-	std::vector<Part> parts;
+	std::vector<Bili::Partition> parts;
 	std::string message;
-	auto partitionData = Bili::BiliApi::getPartitionList(message);
-	if (partitionData.is_array()) {
-		for (const auto &item : partitionData.array_items()) {
-			parts.push_back({item["id"].int_value(), item["name"].string_value(),
-					 item["list"].array_items()});
-		}
-	}
+	Bili::BiliApi::getPartitionList(parts, message);
 
 	size_t selectedPartIndex = 0;
 	for (size_t i = 0; i < parts.size(); ++i) {
-		partCombo->addItem(QString::fromStdString(parts[i].name), parts[i].id);
+		partCombo->addItem(QString::fromStdString(parts[i].name), static_cast<int>(parts[i].id));
 		if (parts[i].id == currentPartId)
 			selectedPartIndex = i;
 	}
@@ -198,8 +205,8 @@ QDialog *DialogFactory::roomSettings(QWidget *parent, const std::string &roomUrl
 		if (partIndex >= 0 && static_cast<size_t>(partIndex) < parts.size() && !parts[partIndex].list.empty()) {
 			size_t selectedAreaIndex = 0;
 			for (size_t i = 0; i < parts[partIndex].list.size(); ++i) {
-				int id = std::stoi(parts[partIndex].list[i]["id"].string_value());
-				QString name = QString::fromStdString(parts[partIndex].list[i]["name"].string_value());
+				int id = static_cast<int>(parts[partIndex].list[i].id);
+				QString name = QString::fromStdString(parts[partIndex].list[i].name);
 				areaCombo->addItem(name, id);
 				if (id == currentAreaId)
 					selectedAreaIndex = i;
@@ -237,4 +244,54 @@ QDialog *DialogFactory::roomSettings(QWidget *parent, const std::string &roomUrl
 	return dialog;
 }
 
+static QString formatGiftWindow(const Core::GiftWindow &window)
+{
+	QString text = QString("<b>最近 %1 分钟</b>：%2 个礼物，%3 金瓜子<br>")
+			       .arg(window.minutes)
+			       .arg(window.totalCount)
+			       .arg(window.totalValue);
+	for (size_t i = 0; i < window.top.size(); ++i) {
+		const auto &rank = window.top[i];
+		text += QString("%1. %2　%3 金瓜子（%4 个）<br>")
+				.arg(i + 1)
+				.arg(QString::fromStdString(rank.uname).toHtmlEscaped())
+				.arg(rank.value)
+				.arg(rank.count);
+	}
+	if (window.top.empty())
+		text += "暂无礼物<br>";
+	return text;
+}
+
+QDialog *DialogFactory::giftRanking(QWidget *parent, Core::GiftAggregator *aggregator)
+{
+	QDialog *dialog = createBaseDialog("礼物排行", parent);
+	QVBoxLayout *layout = (QVBoxLayout *)dialog->layout();
+
+	QHBoxLayout *columns = new QHBoxLayout();
+	QLabel *labels[3];
+	for (auto &label : labels) {
+		label = new QLabel();
+		label->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+		columns->addWidget(label);
+	}
+	layout->addLayout(columns);
+
+	// 聚合器每 10 秒产出一次汇总，对话框打开期间跟随刷新
+	auto refresh = [labels](const Core::GiftRollup &rollup) {
+		for (int i = 0; i < 3; ++i)
+			labels[i]->setText(formatGiftWindow(rollup.windows[i]));
+	};
+	refresh(aggregator->latest());
+	QObject::connect(aggregator, &Core::GiftAggregator::rollupReady, dialog, refresh);
+
+	QPushButton *closeBtn = new QPushButton("关闭");
+	layout->addWidget(closeBtn);
+	QObject::connect(closeBtn, &QPushButton::clicked, dialog, &QDialog::accept);
+
+	QObject::connect(dialog, &QDialog::finished, dialog, &QDialog::deleteLater);
+	dialog->exec();
+	return dialog;
+}
+
 } // namespace UI
@@ -4,16 +4,23 @@
 #include <string>
 #include <functional>
 
+namespace Core {
+class GiftAggregator;
+}
+
 namespace UI {
 class DialogFactory {
 public:
 	static void message(const QString &msg, const QString &title, QWidget *parent = nullptr);
+	// 确认 / 取消，返回是否确认
+	static bool confirm(const QString &msg, const QString &title, QWidget *parent = nullptr);
 	static QDialog *qrLogin(QWidget *parent, const std::string &qrData, std::string &qrKey,
-				 std::function<void(const std::string &cookies)> onSuccess);
+				 std::function<void(const std::string &cookies, const std::string &refreshToken)> onSuccess);
 	static QDialog *streamStarted(QWidget *parent, const std::string &rtmpAddr, const std::string &rtmpCode);
 	static QDialog *faceAuth(QWidget *parent, const std::string &faceUrl);
 	static QDialog *roomSettings(QWidget *parent, const std::string &roomUrl, const std::string &currentTitle,
 				    int currentAreaId, int currentPartId,
 				    std::function<void(const std::string &title, int areaId, int partId)> onApply);
+	static QDialog *giftRanking(QWidget *parent, Core::GiftAggregator *aggregator);
 };
 } // namespace UI
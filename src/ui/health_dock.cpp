@@ -0,0 +1,40 @@
+#include "ui/health_dock.hpp"
+#include <QFormLayout>
+
+namespace UI {
+HealthDock::HealthDock(Core::OutputHealthMonitor *monitor, QWidget *parent)
+	: QWidget(parent),
+	  m_status(new QLabel()),
+	  m_bitrate(new QLabel()),
+	  m_drops(new QLabel()),
+	  m_congestion(new QLabel()),
+	  m_connect(new QLabel()),
+	  m_overhead(new QLabel())
+{
+	QFormLayout *layout = new QFormLayout(this);
+	layout->addRow("状态", m_status);
+	layout->addRow("码率", m_bitrate);
+	layout->addRow("丢帧", m_drops);
+	layout->addRow("拥塞", m_congestion);
+	layout->addRow("连接耗时", m_connect);
+	layout->addRow("采样开销", m_overhead);
+	setLayout(layout);
+
+	showHealth(monitor->current());
+	connect(monitor, &Core::OutputHealthMonitor::healthUpdated, this, &HealthDock::showHealth);
+}
+
+void HealthDock::showHealth(const Core::OutputHealth &health)
+{
+	m_status->setText(health.active ? "推流中" : "未推流");
+	const char *trend = health.trend_kbps_per_s > 20 ? " ↑" : health.trend_kbps_per_s < -20 ? " ↓" : "";
+	m_bitrate->setText(QString("%1 kbps%2").arg(health.bitrate_kbps, 0, 'f', 0).arg(trend));
+	m_drops->setText(QString("%1% （累计 %2 / %3）")
+				 .arg(health.drop_rate, 0, 'f', 2)
+				 .arg(health.dropped_frames)
+				 .arg(health.total_frames));
+	m_congestion->setText(QString("%1%").arg(health.congestion * 100.0, 0, 'f', 0));
+	m_connect->setText(QString("%1 ms").arg(health.connect_time_ms));
+	m_overhead->setText(QString("%1% CPU").arg(health.sampler_cpu, 0, 'f', 3));
+}
+} // namespace UI
@@ -0,0 +1,23 @@
+#pragma once
+#include <QLabel>
+#include <QWidget>
+#include "core/output_health.hpp"
+
+namespace UI {
+// 推流状态停靠窗口：码率、丢帧、拥塞和采样开销
+class HealthDock : public QWidget {
+	Q_OBJECT
+public:
+	explicit HealthDock(Core::OutputHealthMonitor *monitor, QWidget *parent = nullptr);
+
+private:
+	void showHealth(const Core::OutputHealth &health);
+
+	QLabel *m_status;
+	QLabel *m_bitrate;
+	QLabel *m_drops;
+	QLabel *m_congestion;
+	QLabel *m_connect;
+	QLabel *m_overhead;
+};
+} // namespace UI
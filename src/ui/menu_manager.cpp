@@ -17,14 +17,51 @@ void MenuManager::setupMenu()
 	m_actions.loginStatus = loginMenu->addAction("登录状态: 未登录");
 	m_actions.loginStatus->setCheckable(true);
 	m_actions.loginStatus->setEnabled(false);
+	loginMenu->addSeparator();
+	m_actions.addAccount = loginMenu->addAction("添加账号");
+	m_actions.removeAccount = loginMenu->addAction("移除当前账号");
+	m_roomMenu = bilibiliMenu->addMenu("切换直播间");
+	m_roomGroup = new QActionGroup(this);
+	m_roomGroup->setExclusive(true);
 
 	m_actions.streamToggle = bilibiliMenu->addAction("开始直播");
 	m_actions.openRoom = bilibiliMenu->addAction("打开直播间");
 	m_actions.updateRoomInfo = bilibiliMenu->addAction("更新直播间信息");
+	m_actions.giftRanking = bilibiliMenu->addAction("礼物排行");
+	m_actions.backupStream = bilibiliMenu->addAction("备用推流");
+	m_actions.backupStream->setCheckable(true);
+	m_actions.adaptiveBitrate = bilibiliMenu->addAction("自适应码率");
+	m_actions.adaptiveBitrate->setCheckable(true);
+	m_actions.uplinkTest = bilibiliMenu->addAction("开播前测速");
+	m_actions.uplinkTest->setCheckable(true);
 
 	connect(m_actions.scanQrcode, &QAction::triggered, this, &MenuManager::scanQrcodeClicked);
+	connect(m_actions.addAccount, &QAction::triggered, this, &MenuManager::addAccountClicked);
+	connect(m_actions.removeAccount, &QAction::triggered, this, &MenuManager::removeAccountClicked);
 	connect(m_actions.streamToggle, &QAction::triggered, this, &MenuManager::streamToggleClicked);
 	connect(m_actions.openRoom, &QAction::triggered, this, &MenuManager::openRoomClicked);
 	connect(m_actions.updateRoomInfo, &QAction::triggered, this, &MenuManager::updateRoomInfoClicked);
+	connect(m_actions.giftRanking, &QAction::triggered, this, &MenuManager::giftRankingClicked);
+	connect(m_actions.backupStream, &QAction::toggled, this, &MenuManager::backupStreamToggled);
+	connect(m_actions.adaptiveBitrate, &QAction::toggled, this, &MenuManager::adaptiveBitrateToggled);
+	connect(m_actions.uplinkTest, &QAction::toggled, this, &MenuManager::uplinkTestToggled);
+}
+
+void MenuManager::setRooms(const QStringList &labels, int active)
+{
+	// 选择直播间时会经由 roomSelected 回到这里，被点击的 action 仍在发出 triggered，只能延后删除
+	for (QAction *action : m_roomGroup->actions()) {
+		m_roomGroup->removeAction(action);
+		m_roomMenu->removeAction(action);
+		action->deleteLater();
+	}
+	for (int i = 0; i < labels.size(); ++i) {
+		QAction *action = m_roomMenu->addAction(labels[i]);
+		action->setCheckable(true);
+		action->setChecked(i == active);
+		m_roomGroup->addAction(action);
+		connect(action, &QAction::triggered, this, [this, i]() { emit roomSelected(i); });
+	}
+	m_actions.removeAccount->setEnabled(labels.size() > 1);
 }
 } // namespace UI
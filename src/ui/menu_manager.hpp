@@ -1,7 +1,10 @@
 #pragma once
 #include <QMenuBar>
 #include <QAction>
+#include <QActionGroup>
+#include <QMenu>
 #include <QObject>
+#include <QStringList>
 
 namespace UI {
 class MenuManager : public QObject {
@@ -10,23 +13,40 @@ public:
 	struct Actions {
 		QAction *scanQrcode = nullptr;
 		QAction *loginStatus = nullptr;
+		QAction *addAccount = nullptr;
+		QAction *removeAccount = nullptr;
 		QAction *streamToggle = nullptr;
 		QAction *openRoom = nullptr;
 		QAction *updateRoomInfo = nullptr;
+		QAction *giftRanking = nullptr;
+		QAction *backupStream = nullptr;
+		QAction *adaptiveBitrate = nullptr;
+		QAction *uplinkTest = nullptr;
 	};
 
 	explicit MenuManager(QMenuBar *menuBar, QObject *parent = nullptr);
 	Actions &actions() { return m_actions; }
+	// 重建“切换直播间”子菜单，每个账号一项
+	void setRooms(const QStringList &labels, int active);
 
 signals:
 	void scanQrcodeClicked();
+	void addAccountClicked();
+	void removeAccountClicked();
+	void roomSelected(int index);
 	void streamToggleClicked();
 	void openRoomClicked();
 	void updateRoomInfoClicked();
+	void giftRankingClicked();
+	void backupStreamToggled(bool enabled);
+	void adaptiveBitrateToggled(bool enabled);
+	void uplinkTestToggled(bool enabled);
 
 private:
 	void setupMenu();
 	Actions m_actions;
+	QMenu *m_roomMenu = nullptr;
+	QActionGroup *m_roomGroup = nullptr;
 	QMenuBar *m_menuBar;
 };
 } // namespace UI
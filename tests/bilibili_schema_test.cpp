@@ -0,0 +1,87 @@
+// 按路径提取（Schema::extract）的边界测试：输入是不以 NUL 结尾的缓冲，截断和空输入都不能越界读取
+#include <vector>
+#include "bilibili_schema.hpp"
+#include "test_support.hpp"
+
+using namespace Bili;
+
+namespace {
+const std::string kQrResponse =
+	R"({"code":0,"message":"0","ttl":1,"data":{"url":"https://passport.bilibili.com/h5-app/passport/login/scan",)"
+	R"("qrcode_key":"8a7b6c","list":[{"id":1},{"id":2,"tags":["a","b"]}]}})";
+
+// 拷贝到大小恰好的堆缓冲上再提取，越界读取会被 ASan 报告
+bool extractCopy(std::string_view in, std::vector<std::string_view> &values, std::string &err,
+		 std::vector<char> &storage)
+{
+	storage.assign(in.begin(), in.end());
+	return Schema::extract(std::string_view(storage.data(), storage.size()),
+			       {"data.url", "data.qrcode_key", "data.list.1.id", "data.list.1.tags.0"}, values, err);
+}
+
+void testExtractsPaths()
+{
+	std::vector<char> storage;
+	std::vector<std::string_view> values;
+	std::string err;
+	CHECK(extractCopy(kQrResponse, values, err, storage));
+	CHECK(values.size() == 4);
+	CHECK(values[0] == "\"https://passport.bilibili.com/h5-app/passport/login/scan\"");
+	CHECK(values[1] == "\"8a7b6c\"");
+	CHECK(values[2] == "2");
+	CHECK(values[3] == "\"a\"");
+
+	std::string qrKey;
+	CHECK(Schema::decodeRaw(values[1], qrKey));
+	CHECK(qrKey == "8a7b6c");
+}
+
+// 每个真前缀都是截断的文档：提取失败、给出错误信息，且不返回指向输入之外的视图
+void testTruncatedInput()
+{
+	for (size_t n = 0; n < kQrResponse.size(); ++n) {
+		std::vector<char> storage;
+		std::vector<std::string_view> values;
+		std::string err;
+		CHECK(!extractCopy(std::string_view(kQrResponse).substr(0, n), values, err, storage));
+		CHECK(!err.empty());
+		CHECK(values.size() == 4);
+		for (auto value : values)
+			CHECK(value.empty());
+	}
+
+	// 停在各个值的起点之前
+	const char *cases[] = {"{\"data\":", "{\"data\":   ", "{\"data\":{\"list\":", "{\"data\":{\"list\":[",
+			       "{\"data\":{\"list\":[{}, ", "{\"data\":{\"url\":\"abc", "{\"data\":{\"url\":\"\\"};
+	for (const char *text : cases) {
+		std::vector<char> storage;
+		std::vector<std::string_view> values;
+		std::string err;
+		CHECK(!extractCopy(text, values, err, storage));
+		CHECK(!err.empty());
+	}
+}
+
+void testEmptyInput()
+{
+	std::vector<std::string_view> values;
+	std::string err;
+	CHECK(!Schema::extract(std::string_view(), {"data.url"}, values, err));
+	CHECK(!err.empty());
+	CHECK(values.size() == 1 && values[0].empty());
+
+	std::vector<char> storage;
+	err.clear();
+	CHECK(!extractCopy("   ", values, err, storage));
+	CHECK(!err.empty());
+}
+} // namespace
+
+int main()
+{
+	testExtractsPaths();
+	testTruncatedInput();
+	testEmptyInput();
+	std::printf("bilibili_schema_test: ok\n");
+	return 0;
+}
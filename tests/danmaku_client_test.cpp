@@ -0,0 +1,293 @@
+// 弹幕客户端对本地 websocket 替身的端到端测试：鉴权、收包、以及 stop() 能否及时打断
+#include <condition_variable>
+#include <curl/curl.h>
+#include <zlib.h>
+#include "danmaku/danmaku_client.hpp"
+#include "danmaku/danmaku_protocol.hpp"
+#include "json11/json11.hpp"
+#include "test_support.hpp"
+
+using namespace Danmaku;
+
+namespace {
+// 读一帧客户端发来的（带掩码的）websocket 帧，返回解掩码后的负载
+bool readClientFrame(Test::Socket s, std::string &payload)
+{
+	unsigned char head[2];
+	if (!Test::readExact(s, reinterpret_cast<char *>(head), 2))
+		return false;
+	uint64_t len = head[1] & 0x7f;
+	if (len == 126 || len == 127) {
+		unsigned char ext[8];
+		size_t n = len == 126 ? 2 : 8;
+		if (!Test::readExact(s, reinterpret_cast<char *>(ext), n))
+			return false;
+		len = 0;
+		for (size_t i = 0; i < n; ++i)
+			len = (len << 8) | ext[i];
+	}
+	unsigned char mask[4] = {0, 0, 0, 0};
+	if ((head[1] & 0x80) && !Test::readExact(s, reinterpret_cast<char *>(mask), 4))
+		return false;
+	payload.resize(len);
+	if (len && !Test::readExact(s, &payload[0], len))
+		return false;
+	for (size_t i = 0; i < payload.size(); ++i)
+		payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+	return true;
+}
+
+bool sendBinaryFrame(Test::Socket s, const std::string &payload)
+{
+	std::string frame(1, '\x82');
+	if (payload.size() < 126) {
+		frame += static_cast<char>(payload.size());
+	} else {
+		frame += static_cast<char>(126);
+		frame += static_cast<char>((payload.size() >> 8) & 0xff);
+		frame += static_cast<char>(payload.size() & 0xff);
+	}
+	frame += payload;
+	return Test::writeAll(s, frame.data(), frame.size());
+}
+
+std::string headerValue(const std::string &head, const std::string &name)
+{
+	auto pos = head.find(name + ": ");
+	if (pos == std::string::npos)
+		return {};
+	pos += name.size() + 2;
+	return head.substr(pos, head.find("\r\n", pos) - pos);
+}
+
+// 极简 SHA-1 + base64，只用于计算 Sec-WebSocket-Accept
+std::string websocketAccept(const std::string &key)
+{
+	std::string msg = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+	uint64_t bits = uint64_t(msg.size()) * 8;
+	msg += '\x80';
+	while (msg.size() % 64 != 56)
+		msg += '\0';
+	for (int i = 7; i >= 0; --i)
+		msg += static_cast<char>((bits >> (i * 8)) & 0xff);
+
+	uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+	auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+	for (size_t off = 0; off < msg.size(); off += 64) {
+		uint32_t w[80];
+		for (int i = 0; i < 16; ++i) {
+			auto p = reinterpret_cast<const unsigned char *>(msg.data() + off + i * 4);
+			w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+		}
+		for (int i = 16; i < 80; ++i)
+			w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+		for (int i = 0; i < 80; ++i) {
+			uint32_t f, k;
+			if (i < 20) {
+				f = (b & c) | (~b & d);
+				k = 0x5A827999;
+			} else if (i < 40) {
+				f = b ^ c ^ d;
+				k = 0x6ED9EBA1;
+			} else if (i < 60) {
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8F1BBCDC;
+			} else {
+				f = b ^ c ^ d;
+				k = 0xCA62C1D6;
+			}
+			uint32_t t = rol(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = rol(b, 30);
+			b = a;
+			a = t;
+		}
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+	}
+
+	unsigned char digest[20];
+	for (int i = 0; i < 20; ++i)
+		digest[i] = static_cast<unsigned char>(h[i / 4] >> (24 - (i % 4) * 8));
+	static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::string out;
+	for (int i = 0; i < 20; i += 3) {
+		uint32_t v = uint32_t(digest[i]) << 16;
+		if (i + 1 < 20)
+			v |= uint32_t(digest[i + 1]) << 8;
+		if (i + 2 < 20)
+			v |= digest[i + 2];
+		out += table[(v >> 18) & 63];
+		out += table[(v >> 12) & 63];
+		out += i + 1 < 20 ? table[(v >> 6) & 63] : '=';
+		out += i + 2 < 20 ? table[v & 63] : '=';
+	}
+	return out;
+}
+
+bool acceptUpgrade(Test::Socket s)
+{
+	std::string head = Test::readHeaders(s);
+	std::string key = headerValue(head, "Sec-WebSocket-Key");
+	if (key.empty())
+		return false;
+	std::string reply = "HTTP/1.1 101 Switching Protocols\r\n"
+			    "Upgrade: websocket\r\n"
+			    "Connection: Upgrade\r\n"
+			    "Sec-WebSocket-Accept: " +
+			    websocketAccept(key) + "\r\n\r\n";
+	return Test::writeAll(s, reply.data(), reply.size());
+}
+
+std::string compressedBundle(const std::string &inner)
+{
+	uLongf size = compressBound(static_cast<uLong>(inner.size()));
+	std::string body(size, '\0');
+	CHECK(compress(reinterpret_cast<Bytef *>(&body[0]), &size, reinterpret_cast<const Bytef *>(inner.data()),
+		       static_cast<uLong>(inner.size())) == Z_OK);
+	body.resize(size);
+	std::string packet = encodePacket(OP_MESSAGE, body);
+	packet[6] = 0;
+	packet[7] = static_cast<char>(PROTO_ZLIB);
+	return packet;
+}
+
+// 解压后超过上限的合包整帧丢弃，不会无限制地占用内存；上限以内的大合包照常展开
+void testOversizedBundle()
+{
+	FrameDecoder decoder;
+	std::vector<PacketView> packets;
+	std::string err;
+
+	std::string chat = encodePacket(OP_MESSAGE, "{\"cmd\":\"DANMU_MSG\"}");
+	std::string inner;
+	while (inner.size() < 3 * 1024 * 1024)
+		inner += chat;
+	std::string frame = encodePacket(OP_HEARTBEAT_REPLY, std::string(4, '\0')) + compressedBundle(inner);
+	CHECK(decoder.decode(frame.data(), frame.size(), packets, err));
+	CHECK(packets.size() == 1 + inner.size() / chat.size());
+
+	while (inner.size() < 5 * 1024 * 1024)
+		inner += chat;
+	frame = encodePacket(OP_HEARTBEAT_REPLY, std::string(4, '\0')) + compressedBundle(inner);
+	CHECK(!decoder.decode(frame.data(), frame.size(), packets, err));
+	CHECK(packets.empty());
+	CHECK(!err.empty());
+}
+
+// 正常流程：握手 → 收到鉴权包 → 回鉴权结果和一条弹幕 → 客户端回调收到事件
+void testReceivesEvents()
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<Event> events;
+	std::string authBody;
+
+	Test::LoopbackServer server([&](Test::Socket s, const Test::LoopbackServer &srv) {
+		if (!acceptUpgrade(s))
+			return;
+		std::string payload;
+		if (!readClientFrame(s, payload))
+			return;
+		FrameDecoder decoder;
+		std::vector<PacketView> packets;
+		std::string err;
+		if (decoder.decode(payload.data(), payload.size(), packets, err) && !packets.empty() &&
+		    packets[0].op == OP_AUTH) {
+			std::lock_guard<std::mutex> lock(mutex);
+			authBody.assign(packets[0].body.data(), packets[0].body.size());
+		}
+		json11::Json danmu = json11::Json::object{
+			{"cmd", "DANMU_MSG"},
+			{"info", json11::Json::array{json11::Json::array{}, "你好", json11::Json::array{42, "tester"}}},
+		};
+		sendBinaryFrame(s, encodePacket(OP_AUTH_REPLY, "{\"code\":0}") + encodePacket(OP_MESSAGE, danmu.dump()));
+		// 保持连接直到测试结束，避免客户端进入重连
+		while (!srv.stopping())
+			Test::waitReadable(s, 50);
+	});
+
+	DanmakuClient client([&](Event &&event) {
+		std::lock_guard<std::mutex> lock(mutex);
+		events.push_back(std::move(event));
+		cv.notify_all();
+	});
+	ClientOptions options;
+	options.room_id = "1234";
+	options.uid = 7;
+	options.url = "ws://" + server.address() + "/sub";
+	options.token = "token";
+	client.start(options);
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		CHECK(cv.wait_for(lock, std::chrono::seconds(5), [&] { return !events.empty(); }));
+		CHECK(events[0].type == EventType::Chat);
+		CHECK(events[0].text == "你好");
+		CHECK(events[0].uid == 42);
+		CHECK(events[0].uname == "tester");
+
+		std::string err;
+		json11::Json auth = json11::Json::parse(authBody, err);
+		CHECK(err.empty());
+		CHECK(auth["roomid"].int_value() == 1234);
+		CHECK(auth["uid"].int_value() == 7);
+		CHECK(auth["key"].string_value() == "token");
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	client.stop();
+	CHECK(Test::msSince(started) < 1000);
+	CHECK(client.stats().errors == 0);
+}
+
+// 服务端接受 TCP 连接却迟迟不完成 websocket 握手：stop() 必须立即返回，而不是等连接超时
+void testStopAbortsPendingHandshake()
+{
+	Test::LoopbackServer server([](Test::Socket s, const Test::LoopbackServer &srv) {
+		Test::readHeaders(s);
+		while (!srv.stopping())
+			Test::waitReadable(s, 50);
+	});
+
+	DanmakuClient client([](Event &&) {});
+	ClientOptions options;
+	options.room_id = "1234";
+	options.url = "ws://" + server.address() + "/sub";
+	client.start(options);
+
+	auto started = std::chrono::steady_clock::now();
+	while (server.accepted() == 0 && Test::msSince(started) < 5000)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK(server.accepted() == 1);
+	// 给 curl 一点时间发出升级请求并进入等待
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	started = std::chrono::steady_clock::now();
+	client.stop();
+	CHECK(Test::msSince(started) < 1000);
+	CHECK(!client.running());
+}
+} // namespace
+
+int main()
+{
+	testOversizedBundle();
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+	if (!DanmakuClient::supported()) {
+		std::printf("danmaku_client_test: skipped, libcurl %s has no wss support\n",
+			    curl_version_info(CURLVERSION_NOW)->version);
+		curl_global_cleanup();
+		return 77;
+	}
+	testReceivesEvents();
+	testStopAbortsPendingHandshake();
+	curl_global_cleanup();
+	std::printf("danmaku_client_test: ok\n");
+	return 0;
+}
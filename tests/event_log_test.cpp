@@ -0,0 +1,225 @@
+// 场次日志（.blog）测试：写入 → mmap 扫描 → 回放的往返、末尾记录被截断、以及文件头校验的各个错误分支
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "core/event_log.hpp"
+#include "test_support.hpp"
+
+using Danmaku::Event;
+using Danmaku::EventType;
+
+namespace {
+const int64_t kRoomId = 21452505;
+const size_t kEventCount = 200000;
+
+std::string tempPath(const char *name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string readFile(const std::string &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &data)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(data.data(), std::streamsize(data.size()));
+}
+
+// 覆盖各事件类型、负数、大整数、空串、多字节 UTF-8 和超过 127 字节（长度需要两字节变长编码）的字段
+Event makeEvent(size_t i)
+{
+	Event e;
+	e.type = static_cast<EventType>(1 + i % 4);
+	e.timestamp_ms = 1700000000000 + int64_t(i) * 7 - int64_t(i % 5) * 1000;
+	e.uid = i % 3 == 0 ? -int64_t(i) : int64_t(i) * 100003;
+	e.uname = i % 11 == 0 ? std::string() : "用户" + std::to_string(i);
+	e.text = i % 13 == 0 ? std::string(200 + i % 50, 'x') : "弹幕 " + std::to_string(i * i);
+	e.gift_id = int64_t(i % 17);
+	e.gift_num = i % 2 ? int64_t(i) : 0;
+	e.gift_price = i % 7 == 0 ? INT64_MAX - int64_t(i) : int64_t(i % 1000);
+	e.value = i % 9 == 0 ? INT64_MIN + int64_t(i) : int64_t(i % 2);
+	return e;
+}
+
+bool sameEvent(const Event &a, const Event &b)
+{
+	return a.type == b.type && a.timestamp_ms == b.timestamp_ms && a.uid == b.uid && a.uname == b.uname &&
+	       a.text == b.text && a.gift_id == b.gift_id && a.gift_num == b.gift_num &&
+	       a.gift_price == b.gift_price && a.value == b.value;
+}
+
+// 分批从另一个线程追加，与事件总线分发线程的用法一致
+void writeLog(const std::string &path, size_t count)
+{
+	Core::EventLogWriter writer;
+	CHECK(writer.open(path, kRoomId));
+	CHECK(writer.isOpen());
+	std::thread producer([&] {
+		std::vector<Event> batch;
+		for (size_t i = 0; i < count; ++i) {
+			batch.push_back(makeEvent(i));
+			if (batch.size() == 1 + i % 300 || i + 1 == count) {
+				writer.append(batch.data(), batch.size());
+				batch.clear();
+			}
+		}
+	});
+	producer.join();
+	writer.close();
+	CHECK(!writer.isOpen());
+}
+
+void testRoundTrip(const std::string &path)
+{
+	writeLog(path, kEventCount);
+
+	Core::EventLogReader reader;
+	std::string err;
+	CHECK(reader.open(path, err));
+	CHECK(reader.roomId() == kRoomId);
+	CHECK(reader.startMs() > 0);
+
+	size_t index = 0;
+	bool same = true;
+	size_t scanned = reader.scan([&](const Event &event) { same = same && sameEvent(event, makeEvent(index++)); });
+	CHECK(scanned == kEventCount);
+	CHECK(index == kEventCount);
+	CHECK(same);
+
+	// 不等待地回放：全部事件按原顺序分批送达
+	index = 0;
+	size_t batches = 0;
+	size_t replayed = reader.replay(0, [&](const Event *events, size_t count) {
+		++batches;
+		CHECK(count > 0);
+		for (size_t i = 0; i < count; ++i)
+			same = same && sameEvent(events[i], makeEvent(index++));
+	});
+	CHECK(replayed == kEventCount);
+	CHECK(index == kEventCount);
+	CHECK(batches > 1);
+	CHECK(same);
+
+	// stop 已置位时只送出第一条
+	std::atomic<bool> stop{true};
+	index = 0;
+	replayed = reader.replay(0, [&](const Event *, size_t count) { index += count; }, &stop);
+	CHECK(replayed == 1);
+	CHECK(index == 1);
+}
+
+uint32_t readU32(const std::string &data, size_t pos)
+{
+	uint32_t v = 0;
+	for (int i = 0; i < 4; ++i)
+		v |= uint32_t(uint8_t(data[pos + i])) << (8 * i);
+	return v;
+}
+
+// 进程在写最后一条记录时崩溃：截断在最后一条记录内的任何位置，都只丢这一条
+void testTruncatedTail(const std::string &path)
+{
+	writeLog(path, 3);
+	const std::string full = readFile(path);
+	size_t lastStart = 32;
+	for (int i = 0; i < 2; ++i)
+		lastStart += 4 + readU32(full, lastStart);
+	CHECK(lastStart + 4 + readU32(full, lastStart) == full.size());
+
+	Core::EventLogReader reader;
+	std::string err;
+	// 文件仍被映射时不能改写（Windows 上会失败），每次改写前先 close
+	for (size_t size = lastStart; size < full.size(); ++size) {
+		writeFile(path, full.substr(0, size));
+		CHECK(reader.open(path, err));
+		size_t index = 0;
+		bool same = true;
+		auto compare = [&](const Event &event) { same = same && sameEvent(event, makeEvent(index++)); };
+		CHECK(reader.scan(compare) == 2);
+		CHECK(same);
+		reader.close();
+	}
+
+	// 只剩下不完整的长度前缀，或长度前缀声称超过上限
+	writeFile(path, full.substr(0, 32) + std::string("\x05\x00", 2));
+	CHECK(reader.open(path, err));
+	CHECK(reader.scan([](const Event &) {}) == 0);
+	reader.close();
+	writeFile(path, full.substr(0, 32) + std::string("\xff\xff\xff\x7f", 4) + std::string(64, '\0'));
+	CHECK(reader.open(path, err));
+	CHECK(reader.scan([](const Event &) {}) == 0);
+	reader.close();
+
+	// 只有文件头的日志是有效的空日志
+	writeFile(path, full.substr(0, 32));
+	CHECK(reader.open(path, err));
+	CHECK(reader.roomId() == kRoomId);
+	CHECK(reader.scan([](const Event &) {}) == 0);
+	CHECK(reader.replay(0, [](const Event *, size_t) { CHECK(false); }) == 0);
+}
+
+void expectRejected(const std::string &path, const std::string &data)
+{
+	writeFile(path, data);
+	Core::EventLogReader reader;
+	std::string err;
+	CHECK(!reader.open(path, err));
+	CHECK(!err.empty());
+	CHECK(reader.scan([](const Event &) {}) == 0);
+}
+
+void testHeaderValidation(const std::string &path)
+{
+	writeLog(path, 1);
+	const std::string good = readFile(path);
+	CHECK(good.size() > 32);
+
+	std::string err;
+	Core::EventLogReader reader;
+	CHECK(!reader.open(tempPath("event_log_test_missing.blog"), err));
+	CHECK(!err.empty());
+
+	expectRejected(path, std::string());
+	expectRejected(path, good.substr(0, 31));
+
+	std::string bad = good;
+	bad[0] = 'X';
+	expectRejected(path, bad);
+
+	bad = good;
+	bad[8] = 2; // 版本
+	expectRejected(path, bad);
+
+	bad = good;
+	bad[12] = 31; // 文件头长度小于 32
+	expectRejected(path, bad);
+
+	bad = good;
+	bad[12] = 0;
+	bad[13] = 0x10; // 文件头长度超过文件大小
+	expectRejected(path, bad);
+
+	// 失败的 open 会关闭之前打开的文件
+	writeFile(path, good);
+	CHECK(reader.open(path, err));
+	CHECK(reader.scan([](const Event &) {}) == 1);
+	CHECK(!reader.open(tempPath("event_log_test_missing.blog"), err));
+	CHECK(reader.scan([](const Event &) {}) == 0);
+}
+} // namespace
+
+int main()
+{
+	const std::string path = tempPath("event_log_test.blog");
+	testRoundTrip(path);
+	testTruncatedTail(path);
+	testHeaderValidation(path);
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+	std::printf("event_log_test: %zu 条事件往返一致\n", kEventCount);
+	return 0;
+}
@@ -0,0 +1,137 @@
+// 推流节点测速对本地 RTMP 握手替身的测试：按延迟选出最快节点，黑洞 / 拒绝连接 / 无法解析的节点
+// 都必须在超时内结束，不能拖住整次测速
+#include <curl/curl.h>
+#include "core/ingest_prober.hpp"
+#include "test_support.hpp"
+
+using namespace Core;
+
+namespace {
+const size_t kHandshakeSize = 1536;
+const int kTimeoutMs = 1000;
+const int kSlackMs = 500;
+
+// 收到 C0+C1 后等待 delayMs 再回 S0+S1+S2
+Test::LoopbackServer::Handler rtmpServer(int delayMs)
+{
+	return [delayMs](Test::Socket s, const Test::LoopbackServer &srv) {
+		std::string c0c1(1 + kHandshakeSize, '\0');
+		if (!Test::readExact(s, &c0c1[0], c0c1.size()) || c0c1[0] != 3)
+			return;
+		auto started = std::chrono::steady_clock::now();
+		while (!srv.stopping() && Test::msSince(started) < delayMs)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		std::string reply(1 + 2 * kHandshakeSize, '\0');
+		reply[0] = 3;
+		Test::writeAll(s, reply.data(), reply.size());
+		Test::drainUntilClosed(s, [&] { return srv.stopping(); });
+	};
+}
+
+// 接受连接但从不应答握手
+void blackhole(Test::Socket s, const Test::LoopbackServer &srv)
+{
+	Test::drainUntilClosed(s, [&] { return srv.stopping(); });
+}
+
+std::string rtmpUrl(int port)
+{
+	return "rtmp://127.0.0.1:" + std::to_string(port) + "/live-bvc/";
+}
+
+// 绑定后立即关闭的端口，连接会被拒绝
+int closedPort()
+{
+	Test::Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	CHECK(s != Test::kBadSocket);
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	CHECK(bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+	socklen_t len = sizeof(addr);
+	CHECK(getsockname(s, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+	Test::closeSocket(s);
+	return ntohs(addr.sin_port);
+}
+
+void testParseRtmpUrl()
+{
+	std::string host;
+	int port = 0;
+	CHECK(IngestProber::parseRtmpUrl("rtmp://live-push.bilivideo.com/live-bvc/", host, port));
+	CHECK(host == "live-push.bilivideo.com" && port == 1935);
+	CHECK(IngestProber::parseRtmpUrl("rtmp://127.0.0.1:19350/live-bvc/", host, port));
+	CHECK(host == "127.0.0.1" && port == 19350);
+	CHECK(IngestProber::parseRtmpUrl("rtmp://[::1]:1936/live/", host, port));
+	CHECK(host == "::1" && port == 1936);
+	CHECK(!IngestProber::parseRtmpUrl("srt://127.0.0.1:1935", host, port));
+}
+
+// 最快的健康节点胜出，其余健康节点按延迟排成备用；坏节点不拖长整体耗时
+void testSelectsFastest()
+{
+	Test::LoopbackServer fast(rtmpServer(20));
+	Test::LoopbackServer slow(rtmpServer(300));
+	Test::LoopbackServer silent(blackhole);
+	std::vector<Bili::RtmpInfo> candidates = {
+		{rtmpUrl(slow.port()), "slow"},
+		{rtmpUrl(silent.port()), "silent"},
+		{rtmpUrl(fast.port()), "fast"},
+		{rtmpUrl(closedPort()), "refused"},
+		{"rtmp://ingest.invalid/live-bvc/", "unresolvable"},
+	};
+	Bili::RtmpInfo chosen = candidates[0];
+	std::vector<Bili::RtmpInfo> backups;
+
+	auto started = std::chrono::steady_clock::now();
+	IngestProber::selectFastest(candidates, chosen, kTimeoutMs, &backups);
+	CHECK(Test::msSince(started) < kTimeoutMs + kSlackMs);
+	CHECK(chosen.code == "fast");
+	CHECK(backups.size() == 1);
+	CHECK(backups[0].code == "slow");
+}
+
+// 每个失败节点都给出原因，且全部在超时内返回
+void testFailuresAreBounded()
+{
+	Test::LoopbackServer silent(blackhole);
+	std::vector<Bili::RtmpInfo> targets = {
+		{rtmpUrl(silent.port()), "silent"},
+		{rtmpUrl(closedPort()), "refused"},
+		{"rtmp://ingest.invalid/live-bvc/", "unresolvable"},
+		{"http://127.0.0.1/", "invalid"},
+	};
+
+	auto started = std::chrono::steady_clock::now();
+	auto results = IngestProber::probe(targets, kTimeoutMs);
+	CHECK(Test::msSince(started) < kTimeoutMs + kSlackMs);
+	CHECK(results.size() == targets.size());
+	for (const auto &result : results) {
+		CHECK(!result.healthy);
+		CHECK(!result.error.empty());
+	}
+	CHECK(results[0].connect_ms >= 0);
+	CHECK(results[0].error == "握手超时");
+	CHECK(results[1].connect_ms < 0);
+	CHECK(results[3].error == "无效的推流地址");
+	CHECK(IngestProber::pickFastest(results) < 0);
+
+	// 全部失败时保持接口默认节点
+	Bili::RtmpInfo chosen = {"rtmp://default/live-bvc/", "default"};
+	std::vector<Bili::RtmpInfo> backups = {{"stale", "stale"}};
+	IngestProber::selectFastest(targets, chosen, 200, &backups);
+	CHECK(chosen.code == "default");
+	CHECK(backups.empty());
+}
+} // namespace
+
+int main()
+{
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+	testParseRtmpUrl();
+	testSelectsFastest();
+	testFailuresAreBounded();
+	curl_global_cleanup();
+	std::printf("ingest_prober_test: ok\n");
+	return 0;
+}
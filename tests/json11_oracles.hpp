@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 差分测试的两个参照实现，各自把 json11 编成改名的命名空间，与插件使用的 json11 链接进同一个测试程序：
+// Json11Scalar   —— 当前的 json11.cpp 关闭 SIMD（JSON11_NO_SIMD），命名空间 json11_scalar
+// Json11Baseline —— tests/json11_baseline 中保留的改造前的 json11，命名空间 json11_baseline
+namespace Json11Scalar {
+// 等同于 json11::Json::parse(in, err, strategy).dump()
+std::string parseAndDump(std::string_view in, std::string &err, bool comments);
+// 等同于 json11::Json::parse_multi，逐个 dump 后用换行拼接
+std::string parseMultiAndDump(std::string_view in, size_t &stop, std::string &err);
+} // namespace Json11Scalar
+
+namespace Json11Baseline {
+std::string parseAndDump(std::string_view in, std::string &err, bool comments);
+std::string parseMultiAndDump(std::string_view in, size_t &stop, std::string &err);
+} // namespace Json11Baseline
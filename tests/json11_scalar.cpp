@@ -0,0 +1,18 @@
+// 与 json11.cpp 一起以 JSON11_NO_SIMD 和 json11=json11_scalar 编译，见 tests/CMakeLists.txt
+#include "json11_oracles.hpp"
+#include "json11/json11.hpp"
+
+namespace Json11Scalar {
+std::string parseAndDump(std::string_view in, std::string &err, bool comments)
+{
+	return json11::Json::parse(in, err, comments ? json11::COMMENTS : json11::STANDARD).dump();
+}
+
+std::string parseMultiAndDump(std::string_view in, size_t &stop, std::string &err)
+{
+	std::string out;
+	for (const auto &json : json11::Json::parse_multi(in, stop, err))
+		out += json.dump() + "\n";
+	return out;
+}
+} // namespace Json11Scalar
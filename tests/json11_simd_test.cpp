@@ -0,0 +1,228 @@
+// json11 的差分测试：SIMD 扫描（AVX2 / SSE2 / NEON）与 JSON11_NO_SIMD 标量版本比较，
+// 并以改造前的 json11（tests/json11_baseline）为参照检查 HEAP / ARENA、COPY / BORROW 各模式。
+// 同一批输入分别解析，dump 结果、错误信息和 parse_multi 的停止位置必须完全一致。
+// 另外检查从 ARENA 树中拷贝出的节点在根销毁后仍然可用。
+// 输入覆盖接口样本、截断的文档、特殊字节落在 16 / 32 字节块各个位置的构造串，以及固定种子的随机串
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "json11/json11.hpp"
+#include "json11_oracles.hpp"
+#include "test_support.hpp"
+
+namespace {
+size_t g_compared = 0;
+
+const char *simdPath()
+{
+#if defined(JSON11_NO_SIMD)
+	return "scalar";
+#elif defined(__AVX2__)
+	return "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	return "SSE2";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
+
+std::string printable(std::string_view in)
+{
+	std::string out;
+	for (char c : in.substr(0, 200)) {
+		auto u = static_cast<unsigned char>(c);
+		if (u >= 0x20 && u < 0x7f) {
+			out += c;
+		} else {
+			char buf[8];
+			std::snprintf(buf, sizeof(buf), "\\x%02x", u);
+			out += buf;
+		}
+	}
+	return out;
+}
+
+// 一种实现对同一输入的全部输出：两种解析策略的 dump 与错误信息，以及 parse_multi 的结果和停止位置
+struct Outputs {
+	std::string dump[2];
+	std::string err[2];
+	std::string multi;
+	std::string multiErr;
+	size_t stop = 0;
+};
+
+template<typename Parse, typename ParseMulti>
+Outputs collect(std::string_view in, Parse parse, ParseMulti parseMulti)
+{
+	Outputs out;
+	for (int comments = 0; comments < 2; ++comments)
+		out.dump[comments] = parse(in, out.err[comments], comments != 0);
+	out.multi = parseMulti(in, out.stop, out.multiErr);
+	return out;
+}
+
+void expectSame(std::string_view in, const char *name, const Outputs &actual, const char *oracle,
+		const Outputs &expected)
+{
+	for (int i = 0; i < 2; ++i) {
+		if (actual.dump[i] == expected.dump[i] && actual.err[i] == expected.err[i])
+			continue;
+		std::fprintf(stderr, "输入 (%zu 字节): %s\n%s: %s | %s\n%s: %s | %s\n", in.size(),
+			     printable(in).c_str(), name, actual.dump[i].substr(0, 200).c_str(), actual.err[i].c_str(),
+			     oracle, expected.dump[i].substr(0, 200).c_str(), expected.err[i].c_str());
+		CHECK(false);
+	}
+	if (actual.multi != expected.multi || actual.multiErr != expected.multiErr || actual.stop != expected.stop) {
+		std::fprintf(stderr, "输入 (%zu 字节): %s\nparse_multi %s 与 %s 不一致\n", in.size(),
+			     printable(in).c_str(), name, oracle);
+		CHECK(false);
+	}
+}
+
+void compare(std::string_view in)
+{
+	auto parse = [](json11::JsonAlloc alloc, json11::JsonStrings strings) {
+		return [alloc, strings](std::string_view text, std::string &err, bool comments) {
+			auto strategy = comments ? json11::COMMENTS : json11::STANDARD;
+			return json11::Json::parse(text, err, strategy, alloc, strings).dump();
+		};
+	};
+	auto parseMulti = [](std::string_view text, size_t &stop, std::string &err) {
+		std::string out;
+		for (const auto &json : json11::Json::parse_multi(text, stop, err))
+			out += json.dump() + "\n";
+		return out;
+	};
+
+	Outputs simd = collect(in, parse(json11::HEAP, json11::COPY), parseMulti);
+	Outputs scalar = collect(in, Json11Scalar::parseAndDump, Json11Scalar::parseMultiAndDump);
+	Outputs baseline = collect(in, Json11Baseline::parseAndDump, Json11Baseline::parseMultiAndDump);
+	// SIMD 与标量逐字节一致；两者又都要与改造前的 json11 一致，
+	// arena / FlatMap / string_view 等两者共有的改动也不能改变输出
+	expectSame(in, simdPath(), simd, "标量", scalar);
+	expectSame(in, simdPath(), simd, "改造前", baseline);
+	expectSame(in, "ARENA + BORROW", collect(in, parse(json11::ARENA, json11::BORROW), parseMulti), "改造前",
+		   baseline);
+	++g_compared;
+}
+
+std::string readData(const std::string &name)
+{
+	std::ifstream in(std::string(TEST_DATA_DIR) + "/" + name, std::ios::binary);
+	CHECK(in);
+	std::stringstream text;
+	text << in.rdbuf();
+	return text.str();
+}
+
+// 接口样本整篇比较；较小的样本再逐个前缀截断，覆盖各种位置上的解析错误
+void testCapturedPayloads()
+{
+	std::string area = readData("area_list.json");
+	std::string room = readData("room_info.json");
+	compare(area);
+	compare(room);
+	for (size_t n = 0; n < room.size(); ++n)
+		compare(std::string_view(room).substr(0, n));
+
+	std::istringstream chat(readData("chat_capture.jsonl"));
+	std::string line;
+	size_t lines = 0;
+	while (std::getline(chat, line)) {
+		compare(line);
+		if (lines++ < 8) {
+			for (size_t n = 0; n < line.size(); ++n)
+				compare(std::string_view(line).substr(0, n));
+		}
+	}
+	CHECK(lines > 0);
+}
+
+// 字符串里的特殊字节与空白串的结束位置落在块内每个偏移、以及跨块边界
+void testBlockBoundaries()
+{
+	const std::string specials[] = {"\\\"", "\\\\", "\\n", "\\u00e9", "\"", std::string(1, '\x01'),
+					std::string(1, '\x1f'), std::string(1, '\x7f'), "\x80", "\xff",
+					"\xe4\xbd\xa0", " "};
+	for (size_t k = 0; k <= 96; ++k) {
+		for (const auto &special : specials) {
+			std::string s = "[\"" + std::string(k, 'a') + special + std::string(40, 'b') + "\"]";
+			compare(s);
+			// 没有结尾引号：扫描必须在输入末尾停下
+			compare(std::string_view(s).substr(0, s.size() - 2));
+		}
+		const std::string spaces[] = {" ", "\t", "\r\n", "\x0b", "\x0c", "\xa0"};
+		for (const auto &space : spaces) {
+			std::string ws;
+			while (ws.size() < k)
+				ws += (ws.size() % 3 == 0) ? " " : (ws.size() % 3 == 1 ? "\n" : "\t");
+			compare("[" + ws + "1" + ws + "," + ws + "2" + space + ws + "]");
+			compare(ws + "{\"k\":" + ws + "true" + space + "}" + ws);
+			compare(ws);
+		}
+	}
+}
+
+// 固定种子的随机串，字母表偏向 JSON 结构字符、空白和特殊字节
+void testRandomInputs()
+{
+	static const char alphabet[] = "{}[]:,\"\\ \t\r\n0123456789-+.eEtrufalsn/*u abcXYZ\x01\x1f\x7f\x80\xbf\xe4\xff";
+	std::mt19937 rng(20261018);
+	std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+	std::uniform_int_distribution<size_t> length(0, 160);
+	for (int round = 0; round < 20000; ++round) {
+		std::string s;
+		size_t n = length(rng);
+		// 一半的输入以合法前缀开头，让解析器走得更深
+		if (round % 2 == 0)
+			s = round % 4 == 0 ? "{\"a\":\"" : "[ \"";
+		for (size_t i = 0; i < n; ++i)
+			s += alphabet[pick(rng)];
+		compare(s);
+	}
+}
+// ARENA 树里的节点拷贝出来后与 arena、输入都无关：根和输入都销毁后拷贝仍然可用（ASan 下检查）
+void testArenaCopiesOutliveRoot()
+{
+	json11::Json sub, flag;
+	json11::Json::array list;
+	json11::Json::object data;
+	{
+		std::string text = R"({"data":{"list":[{"name":"a string longer than the small buffer","n":1},)"
+				   R"(true,null,2.5],"title":"\u4f60\u597d"}})";
+		std::string err;
+		json11::Json root = json11::Json::parse(text, err, json11::STANDARD, json11::ARENA, json11::BORROW);
+		CHECK(err.empty());
+		sub = root["data"]["list"][0];
+		flag = root["data"]["list"][1];
+		list = root["data"]["list"].array_items();
+		data = root["data"].object_items();
+		// 根本身的拷贝共享 arena，不做深拷贝
+		json11::Json copy = root;
+		CHECK(copy["data"]["list"][3].number_value() == 2.5);
+		text.assign(text.size(), 'x');
+	}
+	CHECK(sub.dump() == R"({"n": 1, "name": "a string longer than the small buffer"})");
+	CHECK(sub["name"].string_value() == "a string longer than the small buffer");
+	CHECK(flag.bool_value());
+	CHECK(json11::Json(list).dump() ==
+	      R"([{"n": 1, "name": "a string longer than the small buffer"}, true, null, 2.5])");
+	CHECK(data["title"].string_value() == "\xe4\xbd\xa0\xe5\xa5\xbd");
+	json11::Json assigned;
+	assigned = data["list"];
+	data.clear();
+	CHECK(assigned[2].is_null() && assigned.array_items().size() == 4);
+}
+} // namespace
+
+int main()
+{
+	testArenaCopiesOutliveRoot();
+	testCapturedPayloads();
+	testBlockBoundaries();
+	testRandomInputs();
+	std::printf("json11_simd_test: %s 与标量、改造前版本一致，%zu 条输入\n", simdPath(), g_compared);
+	return 0;
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// 测试不依赖任何框架：CHECK 失败时打印位置并以非零状态退出，由 ctest 判定失败
+#define CHECK(cond)                                                                        \
+	do {                                                                               \
+		if (!(cond)) {                                                             \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			std::exit(1);                                                      \
+		}                                                                          \
+	} while (0)
+
+namespace Test {
+#ifdef _WIN32
+using Socket = SOCKET;
+static const Socket kBadSocket = INVALID_SOCKET;
+inline void closeSocket(Socket s)
+{
+	closesocket(s);
+}
+#else
+using Socket = int;
+static const Socket kBadSocket = -1;
+inline void closeSocket(Socket s)
+{
+	close(s);
+}
+#endif
+
+inline int64_t msSince(std::chrono::steady_clock::time_point start)
+{
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline bool waitReadable(Socket s, int timeout_ms)
+{
+#ifdef _WIN32
+	WSAPOLLFD pfd{s, POLLIN, 0};
+	return WSAPoll(&pfd, 1, timeout_ms) > 0;
+#else
+	pollfd pfd{s, POLLIN, 0};
+	return poll(&pfd, 1, timeout_ms) > 0;
+#endif
+}
+
+inline bool readExact(Socket s, char *out, size_t len)
+{
+	while (len > 0) {
+		int n = recv(s, out, static_cast<int>(len), 0);
+		if (n <= 0)
+			return false;
+		out += n;
+		len -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+inline bool writeAll(Socket s, const void *data, size_t len)
+{
+	const char *p = static_cast<const char *>(data);
+	while (len > 0) {
+		int n = send(s, p, static_cast<int>(len), 0);
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+// 读到 HTTP 头结束（空行）为止，返回完整头部
+inline std::string readHeaders(Socket s)
+{
+	std::string head;
+	char ch;
+	while (head.size() < 16 * 1024 && readExact(s, &ch, 1)) {
+		head += ch;
+		if (head.size() >= 4 && head.compare(head.size() - 4, 4, "\r\n\r\n") == 0)
+			break;
+	}
+	return head;
+}
+
+// 丢弃对端发来的数据，直到对端关闭连接或 stop 置位
+template <class Stop> inline void drainUntilClosed(Socket s, Stop stop)
+{
+	char buf[16 * 1024];
+	while (!stop()) {
+		if (waitReadable(s, 50) && recv(s, buf, sizeof(buf), 0) <= 0)
+			return;
+	}
+}
+
+// 只监听 127.0.0.1 的本地服务：每个连接在独立线程上交给 handler，handler 返回后关闭连接。
+// 析构时先关监听套接字，再等所有连接线程结束；handler 应当自行检查 stopping() 及时返回
+class LoopbackServer {
+public:
+	using Handler = std::function<void(Socket s, const LoopbackServer &server)>;
+
+	explicit LoopbackServer(Handler handler) : m_handler(std::move(handler))
+	{
+#ifdef _WIN32
+		WSADATA wsa;
+		WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+		m_listen = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		CHECK(m_listen != kBadSocket);
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		CHECK(bind(m_listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+		CHECK(listen(m_listen, 16) == 0);
+		socklen_t len = sizeof(addr);
+		CHECK(getsockname(m_listen, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+		m_port = ntohs(addr.sin_port);
+		m_acceptThread = std::thread(&LoopbackServer::acceptLoop, this);
+	}
+
+	~LoopbackServer()
+	{
+		m_stopping = true;
+		if (m_acceptThread.joinable())
+			m_acceptThread.join();
+		closeSocket(m_listen);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto &t : m_connections)
+			t.join();
+#ifdef _WIN32
+		WSACleanup();
+#endif
+	}
+
+	LoopbackServer(const LoopbackServer &) = delete;
+	LoopbackServer &operator=(const LoopbackServer &) = delete;
+
+	int port() const { return m_port; }
+	std::string address() const { return "127.0.0.1:" + std::to_string(m_port); }
+	bool stopping() const { return m_stopping; }
+	int accepted() const { return m_accepted; }
+
+private:
+	void acceptLoop()
+	{
+		while (!m_stopping) {
+			if (!waitReadable(m_listen, 50))
+				continue;
+			Socket s = accept(m_listen, nullptr, nullptr);
+			if (s == kBadSocket)
+				continue;
+			++m_accepted;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_connections.emplace_back([this, s] {
+				m_handler(s, *this);
+				closeSocket(s);
+			});
+		}
+	}
+
+	Handler m_handler;
+	Socket m_listen = kBadSocket;
+	int m_port = 0;
+	std::atomic<bool> m_stopping{false};
+	std::atomic<int> m_accepted{0};
+	std::thread m_acceptThread;
+	std::mutex m_mutex;
+	std::vector<std::thread> m_connections;
+};
+} // namespace Test
@@ -0,0 +1,123 @@
+// 上行测速对本地 RTMP 接收端的测试：完成握手后吞下填充数据，限速、RTT 采样、中止和失败路径都在本机验证
+#include <curl/curl.h>
+#include "core/uplink_tester.hpp"
+#include "test_support.hpp"
+
+using namespace Core;
+
+namespace {
+const size_t kHandshakeSize = 1536;
+
+// 完整的简单握手（C0+C1 → S0+S1+S2 → C2），之后丢弃收到的数据。
+// RTT 采样的连接只建连不发数据，readExact 失败后直接返回
+void rtmpSink(Test::Socket s, const Test::LoopbackServer &srv)
+{
+	std::string c0c1(1 + kHandshakeSize, '\0');
+	if (!Test::readExact(s, &c0c1[0], c0c1.size()) || c0c1[0] != 3)
+		return;
+	std::string reply(1 + 2 * kHandshakeSize, '\0');
+	reply[0] = 3;
+	if (!Test::writeAll(s, reply.data(), reply.size()))
+		return;
+	std::string c2(kHandshakeSize, '\0');
+	if (!Test::readExact(s, &c2[0], c2.size()))
+		return;
+	Test::drainUntilClosed(s, [&] { return srv.stopping(); });
+}
+
+void silentPeer(Test::Socket s, const Test::LoopbackServer &srv)
+{
+	Test::drainUntilClosed(s, [&] { return srv.stopping(); });
+}
+
+std::string rtmpUrl(int port)
+{
+	return "rtmp://127.0.0.1:" + std::to_string(port) + "/live-bvc/";
+}
+
+// 回环上带宽远超上限，吞吐应被限速在上限附近并标记为已达上限
+void testThrottledToCeiling()
+{
+	Test::LoopbackServer sink(rtmpSink);
+	const int ceilingKbps = 8000;
+	auto started = std::chrono::steady_clock::now();
+	auto result = UplinkTester::run(rtmpUrl(sink.port()), 900, ceilingKbps);
+	CHECK(result.ok);
+	CHECK(result.error.empty());
+	CHECK(Test::msSince(started) < 900 + 2000);
+	CHECK(result.throughput_kbps > ceilingKbps * 0.8);
+	CHECK(result.throughput_kbps < ceilingKbps * 1.1);
+	CHECK(result.saturated);
+	CHECK(result.rtt_idle_ms >= 0);
+	CHECK(result.rtt_loaded_ms >= 0);
+	// 3 次空载采样 + 1 条测速连接 + 至少 1 次负载采样
+	CHECK(sink.accepted() >= 5);
+}
+
+void testAbortStopsEarly()
+{
+	Test::LoopbackServer sink(rtmpSink);
+	std::atomic<bool> abort{false};
+	std::thread stopper([&] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(300));
+		abort = true;
+	});
+	auto started = std::chrono::steady_clock::now();
+	auto result = UplinkTester::run(rtmpUrl(sink.port()), 10000, 8000, &abort);
+	stopper.join();
+	CHECK(Test::msSince(started) < 1500);
+	CHECK(!result.ok);
+	CHECK(result.error == "已取消");
+}
+
+void testHandshakeTimeout()
+{
+	Test::LoopbackServer silent(silentPeer);
+	auto started = std::chrono::steady_clock::now();
+	auto result = UplinkTester::run(rtmpUrl(silent.port()), 600, 8000);
+	CHECK(!result.ok);
+	CHECK(result.error == "握手超时");
+	CHECK(Test::msSince(started) < 3000);
+}
+
+void testInvalidAddress()
+{
+	auto result = UplinkTester::run("srt://127.0.0.1:1935", 600, 8000);
+	CHECK(!result.ok);
+	CHECK(result.error == "无效的推流地址");
+}
+
+void testRecommend()
+{
+	UplinkResult result;
+	CHECK(UplinkTester::recommend(result, 6000) == 0);
+
+	result.ok = true;
+	result.throughput_kbps = 10000;
+	result.rtt_idle_ms = 10;
+	result.rtt_loaded_ms = 20;
+	result.rtt_jitter_ms = 5;
+	CHECK(UplinkTester::recommend(result, 0) == 7500);
+	CHECK(UplinkTester::recommend(result, 6000) == 6000);
+
+	// 负载下 RTT 上升说明在排队，再打 8 折
+	result.rtt_loaded_ms = 200;
+	CHECK(UplinkTester::recommend(result, 0) == 6000);
+	result.rtt_loaded_ms = 20;
+	result.rtt_jitter_ms = 80;
+	CHECK(UplinkTester::recommend(result, 0) == 6000);
+}
+} // namespace
+
+int main()
+{
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+	testRecommend();
+	testInvalidAddress();
+	testThrottledToCeiling();
+	testAbortStopsEarly();
+	testHandshakeTimeout();
+	curl_global_cleanup();
+	std::printf("uplink_tester_test: ok\n");
+	return 0;
+}